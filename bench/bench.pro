@@ -0,0 +1,69 @@
+# 性能基准测试（命令行程序，界面部分默认使用 offscreen 平台）
+# 用法：bench [--json 结果文件] [测试名...]，不带测试名时运行全部
+QT += core gui widgets serialport
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = FlexSerialPortBench
+TEMPLATE = app
+
+INCLUDEPATH += ../src
+
+# 基准测试
+SOURCES += \
+    main.cpp \
+    hexbench.cpp \
+    pipelinebench.cpp \
+    framingbench.cpp \
+    buttonbench.cpp \
+    buttonviewbench.cpp \
+    configbench.cpp \
+    macrobench.cpp
+
+HEADERS += \
+    benchmarks.h
+
+# 被测源文件
+SOURCES += \
+    ../src/hexcodec.cpp \
+    ../src/ringbuffer.cpp \
+    ../src/perfmetrics.cpp \
+    ../src/capturefile.cpp \
+    ../src/capturewriter.cpp \
+    ../src/serialportmanager.cpp \
+    ../src/sessionmanager.cpp \
+    ../src/logstore.cpp \
+    ../src/logview.cpp \
+    ../src/virtualport.cpp \
+    ../src/frameassembler.cpp \
+    ../src/nativeserialport.cpp \
+    ../src/buttongrid.cpp \
+    ../src/configfile.cpp \
+    ../src/buttondatabase.cpp \
+    ../src/buttonmodel.cpp \
+    ../src/deadlinesleeper.cpp \
+    ../src/macroengine.cpp
+
+HEADERS += \
+    ../src/hexcodec.h \
+    ../src/ringbuffer.h \
+    ../src/perfmetrics.h \
+    ../src/capturefile.h \
+    ../src/capturewriter.h \
+    ../src/serialportmanager.h \
+    ../src/sessionmanager.h \
+    ../src/logstore.h \
+    ../src/logview.h \
+    ../src/virtualport.h \
+    ../src/frameassembler.h \
+    ../src/nativeserialport.h \
+    ../src/buttongrid.h \
+    ../src/configfile.h \
+    ../src/buttondatabase.h \
+    ../src/buttonmodel.h \
+    ../src/deadlinesleeper.h \
+    ../src/macroengine.h
+
+# 虚拟串口使用 openpty
+unix:!macx: LIBS += -lutil
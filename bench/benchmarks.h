@@ -0,0 +1,81 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+
+// 机器可读的测试结果，--json 时输出，用于不同版本之间对比是否退化
+class BenchReport
+{
+public:
+    // 记录一项指标，同一测试下的指标名不可重复
+    void add(const QString &benchmark, const QString &metric, double value, const QString &unit)
+    {
+        QJsonObject entry;
+        entry["value"] = value;
+        entry["unit"] = unit;
+        QJsonObject metrics = results.value(benchmark).toObject();
+        metrics[metric] = entry;
+        results[benchmark] = metrics;
+    }
+
+    QJsonObject toJson() const
+    {
+        return results;
+    }
+
+private:
+    QJsonObject results;
+};
+
+// 各项基准测试入口，返回0表示通过
+int runHexBenchmark(QTextStream &out, BenchReport &report);
+int runThroughputBenchmark(QTextStream &out, BenchReport &report);
+int runLatencyBenchmark(QTextStream &out, BenchReport &report);
+int runFrameBenchmark(QTextStream &out, BenchReport &report);
+int runMemoryBenchmark(QTextStream &out, BenchReport &report);
+int runFramingBenchmark(QTextStream &out, BenchReport &report);
+int runBackendBenchmark(QTextStream &out, BenchReport &report);
+int runFlowControlBenchmark(QTextStream &out, BenchReport &report);
+int runButtonBenchmark(QTextStream &out, BenchReport &report);
+int runButtonViewBenchmark(QTextStream &out, BenchReport &report);
+int runConfigBenchmark(QTextStream &out, BenchReport &report);
+int runMacroBenchmark(QTextStream &out, BenchReport &report);
+
+// 运行 body 若干次（至少 minMs 毫秒），返回单次平均耗时（纳秒）
+template <typename Body>
+double measureNs(Body body, int minMs = 200)
+{
+    QElapsedTimer timer;
+    qint64 iterations = 0;
+    timer.start();
+    do {
+        body();
+        ++iterations;
+    } while (timer.elapsed() < minMs);
+    return double(timer.nsecsElapsed()) / double(iterations);
+}
+
+// 吞吐率（MB/s）
+inline double megabytesPerSecond(qint64 bytes, double ns)
+{
+    return ns > 0 ? double(bytes) / ns * 1e9 / (1024.0 * 1024.0) : 0.0;
+}
+
+// 百分位数（最近秩法），samples 会被排序
+inline double percentile(QVector<double> &samples, double p)
+{
+    if (samples.isEmpty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    qsizetype rank = qsizetype(p / 100.0 * double(samples.size()) + 0.5);
+    rank = qBound<qsizetype>(1, rank, samples.size());
+    return samples[rank - 1];
+}
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,164 @@
+#include "benchmarks.h"
+#include "buttongrid.h"
+#include <QMap>
+
+// 10000 个按键：100 行 x 100 列
+static const int GRID_ROWS = 100;
+static const int GRID_COLS = 100;
+
+// 原来的存储方式：以 "row,col" 字符串为键的 QMap
+typedef QMap<QString, ButtonData> ButtonMap;
+
+static QString makeKey(int row, int col)
+{
+    return QString("%1,%2").arg(row).arg(col);
+}
+
+static ButtonData makeButton(int row, int col)
+{
+    // 每隔几个格子留一个只有位置没有内容的按键
+    const bool empty = (row * GRID_COLS + col) % 7 == 0;
+    return ButtonData(empty ? QString() : QString("按键%1").arg(col),
+                      empty ? QString() : QString("AT+CMD=%1,%2").arg(row).arg(col), row, col);
+}
+
+// QMap 中删除一行：下面每一行的键都要重新生成
+static void mapRemoveRow(ButtonMap &map, int row)
+{
+    ButtonMap shifted;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        ButtonData data = it.value();
+        if (data.row == row) {
+            continue;
+        }
+        if (data.row > row) {
+            --data.row;
+        }
+        shifted.insert(makeKey(data.row, data.col), data);
+    }
+    map.swap(shifted);
+}
+
+static void mapInsertRow(ButtonMap &map, int row)
+{
+    ButtonMap shifted;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        ButtonData data = it.value();
+        if (data.row >= row) {
+            ++data.row;
+        }
+        shifted.insert(makeKey(data.row, data.col), data);
+    }
+    map.swap(shifted);
+}
+
+int runButtonBenchmark(QTextStream &out, BenchReport &report)
+{
+    ButtonMap map;
+    ButtonGrid grid;
+    for (int row = 0; row < GRID_ROWS; ++row) {
+        for (int col = 0; col < GRID_COLS; ++col) {
+            const ButtonData data = makeButton(row, col);
+            map.insert(makeKey(row, col), data);
+            grid.set(data);
+        }
+    }
+
+    int failures = 0;
+    const int buttonCount = GRID_ROWS * GRID_COLS;
+    out << QString("%1 %2 %3 %4").arg("操作", 12).arg("QMap(us)", 12).arg("网格(us)", 12).arg("倍数", 8) << Qt::endl;
+
+    const auto compare = [&](const QString &name, double mapNs, double gridNs, bool required) {
+        const double ratio = gridNs > 0 ? mapNs / gridNs : 0.0;
+        out << QString("%1 %2 %3 %4").arg(name, 12).arg(mapNs / 1000.0, 12, 'f', 1)
+                   .arg(gridNs / 1000.0, 12, 'f', 1).arg(ratio, 8, 'f', 1) << Qt::endl;
+        report.add("buttons", name + "_map", mapNs / 1000.0, "us");
+        report.add("buttons", name + "_grid", gridNs / 1000.0, "us");
+        if (required && gridNs >= mapNs) {
+            out << QString("%1 网格不快于 QMap").arg(name) << Qt::endl;
+            ++failures;
+        }
+    };
+
+    // 逐个格子按行列查找（点击、编辑按键）
+    qint64 sink = 0;
+    const double mapLookupNs = measureNs([&]() {
+        for (int row = 0; row < GRID_ROWS; ++row) {
+            for (int col = 0; col < GRID_COLS; ++col) {
+                sink += map.value(makeKey(row, col)).command.size();
+            }
+        }
+    });
+    const double gridLookupNs = measureNs([&]() {
+        for (int row = 0; row < GRID_ROWS; ++row) {
+            for (int col = 0; col < GRID_COLS; ++col) {
+                sink += grid.at(row, col).command.size();
+            }
+        }
+    });
+    compare("lookup", mapLookupNs, gridLookupNs, true);
+
+    // 遍历全部按键（加载到表格）；原来的 getAllButtons() 每次复制整个 QMap
+    const double mapIterateNs = measureNs([&]() {
+        const ButtonMap copy = map;
+        for (auto it = copy.cbegin(); it != copy.cend(); ++it) {
+            sink += it.value().row;
+        }
+    });
+    const double gridIterateNs = measureNs([&]() {
+        grid.forEach([&](const ButtonData &data) { sink += data.row; });
+    });
+    compare("iterate", mapIterateNs, gridIterateNs, true);
+
+    // 统计有内容的按键数（每次刷新状态栏）
+    int mapUsed = 0;
+    const double mapCountNs = measureNs([&]() {
+        mapUsed = 0;
+        const ButtonMap copy = map;
+        for (auto it = copy.cbegin(); it != copy.cend(); ++it) {
+            if (it.value().isUsed()) {
+                ++mapUsed;
+            }
+        }
+    });
+    const double gridCountNs = measureNs([&]() { sink += grid.usedCount(); });
+    compare("count", mapCountNs, gridCountNs, true);
+    if (grid.usedCount() != mapUsed) {
+        out << QString("按键数不一致：QMap %1，网格 %2").arg(mapUsed).arg(grid.usedCount()) << Qt::endl;
+        ++failures;
+    }
+
+    // 在中间删除再插入一行，后面的按键依次移动
+    const double mapRowNs = measureNs([&]() {
+        mapRemoveRow(map, GRID_ROWS / 2);
+        mapInsertRow(map, GRID_ROWS / 2);
+    });
+    const double gridRowNs = measureNs([&]() {
+        grid.removeRow(GRID_ROWS / 2);
+        grid.insertRow(GRID_ROWS / 2);
+    });
+    compare("row", mapRowNs, gridRowNs, true);
+
+    // 同样删除再插入一列
+    const double gridColumnNs = measureNs([&]() {
+        grid.removeColumn(GRID_COLS / 2);
+        grid.insertColumn(GRID_COLS / 2);
+    });
+    out << QString("%1 %2 %3").arg("column", 12).arg("-", 12).arg(gridColumnNs / 1000.0, 12, 'f', 1) << Qt::endl;
+    report.add("buttons", "column_grid", gridColumnNs / 1000.0, "us");
+
+    // 行列移动后行列号必须与所在格子一致
+    int misplaced = 0;
+    grid.forEach([&](const ButtonData &data) {
+        if (&grid.at(data.row, data.col) != &data) {
+            ++misplaced;
+        }
+    });
+    if (misplaced > 0 || grid.rowCount() != GRID_ROWS || grid.columnCount() != GRID_COLS) {
+        out << QString("行列插入删除后网格错误：%1 个按键位置不符").arg(misplaced) << Qt::endl;
+        ++failures;
+    }
+
+    out << QString("按键数 %1，校验和 %2").arg(buttonCount).arg(sink) << Qt::endl;
+    return failures;
+}
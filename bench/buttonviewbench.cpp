@@ -0,0 +1,137 @@
+#include "benchmarks.h"
+#include "buttondatabase.h"
+#include "buttonmodel.h"
+#include <QHeaderView>
+#include <QTableView>
+#include <QTableWidget>
+#include <QTemporaryDir>
+
+// 5000 个按键：625 行 x 8 列，要求启动时加载并显示第一帧在50ms以内
+static const int TABLE_ROWS = 625;
+static const int TABLE_COLS = 8;
+static const double REQUIRED_LOAD_MS = 50.0;
+static const int VIEW_WIDTH = 956;
+static const int VIEW_HEIGHT = 400;
+
+// 原来的方式：每个格子一个 QTableWidgetItem，窗口缩放时逐列设置列宽
+static void adjustColumnWidths(QTableWidget &table)
+{
+    const int columnWidth = qMax(80, (table.width() - 32) / table.columnCount());
+    for (int i = 0; i < table.columnCount(); ++i) {
+        table.setColumnWidth(i, columnWidth);
+    }
+}
+
+static void loadWidget(QTableWidget &table, const ButtonDatabase &database)
+{
+    table.setRowCount(TABLE_ROWS);
+    table.setColumnCount(TABLE_COLS);
+    database.getButtons().forEach([&](const ButtonData &data) {
+        QTableWidgetItem *item = new QTableWidgetItem(data.remark);
+        item->setTextAlignment(Qt::AlignCenter);
+        item->setBackground(QBrush(data.command.isEmpty() ? QColor(144, 238, 144) : QColor(173, 216, 230)));
+        item->setForeground(QBrush(QColor(0, 0, 0)));
+        table.setItem(data.row, data.col, item);
+    });
+    adjustColumnWidths(table);
+}
+
+static void setupView(QTableView &view, ButtonModel &model)
+{
+    view.setModel(&model);
+    view.horizontalHeader()->setMinimumSectionSize(80);
+    view.horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+}
+
+int runButtonViewBenchmark(QTextStream &out, BenchReport &report)
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        out << "无法创建临时目录" << Qt::endl;
+        return 1;
+    }
+    ButtonDatabase database(dir.filePath("config.yaml"));
+    database.setTableSize(TABLE_ROWS, TABLE_COLS);
+    for (int row = 0; row < TABLE_ROWS; ++row) {
+        for (int col = 0; col < TABLE_COLS; ++col) {
+            database.setButtonData(row, col, QString("按键%1-%2").arg(row).arg(col),
+                                   col % 3 == 0 ? QString() : QString("AT+CMD=%1").arg(row));
+        }
+    }
+
+    int failures = 0;
+    out << QString("%1 %2 %3").arg("操作", 12).arg("QTableWidget(ms)", 18).arg("模型+视图(ms)", 16) << Qt::endl;
+
+    // 加载：建表、填入全部按键并绘制第一帧
+    const double widgetLoadNs = measureNs([&]() {
+        QTableWidget table;
+        table.resize(VIEW_WIDTH, VIEW_HEIGHT);
+        loadWidget(table, database);
+        table.grab();
+    });
+    const double viewLoadNs = measureNs([&]() {
+        ButtonModel model(&database);
+        QTableView view;
+        view.resize(VIEW_WIDTH, VIEW_HEIGHT);
+        setupView(view, model);
+        view.grab();
+    });
+    out << QString("%1 %2 %3").arg("load", 12).arg(widgetLoadNs / 1e6, 18, 'f', 2).arg(viewLoadNs / 1e6, 16, 'f', 2) << Qt::endl;
+    report.add("buttonview", "load_widget", widgetLoadNs / 1e6, "ms");
+    report.add("buttonview", "load_view", viewLoadNs / 1e6, "ms");
+    if (viewLoadNs / 1e6 > REQUIRED_LOAD_MS) {
+        out << QString("加载 %1 个按键超过 %2 ms").arg(TABLE_ROWS * TABLE_COLS).arg(REQUIRED_LOAD_MS) << Qt::endl;
+        ++failures;
+    }
+
+    // 缩放：改变宽度后重新分配列宽并重绘
+    QTableWidget table;
+    table.resize(VIEW_WIDTH, VIEW_HEIGHT);
+    loadWidget(table, database);
+    ButtonModel model(&database);
+    QTableView view;
+    view.resize(VIEW_WIDTH, VIEW_HEIGHT);
+    setupView(view, model);
+
+    int step = 0;
+    const double widgetResizeNs = measureNs([&]() {
+        table.resize(VIEW_WIDTH + (++step % 2) * 100, VIEW_HEIGHT);
+        adjustColumnWidths(table);
+        table.grab();
+    });
+    const double viewResizeNs = measureNs([&]() {
+        view.resize(VIEW_WIDTH + (++step % 2) * 100, VIEW_HEIGHT);
+        view.grab();
+    });
+    out << QString("%1 %2 %3").arg("resize", 12).arg(widgetResizeNs / 1e6, 18, 'f', 2).arg(viewResizeNs / 1e6, 16, 'f', 2) << Qt::endl;
+    report.add("buttonview", "resize_widget", widgetResizeNs / 1e6, "ms");
+    report.add("buttonview", "resize_view", viewResizeNs / 1e6, "ms");
+
+    // 编辑：修改一个按键后只刷新该格子
+    int changedRanges = 0;
+    QObject::connect(&model, &QAbstractItemModel::dataChanged, [&](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        if (topLeft == bottomRight) {
+            ++changedRanges;
+        }
+    });
+    database.setButtonData(1, 1, "修改", "AT");
+    if (changedRanges != 1) {
+        out << "修改按键没有只通知该格子" << Qt::endl;
+        ++failures;
+    }
+
+    // 切换配置：两个各有5000个按键的配置来回切换并重绘，不重新读取文件
+    database.addProfile("profile-b", true);
+    int profile = 0;
+    const double switchNs = measureNs([&]() {
+        database.setActiveProfile(++profile % 2);
+        view.grab();
+    });
+    out << QString("%1 %2 %3").arg("switch", 12).arg("-", 18).arg(switchNs / 1e6, 16, 'f', 2) << Qt::endl;
+    report.add("buttonview", "switch_profile", switchNs / 1e6, "ms");
+    if (switchNs / 1e6 > REQUIRED_LOAD_MS) {
+        out << QString("切换配置超过 %1 ms").arg(REQUIRED_LOAD_MS) << Qt::endl;
+        ++failures;
+    }
+    return failures;
+}
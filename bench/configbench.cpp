@@ -0,0 +1,227 @@
+#include "benchmarks.h"
+#include "configfile.h"
+#include <QRandomGenerator>
+
+// 往返测试次数和变异测试次数
+static const int ROUND_TRIPS = 2000;
+static const int MUTATIONS = 5000;
+// 启动加载测试的按键数：625 行 x 8 列
+static const int LOAD_ROWS = 625;
+static const int LOAD_COLS = 8;
+
+// 容易破坏手写解析的字符：冒号、引号、反斜杠、注释符、换行、控制字符、中文、代理对、不成对的代理项
+static QString randomText(QRandomGenerator &generator)
+{
+    static const QChar special[] = {
+        QChar(':'), QChar('"'), QChar('\\'), QChar('#'), QChar(' '), QChar('\n'), QChar('\r'), QChar('\t'),
+        QChar(0), QChar(0x01), QChar(0x1B), QChar(0x7F), QChar('x'), QChar('u'), QChar(','), QChar('-'),
+        QChar(0x4E2D), QChar(0x6587), QChar(0xFEFF), QChar(0xD800), QChar(0xDC00),
+    };
+    const int length = int(generator.bounded(24));
+    QString text;
+    for (int i = 0; i < length; ++i) {
+        const quint32 kind = generator.bounded(4);
+        if (kind == 0) {
+            text += special[generator.bounded(int(sizeof(special) / sizeof(special[0])))];
+        } else if (kind == 1) {
+            // 成对的代理项（表情符号）
+            const char32_t ucs4 = 0x1F600 + generator.bounded(64);
+            text += QString::fromUcs4(&ucs4, 1);
+        } else {
+            text += QChar(char16_t(0x20 + generator.bounded(0x5F)));
+        }
+    }
+    return text;
+}
+
+static ConfigData randomData(QRandomGenerator &generator, int buttonCount)
+{
+    ConfigData data;
+    SerialPortConfig &config = data.serialConfig;
+    config.portName = randomText(generator);
+    config.parity = randomText(generator);
+    config.enterChars = randomText(generator);
+    config.captureDirectory = randomText(generator);
+    config.frameDelimiter = randomText(generator);
+    config.baudRate = int(generator.bounded(4000000));
+    config.renderFps = 1 + int(generator.bounded(1000));
+    config.logMaxLines = int(generator.bounded(1000000));
+    config.frameLengthAdjust = int(generator.bounded(200)) - 100;
+    config.hexSend = generator.bounded(2) == 1;
+    config.frameLengthBigEndian = generator.bounded(2) == 1;
+    data.tableRows = 1 + int(generator.bounded(50));
+    data.tableCols = 1 + int(generator.bounded(20));
+    for (int i = 0; i < buttonCount; ++i) {
+        data.buttons.set(ButtonData(randomText(generator), randomText(generator),
+                                    int(generator.bounded(data.tableRows)), int(generator.bounded(data.tableCols)),
+                                    generator.bounded(2) == 1,
+                                    generator.bounded(2) == 1 ? ButtonData::MacroButton : ButtonData::CommandButton));
+    }
+    return data;
+}
+
+// 1~3 个配置，名称加序号前缀避免重名
+static ConfigSet randomConfig(QRandomGenerator &generator, int buttonCount)
+{
+    ConfigSet set;
+    set.profiles.clear();
+    const int count = 1 + int(generator.bounded(3));
+    for (int i = 0; i < count; ++i) {
+        ConfigProfile profile;
+        profile.name = QString::number(i) + randomText(generator);
+        profile.data = randomData(generator, buttonCount);
+        set.profiles.append(profile);
+    }
+    set.activeProfile = int(generator.bounded(count));
+    return set;
+}
+
+static bool sameButtons(const ButtonGrid &a, const ButtonGrid &b)
+{
+    QVector<const ButtonData *> left;
+    QVector<const ButtonData *> right;
+    a.forEach([&](const ButtonData &data) { left << &data; });
+    b.forEach([&](const ButtonData &data) { right << &data; });
+    if (left.size() != right.size()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < left.size(); ++i) {
+        const ButtonData &x = *left[i];
+        const ButtonData &y = *right[i];
+        if (x.remark != y.remark || x.command != y.command || x.row != y.row || x.col != y.col
+            || x.isHexCommand != y.isHexCommand || x.type != y.type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// YAML 输出包含全部字段，两份配置的输出相同即所有字段都相同
+static bool sameConfig(const ConfigSet &a, const ConfigSet &b)
+{
+    if (a.profiles.size() != b.profiles.size() || a.activeProfile != b.activeProfile) {
+        return false;
+    }
+    for (qsizetype i = 0; i < a.profiles.size(); ++i) {
+        if (!sameButtons(a.profiles.at(i).data.buttons, b.profiles.at(i).data.buttons)) {
+            return false;
+        }
+    }
+    return ConfigFile::toYaml(a) == ConfigFile::toYaml(b);
+}
+
+int runConfigBenchmark(QTextStream &out, BenchReport &report)
+{
+    QRandomGenerator generator(23);
+    int failures = 0;
+
+    // 随机配置 -> YAML/缓存 -> 读回，必须完全一致
+    int yamlMismatches = 0;
+    int cacheMismatches = 0;
+    for (int i = 0; i < ROUND_TRIPS; ++i) {
+        const ConfigSet original = randomConfig(generator, int(generator.bounded(20)));
+
+        ConfigSet fromYaml;
+        if (!ConfigFile::fromYaml(ConfigFile::toYaml(original), &fromYaml) || !sameConfig(original, fromYaml)) {
+            ++yamlMismatches;
+        }
+        ConfigSet fromCache;
+        if (!ConfigFile::fromCache(ConfigFile::toCache(original, 1, 2), 1, 2, &fromCache) || !sameConfig(original, fromCache)) {
+            ++cacheMismatches;
+        }
+    }
+    out << QString("往返 %1 次：YAML 不一致 %2，缓存不一致 %3").arg(ROUND_TRIPS).arg(yamlMismatches).arg(cacheMismatches) << Qt::endl;
+    failures += yamlMismatches + cacheMismatches;
+
+    // 旧格式文件：不转义，含冒号的指令也要完整读回，全部内容读作一个默认配置
+    const QByteArray legacy =
+        "SerialPort:\n"
+        "  portName: \"COM3\"\n"
+        "Buttons:\n"
+        "  \"1,2\":\n"
+        "    remark: \"C:\\temp\"\n"
+        "    command: \"AT+CMD:1\"\n"
+        "    row: 1\n"
+        "    col: 2\n"
+        "    isValid: true\n";
+    ConfigSet legacySet;
+    const bool legacyLoaded = ConfigFile::fromYaml(legacy, &legacySet) && legacySet.profiles.size() == 1;
+    const ConfigData &legacyData = legacySet.profiles.first().data;
+    if (!legacyLoaded || legacyData.serialConfig.portName != "COM3"
+        || legacyData.buttons.at(1, 2).command != "AT+CMD:1" || legacyData.buttons.at(1, 2).remark != "C:\\temp") {
+        out << "旧格式配置读取错误" << Qt::endl;
+        ++failures;
+    }
+
+    // 变异：截断、改写、插入字节后解析不能崩溃；损坏的缓存必须被拒绝，不能读出错误数据
+    const ConfigSet sample = randomConfig(generator, 40);
+    const QByteArray yaml = ConfigFile::toYaml(sample);
+    const QByteArray cache = ConfigFile::toCache(sample, 1, 2);
+    int acceptedCorruptCaches = 0;
+    for (int i = 0; i < MUTATIONS; ++i) {
+        QByteArray mutatedYaml = yaml;
+        QByteArray mutatedCache = cache;
+        const int edits = 1 + int(generator.bounded(8));
+        for (int e = 0; e < edits; ++e) {
+            const qsizetype yamlPos = generator.bounded(int(mutatedYaml.size()));
+            const qsizetype cachePos = generator.bounded(int(mutatedCache.size()));
+            switch (generator.bounded(3)) {
+            case 0:
+                mutatedYaml.truncate(yamlPos);
+                mutatedCache.truncate(cachePos);
+                break;
+            case 1:
+                mutatedYaml[yamlPos] = char(generator.bounded(256));
+                mutatedCache[cachePos] = char(generator.bounded(256));
+                break;
+            default:
+                mutatedYaml.insert(yamlPos, char(generator.bounded(256)));
+                mutatedCache.insert(cachePos, char(generator.bounded(256)));
+                break;
+            }
+            if (mutatedYaml.isEmpty() || mutatedCache.isEmpty()) {
+                break;
+            }
+        }
+
+        ConfigSet parsed;
+        ConfigFile::fromYaml(mutatedYaml, &parsed);
+        ConfigSet cached;
+        if (ConfigFile::fromCache(mutatedCache, 1, 2, &cached) && mutatedCache.size() != cache.size()) {
+            // 长度变化的缓存必然损坏，被接受说明校验有漏洞
+            ++acceptedCorruptCaches;
+        }
+    }
+    out << QString("变异 %1 次：长度变化仍被接受的缓存 %2").arg(MUTATIONS).arg(acceptedCorruptCaches) << Qt::endl;
+    failures += acceptedCorruptCaches;
+
+    // 启动加载：5000 个按键，解析 YAML 与读取缓存对比
+    ConfigSet large;
+    ConfigData &largeData = large.profiles.first().data;
+    largeData.tableRows = LOAD_ROWS;
+    largeData.tableCols = LOAD_COLS;
+    for (int row = 0; row < LOAD_ROWS; ++row) {
+        for (int col = 0; col < LOAD_COLS; ++col) {
+            largeData.buttons.set(ButtonData(QString("按键%1-%2").arg(row).arg(col),
+                                         QString("AT+CMD:%1,\"%2\"").arg(row).arg(col), row, col, col % 2 == 0));
+        }
+    }
+    const QByteArray largeYaml = ConfigFile::toYaml(large);
+    const QByteArray largeCache = ConfigFile::toCache(large, 1, 2);
+    const double yamlNs = measureNs([&]() {
+        ConfigSet data;
+        ConfigFile::fromYaml(largeYaml, &data);
+    });
+    const double cacheNs = measureNs([&]() {
+        ConfigSet data;
+        ConfigFile::fromCache(largeCache, 1, 2, &data);
+    });
+    out << QString("%1 个按键：YAML %2 KB %3 ms，缓存 %4 KB %5 ms")
+               .arg(LOAD_ROWS * LOAD_COLS)
+               .arg(largeYaml.size() / 1024).arg(yamlNs / 1e6, 0, 'f', 2)
+               .arg(largeCache.size() / 1024).arg(cacheNs / 1e6, 0, 'f', 2) << Qt::endl;
+    report.add("config", "load_yaml", yamlNs / 1e6, "ms");
+    report.add("config", "load_cache", cacheNs / 1e6, "ms");
+    report.add("config", "mismatches", yamlMismatches + cacheMismatches, "count");
+    return failures;
+}
@@ -0,0 +1,189 @@
+#include "benchmarks.h"
+#include "frameassembler.h"
+#include <QByteArray>
+#include <QRandomGenerator>
+
+// 分帧吞吐要求：每秒至少10万帧
+static const double REQUIRED_FRAMES_PER_SECOND = 100000.0;
+static const int FRAME_COUNT = 200000;
+
+struct FramingCase {
+    QString name;
+    FrameOptions options;
+    QByteArray stream;
+};
+
+// 构造测试数据：帧长在 8~40 字节之间随机变化
+static FramingCase makeCase(const QString &name, FrameOptions::Mode mode, const QByteArray &delimiter = "\n")
+{
+    FramingCase c;
+    c.name = name;
+    c.options.mode = mode;
+    c.options.delimiter = delimiter;
+    QRandomGenerator generator(11);
+
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        const int bodySize = 8 + int(generator.bounded(33));
+        QByteArray body = QByteArray::number(i).rightJustified(bodySize, 'x');
+        switch (mode) {
+        case FrameOptions::Delimiter:
+            c.stream += body;
+            c.stream += c.options.delimiter;
+            break;
+        case FrameOptions::FixedLength:
+            c.options.fixedLength = 16;
+            c.stream += body.left(16).rightJustified(16, 'x');
+            break;
+        case FrameOptions::LengthPrefix:
+            // 帧头：0xAA + 1字节长度
+            c.options.lengthOffset = 1;
+            c.options.lengthBytes = 1;
+            c.stream += char(0xAA);
+            c.stream += char(body.size());
+            c.stream += body;
+            break;
+        default:
+            c.stream += body;
+            break;
+        }
+    }
+    return c;
+}
+
+int runFramingBenchmark(QTextStream &out, BenchReport &report)
+{
+    QList<FramingCase> cases;
+    cases << makeCase("delimiter_lf", FrameOptions::Delimiter);
+    cases << makeCase("delimiter_crlf", FrameOptions::Delimiter, "\r\n");
+    cases << makeCase("fixed", FrameOptions::FixedLength);
+    cases << makeCase("length", FrameOptions::LengthPrefix);
+
+    int failures = 0;
+    out << QString("%1 %2 %3 %4").arg("方式", 16).arg("读取块", 8).arg("帧/秒", 14).arg("MB/s", 10) << Qt::endl;
+
+    const QVector<qsizetype> chunkSizes = {64, 4096};
+    for (const FramingCase &c : cases) {
+        for (qsizetype chunkSize : chunkSizes) {
+            FrameAssembler assembler(c.options);
+            qint64 frames = 0;
+            qint64 incomplete = 0;
+            const FrameAssembler::FrameHandler handler = [&](QByteArrayView, qint64, bool complete) {
+                ++frames;
+                if (!complete) {
+                    ++incomplete;
+                }
+            };
+
+            qint64 passes = 0;
+            const double ns = measureNs([&]() {
+                assembler.reset();
+                for (qsizetype pos = 0; pos < c.stream.size(); pos += chunkSize) {
+                    assembler.feed(c.stream.constData() + pos, qMin(chunkSize, c.stream.size() - pos), pos, handler);
+                }
+                ++passes;
+            });
+
+            const qint64 framesPerPass = passes > 0 ? frames / passes : 0;
+            if (framesPerPass != FRAME_COUNT || incomplete > 0) {
+                out << QString("%1 分帧结果错误：%2 帧，%3 帧不完整").arg(c.name).arg(framesPerPass).arg(incomplete) << Qt::endl;
+                ++failures;
+                continue;
+            }
+
+            const double framesPerSecond = FRAME_COUNT / ns * 1e9;
+            out << QString("%1 %2 %3 %4").arg(c.name, 16).arg(chunkSize, 8)
+                       .arg(framesPerSecond, 14, 'f', 0).arg(megabytesPerSecond(c.stream.size(), ns), 10, 'f', 1) << Qt::endl;
+            report.add("framing", QString("%1_%2").arg(c.name).arg(chunkSize), framesPerSecond, "frames/s");
+            if (framesPerSecond < REQUIRED_FRAMES_PER_SECOND) {
+                out << QString("%1 低于每秒 %2 帧").arg(c.name).arg(REQUIRED_FRAMES_PER_SECOND, 0, 'f', 0) << Qt::endl;
+                ++failures;
+            }
+        }
+    }
+
+    // 长度字段非法时的重新同步：帧之间夹杂多余字节，逐字节输入与整块输入得到的完整帧必须一致
+    {
+        FrameOptions options;
+        options.mode = FrameOptions::LengthPrefix;
+        options.lengthOffset = 1;
+        options.lengthBytes = 1;
+        options.maxFrameBytes = 42;
+        QByteArray stream;
+        QRandomGenerator generator(11);
+        for (int i = 0; i < 1000; ++i) {
+            if (i % 3 == 0) {
+                // 与下一帧的帧头拼成长度 0xAA，超过 maxFrameBytes
+                stream += char(0xAA);
+            }
+            const QByteArray body = QByteArray::number(i).rightJustified(8 + int(generator.bounded(33)), 'x');
+            stream += char(0xAA);
+            stream += char(body.size());
+            stream += body;
+        }
+
+        auto split = [&](qsizetype chunkSize, QList<QByteArray> *frames, qint64 *invalidBytes) {
+            FrameAssembler assembler(options);
+            const FrameAssembler::FrameHandler handler = [&](QByteArrayView frame, qint64, bool complete) {
+                if (complete) {
+                    frames->append(frame.toByteArray());
+                } else {
+                    *invalidBytes += frame.size();
+                }
+            };
+            for (qsizetype pos = 0; pos < stream.size(); pos += chunkSize) {
+                assembler.feed(stream.constData() + pos, qMin(chunkSize, stream.size() - pos), pos, handler);
+            }
+            assembler.flush(handler);
+        };
+
+        QList<QByteArray> wholeFrames, byteFrames;
+        qint64 wholeInvalid = 0, byteInvalid = 0;
+        split(stream.size(), &wholeFrames, &wholeInvalid);
+        split(1, &byteFrames, &byteInvalid);
+        if (wholeFrames.size() != 1000 || byteFrames != wholeFrames || byteInvalid != wholeInvalid) {
+            out << QString("length 重新同步错误：整块 %1 帧，逐字节 %2 帧").arg(wholeFrames.size()).arg(byteFrames.size()) << Qt::endl;
+            ++failures;
+        }
+    }
+
+    // 空闲间隔分帧：每帧一块，块间到达时刻相差超过间隔
+    const FramingCase idle = makeCase("idle", FrameOptions::IdleGap);
+    QVector<qsizetype> boundaries;
+    {
+        QRandomGenerator generator(11);
+        qsizetype pos = 0;
+        for (int i = 0; i < FRAME_COUNT; ++i) {
+            pos += 8 + int(generator.bounded(33));
+            boundaries << pos;
+        }
+    }
+    FrameAssembler idleAssembler(idle.options);
+    qint64 idleFrames = 0;
+    qint64 passes = 0;
+    const FrameAssembler::FrameHandler countFrames = [&](QByteArrayView, qint64, bool) { ++idleFrames; };
+    const double idleNs = measureNs([&]() {
+        idleAssembler.reset();
+        qsizetype start = 0;
+        qint64 arrivalNs = 0;
+        for (qsizetype end : boundaries) {
+            arrivalNs += 5000000;
+            idleAssembler.feed(idle.stream.constData() + start, end - start, arrivalNs, countFrames);
+            start = end;
+        }
+        idleAssembler.flush(countFrames);
+        ++passes;
+    });
+    if (passes == 0 || idleFrames / passes != FRAME_COUNT) {
+        out << "idle 分帧结果错误" << Qt::endl;
+        ++failures;
+    } else {
+        const double framesPerSecond = FRAME_COUNT / idleNs * 1e9;
+        out << QString("%1 %2 %3 %4").arg("idle", 16).arg("每帧", 8)
+                   .arg(framesPerSecond, 14, 'f', 0).arg(megabytesPerSecond(idle.stream.size(), idleNs), 10, 'f', 1) << Qt::endl;
+        report.add("framing", "idle", framesPerSecond, "frames/s");
+        if (framesPerSecond < REQUIRED_FRAMES_PER_SECOND) {
+            ++failures;
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,96 @@
+#include "benchmarks.h"
+#include "hexcodec.h"
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <QVector>
+#include <QRegularExpression>
+
+// 十六进制编解码：Qt 的 toHex(' ').toUpper() / fromHex() 与 HexCodec 各内核对比
+int runHexBenchmark(QTextStream &out, BenchReport &report)
+{
+    const QVector<qsizetype> sizes = {16, 256, 4096, 1024 * 1024};
+    int failures = 0;
+
+    out << "内核：" << HexCodec::kernelName() << Qt::endl;
+    out << QString("%1 %2 %3 %4 %5 %6 %7")
+               .arg("字节", 8).arg("Qt编码", 12).arg("查表编码", 12).arg("SIMD编码", 12)
+               .arg("编码为QString", 14).arg("Qt解码", 12).arg("单遍解码", 12) << Qt::endl;
+
+    for (qsizetype size : sizes) {
+        QByteArray data(size, Qt::Uninitialized);
+        QRandomGenerator generator(42);
+        for (qsizetype i = 0; i < size; ++i) {
+            data[i] = char(generator.bounded(256));
+        }
+
+        const QByteArray expected = data.toHex(' ').toUpper();
+        QByteArray buffer(HexCodec::encodedSize(size), Qt::Uninitialized);
+        QByteArray decoded;
+
+        // 正确性
+        HexCodec::setScalarOnly(true);
+        HexCodec::encode(data.constData(), size, buffer.data());
+        bool ok = buffer == expected;
+        HexCodec::setScalarOnly(false);
+        HexCodec::encode(data.constData(), size, buffer.data());
+        ok = ok && buffer == expected;
+        ok = ok && HexCodec::toHexString(data) == QString::fromLatin1(expected);
+        ok = ok && HexCodec::decode(expected, &decoded) && decoded == data;
+        if (!ok) {
+            out << "结果与Qt不一致，大小 " << size << Qt::endl;
+            ++failures;
+            continue;
+        }
+
+        volatile qsizetype sink = 0;
+        const double qtEncode = measureNs([&]() { sink = sink + QString(data.toHex(' ').toUpper()).size(); });
+        HexCodec::setScalarOnly(true);
+        const double scalarEncode = measureNs([&]() { sink = sink + HexCodec::encode(data.constData(), size, buffer.data()); });
+        HexCodec::setScalarOnly(false);
+        const double simdEncode = measureNs([&]() { sink = sink + HexCodec::encode(data.constData(), size, buffer.data()); });
+        const double stringEncode = measureNs([&]() { sink = sink + HexCodec::toHexString(data).size(); });
+        const double qtDecode = measureNs([&]() { sink = sink + QByteArray::fromHex(expected).size(); });
+        const double codecDecode = measureNs([&]() {
+            HexCodec::decode(expected, &decoded);
+            sink = sink + decoded.size();
+        });
+
+        auto rate = [size](double ns) { return QString("%1MB/s").arg(megabytesPerSecond(size, ns), 0, 'f', 0); };
+        report.add("hex", QString("encode_%1").arg(size), megabytesPerSecond(size, simdEncode), "MB/s");
+        report.add("hex", QString("to_string_%1").arg(size), megabytesPerSecond(size, stringEncode), "MB/s");
+        report.add("hex", QString("decode_%1").arg(size), megabytesPerSecond(size, codecDecode), "MB/s");
+        out << QString("%1 %2 %3 %4 %5 %6 %7")
+                   .arg(size, 8).arg(rate(qtEncode), 12).arg(rate(scalarEncode), 12).arg(rate(simdEncode), 12)
+                   .arg(rate(stringEncode), 14).arg(rate(qtDecode), 12).arg(rate(codecDecode), 12) << Qt::endl;
+    }
+
+    // 粘贴到输入框的1MB十六进制文本：原来的 remove×4 + 正则 + fromHex 与单遍解码对比
+    QByteArray payload(1024 * 1024, Qt::Uninitialized);
+    QRandomGenerator generator(7);
+    for (qsizetype i = 0; i < payload.size(); ++i) {
+        payload[i] = char(generator.bounded(256));
+    }
+    const QString pasted = HexCodec::toHexString(payload) + "\r\n";
+
+    volatile qsizetype sink = 0;
+    const double legacy = measureNs([&]() {
+        QString cleanInput = pasted.trimmed();
+        cleanInput.remove(' ').remove('\n').remove('\r').remove('\t');
+        const bool valid = QRegularExpression("^[0-9A-Fa-f]+$").match(cleanInput).hasMatch() && cleanInput.length() % 2 == 0;
+        sink = sink + (valid ? QByteArray::fromHex(cleanInput.toLatin1()).size() : 0);
+    });
+    QByteArray decoded;
+    const double singlePass = measureNs([&]() {
+        decoded.resize(0);
+        HexCodec::appendDecoded(pasted, decoded);
+        sink = sink + decoded.size();
+    });
+    if (decoded != payload) {
+        out << "1MB输入解码结果不一致" << Qt::endl;
+        ++failures;
+    }
+    out << QString("1MB粘贴输入校验+解码：原实现 %1 ms，单遍解码 %2 ms")
+               .arg(legacy / 1e6, 0, 'f', 2).arg(singlePass / 1e6, 0, 'f', 2) << Qt::endl;
+    report.add("hex", "paste_decode_1m", singlePass / 1e6, "ms");
+    return failures;
+}
@@ -0,0 +1,140 @@
+#include "benchmarks.h"
+#include "virtualport.h"
+#include "serialportmanager.h"
+#include "macroengine.h"
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+
+// 宏执行：回环虚拟串口上运行 send/wait 循环测应答延迟，再运行 delay 循环测延时精度
+
+static const int BENCH_BAUD_RATE = 921600;
+static const int PING_ROUNDS = 1000;
+static const int DELAY_ROUNDS = 500;
+static const int CHAIN_ROUNDS = 200;
+static const qint64 DELAY_NS = 1000 * 1000;     // delay 1ms
+// 整个宏最长运行时间，超过视为卡死
+static const int MACRO_TIMEOUT_MS = 30000;
+
+// 运行宏直到结束，返回宏是否成功；message 为结束说明
+static bool runMacro(MacroEngine &engine, SerialPortManager *manager, const QString &source,
+                     MacroStats *stats, QString *message)
+{
+    MacroProgram program;
+    if (!MacroProgram::compile(source, &program, message)) {
+        return false;
+    }
+
+    bool ok = false;
+    QEventLoop loop;
+    QObject receiver;
+    QObject::connect(&engine, &MacroEngine::finished, &receiver, [&](quint64 runId, bool success, const QString &text) {
+        if (runId != engine.runId()) {
+            return;
+        }
+        ok = success;
+        *message = text;
+        loop.quit();
+    });
+    QTimer::singleShot(MACRO_TIMEOUT_MS, &loop, [&]() {
+        *message = "宏运行超时";
+        loop.quit();
+    });
+
+    engine.start(manager, program);
+    loop.exec();
+    engine.stop();
+    *stats = engine.stats();
+    return ok;
+}
+
+int runMacroBenchmark(QTextStream &out, BenchReport &report)
+{
+    if (!VirtualPort::isSupported()) {
+        out << "当前平台不支持伪终端，跳过" << Qt::endl;
+        return 0;
+    }
+
+    VirtualPortOptions options;
+    options.mode = VirtualPortOptions::Echo;
+    VirtualPort port(options);
+    if (!port.open()) {
+        out << "打开虚拟串口失败：" << port.errorString() << Qt::endl;
+        return 1;
+    }
+
+    // 与主窗口相同：串口管理器在独立的I/O线程，宏引擎在自己的线程
+    QThread ioThread;
+    SerialPortManager *manager = new SerialPortManager;
+    manager->moveToThread(&ioThread);
+    QObject::connect(&ioThread, &QThread::finished, manager, &QObject::deleteLater);
+    ioThread.start(QThread::TimeCriticalPriority);
+
+    auto shutdown = [&]() {
+        manager->closePort();
+        ioThread.quit();
+        ioThread.wait();
+    };
+
+    if (!manager->openPort(port.portName(), BENCH_BAUD_RATE, 8, 1, "NoParity")) {
+        out << "打开串口失败：" << manager->getErrorString() << Qt::endl;
+        shutdown();
+        return 1;
+    }
+    // 宏不读取环形缓冲区，照常取走接收数据，与界面运行时一致
+    QObject drain;
+    QObject::connect(manager, &SerialPortManager::dataAvailable, &drain, [manager]() { manager->readAll(); });
+
+    int failures = 0;
+    MacroEngine engine;
+    MacroStats stats;
+    QString message;
+
+    // 应答延迟：wait 从提交发送算起到回包匹配
+    const QString pingMacro = QString("repeat %1; send PING-0123456789\\n; wait 200ms PING-0123456789\\n; end").arg(PING_ROUNDS);
+    if (runMacro(engine, manager, pingMacro, &stats, &message)) {
+        const MacroStepStats &send = stats.steps.at(1);
+        const MacroStepStats &wait = stats.steps.at(2);
+        out << QString("%1 次 send/wait：发送平均 %2 us，应答平均 %3 us，最小 %4 us，最大 %5 us，总用时 %6 ms")
+                   .arg(wait.runs)
+                   .arg(send.averageNs() / 1000.0, 0, 'f', 1)
+                   .arg(wait.averageNs() / 1000.0, 0, 'f', 1)
+                   .arg(wait.minNs / 1000.0, 0, 'f', 1)
+                   .arg(wait.maxNs / 1000.0, 0, 'f', 1)
+                   .arg(stats.elapsedNs / 1e6, 0, 'f', 1) << Qt::endl;
+        report.add("macro", "send_mean", send.averageNs() / 1000.0, "us");
+        report.add("macro", "wait_mean", wait.averageNs() / 1000.0, "us");
+        report.add("macro", "wait_max", wait.maxNs / 1000.0, "us");
+    } else {
+        out << "send/wait 宏失败：" << message << Qt::endl;
+        ++failures;
+    }
+
+    // 连续 wait：两个应答通常在同一段数据中到达，第二个 wait 必须能匹配到第一个之后的数据
+    const QString chainMacro = QString("repeat %1; send PING\\nPONG\\n; wait 200ms PING\\n; wait 200ms PONG\\n; end").arg(CHAIN_ROUNDS);
+    if (runMacro(engine, manager, chainMacro, &stats, &message)) {
+        out << QString("%1 次连续 wait 全部匹配").arg(stats.steps.at(3).runs) << Qt::endl;
+    } else {
+        out << "连续 wait 宏失败：" << message << Qt::endl;
+        ++failures;
+    }
+
+    // 延时精度：实际延时减去目标延时
+    const QString delayMacro = QString("repeat %1; delay %2us; end").arg(DELAY_ROUNDS).arg(DELAY_NS / 1000);
+    if (runMacro(engine, manager, delayMacro, &stats, &message)) {
+        const MacroStepStats &delay = stats.steps.at(1);
+        const double meanErrorUs = (delay.averageNs() - double(DELAY_NS)) / 1000.0;
+        const double maxErrorUs = double(delay.maxNs - DELAY_NS) / 1000.0;
+        out << QString("%1 次 delay %2 us：平均误差 %3 us，最大误差 %4 us")
+                   .arg(delay.runs).arg(DELAY_NS / 1000)
+                   .arg(meanErrorUs, 0, 'f', 1).arg(maxErrorUs, 0, 'f', 1) << Qt::endl;
+        report.add("macro", "delay_error_mean", meanErrorUs, "us");
+        report.add("macro", "delay_error_max", maxErrorUs, "us");
+    } else {
+        out << "delay 宏失败：" << message << Qt::endl;
+        ++failures;
+    }
+
+    shutdown();
+    return failures;
+}
@@ -0,0 +1,86 @@
+#include <QApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTextStream>
+#include <functional>
+#include <map>
+#include "benchmarks.h"
+
+int main(int argc, char *argv[])
+{
+    // 帧耗时测试需要真实绘制控件，无显示环境（CI）下默认使用 offscreen 平台
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const std::map<QString, std::function<int(QTextStream &, BenchReport &)>> benchmarks = {
+        {"hex", runHexBenchmark},
+        {"throughput", runThroughputBenchmark},
+        {"latency", runLatencyBenchmark},
+        {"frame", runFrameBenchmark},
+        {"memory", runMemoryBenchmark},
+        {"framing", runFramingBenchmark},
+        {"backend", runBackendBenchmark},
+        {"flowcontrol", runFlowControlBenchmark},
+        {"buttons", runButtonBenchmark},
+        {"buttonview", runButtonViewBenchmark},
+        {"config", runConfigBenchmark},
+        {"macro", runMacroBenchmark},
+    };
+
+    // 参数：[--json 文件] [测试名...]
+    QString jsonPath;
+    QStringList selected;
+    const QStringList arguments = app.arguments().mid(1);
+    for (int i = 0; i < arguments.size(); ++i) {
+        if (arguments[i] == "--json" && i + 1 < arguments.size()) {
+            jsonPath = arguments[++i];
+        } else {
+            selected << arguments[i];
+        }
+    }
+    if (selected.isEmpty()) {
+        for (const auto &entry : benchmarks) {
+            selected << entry.first;
+        }
+    }
+
+    BenchReport report;
+    int failures = 0;
+    for (const QString &name : selected) {
+        auto it = benchmarks.find(name);
+        if (it == benchmarks.end()) {
+            out << "未知的测试：" << name << Qt::endl;
+            ++failures;
+            continue;
+        }
+        out << "== " << name << " ==" << Qt::endl;
+        failures += it->second(out, report);
+        out << Qt::endl;
+    }
+
+    if (!jsonPath.isEmpty()) {
+        QJsonObject root;
+        root["schema"] = 1;
+        root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        root["qt"] = QString(qVersion());
+        root["os"] = QSysInfo::prettyProductName();
+        root["cpu"] = QSysInfo::currentCpuArchitecture();
+        root["failures"] = failures;
+        root["results"] = report.toJson();
+
+        QFile file(jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            out << "无法写入结果文件：" << jsonPath << Qt::endl;
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+    return failures == 0 ? 0 : 1;
+}
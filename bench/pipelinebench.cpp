@@ -0,0 +1,717 @@
+#include "benchmarks.h"
+#include "virtualport.h"
+#include "sessionmanager.h"
+#include "serialportmanager.h"
+#include "buttondatabase.h"
+#include "logview.h"
+#include "perfmetrics.h"
+#include <QEventLoop>
+#include <QFile>
+#include <QPair>
+#include <QThread>
+#include <QTimer>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+// 端到端基准测试：应用通过 QSerialPort 打开伪终端从设备，对端由 VirtualPort 的后台线程扮演，
+// 数据走 SerialPortManager → 会话I/O线程格式化 → GUI线程按帧追加到 LogView 的完整接收显示流程。
+
+static const int BENCH_BAUD_RATE = 921600;
+// 打开串口后的预热时间，打开前伪终端中积压或被截断的数据不计入结果
+static const int WARMUP_MS = 200;
+
+// 当前进程常驻内存（字节），不支持的平台返回-1
+static qint64 residentBytes()
+{
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+// 运行事件循环 ms 毫秒
+static void waitMs(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static QString formatRate(double bytesPerSecond)
+{
+    if (bytesPerSecond >= 1024.0 * 1024.0) {
+        return QString("%1 MB/s").arg(bytesPerSecond / (1024.0 * 1024.0), 0, 'f', 2);
+    }
+    return QString("%1 KB/s").arg(bytesPerSecond / 1024.0, 0, 'f', 1);
+}
+
+// 检查数据发生器输出的行是否完整、序号是否连续
+class SequenceChecker
+{
+public:
+    explicit SequenceChecker(int lineLength)
+        : expectedLength(lineLength - 1)
+    {
+        reset();
+    }
+
+    // 从下一个完整行重新同步
+    void reset()
+    {
+        carry.clear();
+        skipPartial = true;
+        expected = -1;
+        lines = 0;
+        gaps = 0;
+    }
+
+    void feed(const QString &text)
+    {
+        carry += text;
+        qsizetype start = 0;
+        qsizetype end;
+        while ((end = carry.indexOf(QChar('\n'), start)) >= 0) {
+            const QStringView line = QStringView(carry).mid(start, end - start);
+            start = end + 1;
+            if (skipPartial) {
+                // reset 时可能处在行中间，第一行不完整
+                skipPartial = false;
+                continue;
+            }
+            bool ok = false;
+            const qint64 sequence = line.left(10).toLongLong(&ok);
+            if (!ok || line.size() != expectedLength) {
+                ++gaps;
+                expected = -1;
+                continue;
+            }
+            if (expected >= 0 && sequence != expected) {
+                ++gaps;
+            }
+            expected = sequence + 1;
+            ++lines;
+        }
+        carry.remove(0, start);
+    }
+
+    qint64 lineCount() const { return lines; }
+    qint64 gapCount() const { return gaps; }
+
+private:
+    qsizetype expectedLength;
+    QString carry;
+    bool skipPartial;
+    qint64 expected;
+    qint64 lines;
+    qint64 gaps;
+};
+
+// 一次持续接收的结果（均为预热之后的部分）
+struct LoadResult {
+    qint64 receivedBytes;
+    double seconds;
+    qint64 lines;
+    qint64 sequenceGaps;        // 行不完整或序号不连续的次数
+    quint64 overrunBytes;       // 接收环形缓冲区溢出
+    quint64 peerDroppedBytes;   // 应用读取不及时，伪终端缓冲满
+    quint64 wakeups;            // 接收唤醒次数（serial.ready_read）
+    QVector<double> frameNs;    // 每帧取文本 + 追加 + 重绘的耗时
+    QVector<QPair<qint64, qint64>> memorySamples;   // (已接收字节, 常驻内存)
+
+    LoadResult()
+        : receivedBytes(0), seconds(0), lines(0), sequenceGaps(0), overrunBytes(0), peerDroppedBytes(0), wakeups(0) {}
+
+    bool lossless() const
+    {
+        return lines > 0 && sequenceGaps == 0 && overrunBytes == 0 && peerDroppedBytes == 0;
+    }
+};
+
+// 以 bytesPerSecond 的速率持续接收 durationMs 毫秒，显示流程与多串口窗口相同
+static bool runLoad(qint64 bytesPerSecond, int durationMs, LoadResult &result, QString &errorString,
+                    SerialPortManager::Backend backend = SerialPortManager::QtBackend,
+                    NativePortSettings::Profile profile = NativePortSettings::LowLatency)
+{
+    const SerialPortConfig config;
+
+    VirtualPortOptions options;
+    options.mode = VirtualPortOptions::Generator;
+    options.generatorBytesPerSecond = bytesPerSecond;
+    VirtualPort port(options);
+    if (!port.open()) {
+        errorString = port.errorString();
+        return false;
+    }
+
+    PortSession session(1);
+    session.setDisplayOptions(false, false);
+    session.manager()->setBackend(backend, profile);
+    if (!session.open(port.portName(), BENCH_BAUD_RATE)) {
+        errorString = session.errorString();
+        return false;
+    }
+
+    LogView view;
+    view.setRetentionLimits(config.logMaxLines, qint64(config.logMaxMegabytes) * 1024 * 1024);
+    view.resize(800, 600);
+    view.show();
+
+    SequenceChecker checker(options.generatorLineLength);
+    bool measuring = false;
+
+    QTimer frameTimer;
+    frameTimer.setInterval(1000 / qMax(1, config.renderFps));
+    QObject::connect(&frameTimer, &QTimer::timeout, [&]() {
+        QElapsedTimer clock;
+        clock.start();
+        const QString text = session.takeDisplayText();
+        if (!text.isEmpty()) {
+            view.appendText(text);
+        }
+        view.repaint();
+        const qint64 ns = clock.nsecsElapsed();
+
+        checker.feed(text);
+        if (measuring) {
+            result.frameNs.append(double(ns));
+        }
+    });
+    frameTimer.start();
+
+    waitMs(WARMUP_MS);
+
+    PerfCounter *wakeupCounter = PerfMetrics::instance().counter("serial.ready_read", "次", QString());
+    const SessionStats startStats = session.stats();
+    const quint64 startDropped = port.peerDroppedBytes();
+    const quint64 startWakeups = wakeupCounter->value();
+    checker.reset();
+    measuring = true;
+    result.memorySamples.append(qMakePair(qint64(0), residentBytes()));
+
+    QTimer sampleTimer;
+    sampleTimer.setInterval(250);
+    QObject::connect(&sampleTimer, &QTimer::timeout, [&]() {
+        result.memorySamples.append(qMakePair(session.stats().receivedBytes - startStats.receivedBytes, residentBytes()));
+    });
+    sampleTimer.start();
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    waitMs(durationMs);
+    measuring = false;
+    sampleTimer.stop();
+    frameTimer.stop();
+    result.seconds = double(elapsed.nsecsElapsed()) / 1e9;
+
+    const SessionStats endStats = session.stats();
+    result.receivedBytes = endStats.receivedBytes - startStats.receivedBytes;
+    result.overrunBytes = endStats.overrunBytes - startStats.overrunBytes;
+    result.peerDroppedBytes = port.peerDroppedBytes() - startDropped;
+    result.wakeups = wakeupCounter->value() - startWakeups;
+    result.lines = checker.lineCount();
+    result.sequenceGaps = checker.gapCount();
+    result.memorySamples.append(qMakePair(result.receivedBytes, residentBytes()));
+
+    session.close();
+    port.close();
+    return true;
+}
+
+// 持续吞吐：逐级提高对端发送速率，找出不丢数据的最高速率
+int runThroughputBenchmark(QTextStream &out, BenchReport &report)
+{
+    if (!VirtualPort::isSupported()) {
+        out << "当前平台不支持伪终端，跳过" << Qt::endl;
+        return 0;
+    }
+
+    const QVector<qint64> rates = {256 * 1024, 1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024, 32 * 1024 * 1024};
+    const int durationMs = 2000;
+
+    out << QString("%1 %2 %3 %4 %5 %6")
+               .arg("发送速率", 14).arg("接收速率", 14).arg("序号缺口", 10)
+               .arg("对端丢弃", 12).arg("缓冲溢出", 12).arg("结果", 6) << Qt::endl;
+
+    qint64 bestRate = 0;
+    double bestReceived = 0;
+    for (qint64 rate : rates) {
+        LoadResult result;
+        QString errorString;
+        if (!runLoad(rate, durationMs, result, errorString)) {
+            out << "打开虚拟串口失败：" << errorString << Qt::endl;
+            return 1;
+        }
+        const double received = double(result.receivedBytes) / result.seconds;
+        out << QString("%1 %2 %3 %4 %5 %6")
+                   .arg(formatRate(double(rate)), 14).arg(formatRate(received), 14)
+                   .arg(result.sequenceGaps, 10).arg(result.peerDroppedBytes, 12).arg(result.overrunBytes, 12)
+                   .arg(result.lossless() ? "无丢失" : "有丢失", 6) << Qt::endl;
+        if (!result.lossless()) {
+            break;
+        }
+        bestRate = rate;
+        bestReceived = received;
+    }
+
+    report.add("throughput", "max_lossless_rate", double(bestRate), "B/s");
+    report.add("throughput", "received_rate_at_max", bestReceived, "B/s");
+    if (bestRate == 0) {
+        out << "最低速率下也有数据丢失" << Qt::endl;
+        return 1;
+    }
+    out << "不丢数据的最高速率：" << formatRate(double(bestRate)) << Qt::endl;
+    return 0;
+}
+
+// 一次回环测量的结果（不含预热）
+struct EchoResult {
+    QVector<double> samplesUs;
+    int pingBytes;
+    int timeouts;
+    int mismatches;
+
+    EchoResult() : pingBytes(0), timeouts(0), mismatches(0) {}
+};
+
+// 对端原样回发，逐个测量从提交发送到GUI线程读到完整回包的时间
+static bool runEcho(SerialPortManager::Backend backend, NativePortSettings::Profile profile,
+                    int samplesWanted, EchoResult &result, QString &errorString)
+{
+    VirtualPortOptions options;
+    options.mode = VirtualPortOptions::Echo;
+    VirtualPort port(options);
+    if (!port.open()) {
+        errorString = "打开虚拟串口失败：" + port.errorString();
+        return false;
+    }
+
+    // 与主窗口相同：串口管理器在独立的I/O线程，GUI线程提交发送和读取
+    QThread ioThread;
+    SerialPortManager *manager = new SerialPortManager;
+    manager->moveToThread(&ioThread);
+    QObject::connect(&ioThread, &QThread::finished, manager, &QObject::deleteLater);
+    ioThread.start(QThread::TimeCriticalPriority);
+
+    auto shutdown = [&]() {
+        manager->closePort();
+        ioThread.quit();
+        ioThread.wait();
+    };
+
+    manager->setBackend(backend, profile);
+    if (!manager->openPort(port.portName(), BENCH_BAUD_RATE, 8, 1, "NoParity")) {
+        errorString = "打开串口失败：" + manager->getErrorString();
+        shutdown();
+        return false;
+    }
+
+    const int warmup = 100;
+    const QByteArray ping("PING-0123456789\n");
+    result.pingBytes = int(ping.size());
+
+    QByteArray echoed;
+    QElapsedTimer roundTrip;
+    QElapsedTimer total;
+    int completed = 0;
+
+    QEventLoop loop;
+    QTimer watchdog;
+    watchdog.setSingleShot(true);
+    watchdog.setInterval(1000);
+    QObject::connect(&watchdog, &QTimer::timeout, &loop, [&]() {
+        ++result.timeouts;
+        loop.quit();
+    });
+
+    auto sendPing = [&]() {
+        echoed.clear();
+        roundTrip.start();
+        manager->sendData(ping);
+        watchdog.start();
+    };
+
+    QObject receiver;
+    QObject::connect(manager, &SerialPortManager::dataAvailable, &receiver, [&]() {
+        echoed += manager->readAll();
+        if (echoed.size() < ping.size()) {
+            return;
+        }
+        const double us = double(roundTrip.nsecsElapsed()) / 1000.0;
+        if (echoed != ping) {
+            ++result.mismatches;
+        }
+        if (completed >= warmup) {
+            result.samplesUs.append(us);
+        }
+        ++completed;
+        // 最多运行10秒
+        if (completed >= warmup + samplesWanted || total.elapsed() > 10000) {
+            watchdog.stop();
+            loop.quit();
+            return;
+        }
+        sendPing();
+    });
+
+    total.start();
+    sendPing();
+    loop.exec();
+    shutdown();
+    return true;
+}
+
+// 回环延迟：对端原样回发，逐个测量从提交发送到GUI线程读到完整回包的时间
+int runLatencyBenchmark(QTextStream &out, BenchReport &report)
+{
+    if (!VirtualPort::isSupported()) {
+        out << "当前平台不支持伪终端，跳过" << Qt::endl;
+        return 0;
+    }
+
+    EchoResult result;
+    QString errorString;
+    if (!runEcho(SerialPortManager::QtBackend, NativePortSettings::LowLatency, 5000, result, errorString)) {
+        out << errorString << Qt::endl;
+        return 1;
+    }
+
+    QVector<double> &samplesUs = result.samplesUs;
+    if (samplesUs.isEmpty()) {
+        out << "未收到回包" << Qt::endl;
+        return 1;
+    }
+
+    double sum = 0;
+    for (double us : samplesUs) {
+        sum += us;
+    }
+    const double mean = sum / double(samplesUs.size());
+    const double p50 = percentile(samplesUs, 50);
+    const double p99 = percentile(samplesUs, 99);
+    const double p999 = percentile(samplesUs, 99.9);
+    const double maximum = samplesUs.last();
+
+    out << QString("%1 次往返（%2 字节）：平均 %3 us，p50 %4 us，p99 %5 us，p99.9 %6 us，最大 %7 us")
+               .arg(samplesUs.size()).arg(result.pingBytes)
+               .arg(mean, 0, 'f', 1).arg(p50, 0, 'f', 1).arg(p99, 0, 'f', 1)
+               .arg(p999, 0, 'f', 1).arg(maximum, 0, 'f', 1) << Qt::endl;
+
+    report.add("latency", "samples", samplesUs.size(), "count");
+    report.add("latency", "mean", mean, "us");
+    report.add("latency", "p50", p50, "us");
+    report.add("latency", "p99", p99, "us");
+    report.add("latency", "p99.9", p999, "us");
+    report.add("latency", "max", maximum, "us");
+
+    int failures = 0;
+    if (result.timeouts > 0) {
+        out << "回包超时" << Qt::endl;
+        ++failures;
+    }
+    if (result.mismatches > 0) {
+        out << "回包内容不一致：" << result.mismatches << " 次" << Qt::endl;
+        ++failures;
+    }
+    return failures;
+}
+
+// 负载下的GUI帧耗时：约为 921600 波特率十倍的接收速率下，每帧追加和重绘的耗时分布
+int runFrameBenchmark(QTextStream &out, BenchReport &report)
+{
+    if (!VirtualPort::isSupported()) {
+        out << "当前平台不支持伪终端，跳过" << Qt::endl;
+        return 0;
+    }
+
+    const SerialPortConfig config;
+    const qint64 rate = 1024 * 1024;
+    LoadResult result;
+    QString errorString;
+    if (!runLoad(rate, 3000, result, errorString)) {
+        out << "打开虚拟串口失败：" << errorString << Qt::endl;
+        return 1;
+    }
+    if (result.frameNs.isEmpty()) {
+        out << "没有绘制任何帧" << Qt::endl;
+        return 1;
+    }
+
+    const double budgetNs = 1e9 / double(qMax(1, config.renderFps));
+    int overBudget = 0;
+    for (double ns : result.frameNs) {
+        if (ns > budgetNs) {
+            ++overBudget;
+        }
+    }
+    const double p50 = percentile(result.frameNs, 50) / 1e6;
+    const double p99 = percentile(result.frameNs, 99) / 1e6;
+    const double maximum = result.frameNs.last() / 1e6;
+
+    out << QString("接收 %1，%2 帧：p50 %3 ms，p99 %4 ms，最大 %5 ms，超过帧间隔 %6 帧")
+               .arg(formatRate(double(result.receivedBytes) / result.seconds)).arg(result.frameNs.size())
+               .arg(p50, 0, 'f', 3).arg(p99, 0, 'f', 3).arg(maximum, 0, 'f', 3).arg(overBudget) << Qt::endl;
+
+    report.add("frame", "frames", result.frameNs.size(), "count");
+    report.add("frame", "p50", p50, "ms");
+    report.add("frame", "p99", p99, "ms");
+    report.add("frame", "max", maximum, "ms");
+    report.add("frame", "over_budget", overBudget, "count");
+    return 0;
+}
+
+// 内存增长：持续高速接收时常驻内存随接收量的增长，后半程应趋近于0（日志保留上限生效）
+int runMemoryBenchmark(QTextStream &out, BenchReport &report)
+{
+    // 没有换行符的输入：单行长度和保留的字节数同样受上限约束
+    {
+        const qint64 maxBytes = 1024 * 1024;
+        LogStore store(1000, maxBytes);
+        const QString chunk(4096, QChar(0x4E2D));
+        for (int i = 0; i < 2048; ++i) {
+            store.append(chunk, i);
+        }
+        qsizetype longest = 0;
+        for (qint64 i = 0; i < store.lineCount(); ++i) {
+            longest = qMax(longest, store.line(i).toUtf8().size());
+        }
+        if (store.byteSize() > maxBytes || longest > 64 * 1024) {
+            out << QString("无换行输入未受上限约束：保留 %1 字节，最长一行 %2 字节")
+                       .arg(store.byteSize()).arg(longest) << Qt::endl;
+            return 1;
+        }
+    }
+
+    if (!VirtualPort::isSupported() || residentBytes() < 0) {
+        out << "当前平台不支持，跳过" << Qt::endl;
+        return 0;
+    }
+
+    LoadResult result;
+    QString errorString;
+    if (!runLoad(8 * 1024 * 1024, 10000, result, errorString)) {
+        out << "打开虚拟串口失败：" << errorString << Qt::endl;
+        return 1;
+    }
+
+    const QVector<QPair<qint64, qint64>> &samples = result.memorySamples;
+    const QPair<qint64, qint64> &first = samples.first();
+    const QPair<qint64, qint64> &last = samples.last();
+    // 后半程从接收量过半的第一个采样点算起
+    QPair<qint64, qint64> middle = last;
+    for (const auto &sample : samples) {
+        if (sample.first * 2 >= last.first) {
+            middle = sample;
+            break;
+        }
+    }
+
+    auto kilobytesPerMegabyte = [](const QPair<qint64, qint64> &from, const QPair<qint64, qint64> &to) {
+        const double megabytes = double(to.first - from.first) / (1024.0 * 1024.0);
+        return megabytes > 0 ? double(to.second - from.second) / 1024.0 / megabytes : 0.0;
+    };
+    const double overall = kilobytesPerMegabyte(first, last);
+    const double secondHalf = kilobytesPerMegabyte(middle, last);
+
+    out << QString("接收 %1 MB：常驻内存 %2 MB → %3 MB，全程 %4 KB/MB，后半程 %5 KB/MB")
+               .arg(double(last.first) / (1024.0 * 1024.0), 0, 'f', 1)
+               .arg(double(first.second) / (1024.0 * 1024.0), 0, 'f', 1)
+               .arg(double(last.second) / (1024.0 * 1024.0), 0, 'f', 1)
+               .arg(overall, 0, 'f', 2).arg(secondHalf, 0, 'f', 2) << Qt::endl;
+
+    report.add("memory", "received", double(last.first), "B");
+    report.add("memory", "rss_start", double(first.second), "B");
+    report.add("memory", "rss_end", double(last.second), "B");
+    report.add("memory", "growth_per_mb", overall, "KB/MB");
+    report.add("memory", "growth_per_mb_second_half", secondHalf, "KB/MB");
+    return 0;
+}
+
+// 串口后端对比：同样的持续接收和回环负载下，QSerialPort 与原生后端两种调优方式的
+// 每MB接收唤醒次数和回环延迟
+int runBackendBenchmark(QTextStream &out, BenchReport &report)
+{
+    if (!VirtualPort::isSupported() || !NativeSerialPort::isSupported()) {
+        out << "当前平台不支持原生后端，跳过" << Qt::endl;
+        return 0;
+    }
+
+    struct BackendCase {
+        QString name;
+        SerialPortManager::Backend backend;
+        NativePortSettings::Profile profile;
+        double wakeupsPerMegabyte;
+        double p50;
+        double p99;
+    };
+    QList<BackendCase> cases = {
+        {"qt", SerialPortManager::QtBackend, NativePortSettings::LowLatency, 0, 0, 0},
+        {"native_latency", SerialPortManager::NativeBackend, NativePortSettings::LowLatency, 0, 0, 0},
+        {"native_throughput", SerialPortManager::NativeBackend, NativePortSettings::Throughput, 0, 0, 0},
+    };
+
+    const qint64 rate = 4 * 1024 * 1024;
+    int failures = 0;
+    out << QString("%1 %2 %3 %4 %5")
+               .arg("后端", 18).arg("接收速率", 14).arg("唤醒/MB", 10).arg("p50(us)", 10).arg("p99(us)", 10) << Qt::endl;
+
+    for (BackendCase &c : cases) {
+        LoadResult load;
+        QString errorString;
+        if (!runLoad(rate, 2000, load, errorString, c.backend, c.profile)) {
+            out << c.name << " 打开虚拟串口失败：" << errorString << Qt::endl;
+            return failures + 1;
+        }
+        if (!load.lossless()) {
+            out << c.name << " 接收有丢失" << Qt::endl;
+            ++failures;
+        }
+        const double megabytes = double(load.receivedBytes) / (1024.0 * 1024.0);
+        c.wakeupsPerMegabyte = megabytes > 0 ? double(load.wakeups) / megabytes : 0.0;
+
+        EchoResult echo;
+        if (!runEcho(c.backend, c.profile, 2000, echo, errorString)) {
+            out << c.name << " " << errorString << Qt::endl;
+            return failures + 1;
+        }
+        if (echo.samplesUs.isEmpty() || echo.timeouts > 0 || echo.mismatches > 0) {
+            out << c.name << " 回包超时或内容不一致" << Qt::endl;
+            ++failures;
+        }
+        c.p50 = percentile(echo.samplesUs, 50);
+        c.p99 = percentile(echo.samplesUs, 99);
+
+        out << QString("%1 %2 %3 %4 %5")
+                   .arg(c.name, 18).arg(formatRate(double(load.receivedBytes) / load.seconds), 14)
+                   .arg(c.wakeupsPerMegabyte, 10, 'f', 1).arg(c.p50, 10, 'f', 1).arg(c.p99, 10, 'f', 1) << Qt::endl;
+        report.add("backend", c.name + "_wakeups_per_mb", c.wakeupsPerMegabyte, "count/MB");
+        report.add("backend", c.name + "_echo_p50", c.p50, "us");
+        report.add("backend", c.name + "_echo_p99", c.p99, "us");
+    }
+
+    const BackendCase &qt = cases[0];
+    const BackendCase &latency = cases[1];
+    const BackendCase &throughput = cases[2];
+    // 唤醒次数是确定性的指标，作为通过条件；延迟受调度影响较大，只输出对比
+    if (throughput.wakeupsPerMegabyte >= qt.wakeupsPerMegabyte) {
+        out << "原生后端（吞吐）每MB唤醒次数没有少于 QSerialPort" << Qt::endl;
+        ++failures;
+    }
+    out << QString("唤醒/MB：原生(吞吐) 为 QSerialPort 的 %1%；回环 p50：原生(低延迟) 为 QSerialPort 的 %2%")
+               .arg(qt.wakeupsPerMegabyte > 0 ? throughput.wakeupsPerMegabyte * 100.0 / qt.wakeupsPerMegabyte : 0.0, 0, 'f', 1)
+               .arg(qt.p50 > 0 ? latency.p50 * 100.0 / qt.p50 : 0.0, 0, 'f', 1) << Qt::endl;
+    return failures;
+}
+
+// 软件流控：对端扮演处理速度有限的慢速设备，缓冲超过高水位发 XOFF、降到低水位发 XON。
+// 应用按发送队列余量持续提交数据，对端收到的字节数必须与提交的一致且设备缓冲从未溢出。
+int runFlowControlBenchmark(QTextStream &out, BenchReport &report)
+{
+    if (!VirtualPort::isSupported()) {
+        out << "当前平台不支持伪终端，跳过" << Qt::endl;
+        return 0;
+    }
+
+    struct FlowCase {
+        QString name;
+        QString flowControl;
+        SerialPortManager::Backend backend;
+    };
+    QList<FlowCase> cases = {
+        {"none", "none", SerialPortManager::QtBackend},
+        {"xonxoff_qt", "xonxoff", SerialPortManager::QtBackend},
+    };
+    if (NativeSerialPort::isSupported()) {
+        cases.append({"xonxoff_native", "xonxoff", SerialPortManager::NativeBackend});
+    }
+
+    const qint64 totalBytes = 512 * 1024;
+    const qint64 queueLimit = 64 * 1024;
+    const QByteArray chunk(4096, 'F');
+    int failures = 0;
+    out << QString("%1 %2 %3 %4 %5 %6")
+               .arg("流控", 16).arg("对端收到", 12).arg("设备溢出", 10).arg("XOFF次数", 10)
+               .arg("发送速率", 14).arg("结果", 6) << Qt::endl;
+
+    for (const FlowCase &c : cases) {
+        VirtualPortOptions options;
+        options.mode = VirtualPortOptions::Throttle;
+        options.throttleBytesPerSecond = 256 * 1024;
+        VirtualPort port(options);
+        if (!port.open()) {
+            out << "打开虚拟串口失败：" << port.errorString() << Qt::endl;
+            return failures + 1;
+        }
+
+        QThread ioThread;
+        SerialPortManager *manager = new SerialPortManager;
+        manager->moveToThread(&ioThread);
+        QObject::connect(&ioThread, &QThread::finished, manager, &QObject::deleteLater);
+        ioThread.start(QThread::TimeCriticalPriority);
+
+        manager->setBackend(c.backend);
+        manager->setSendQueueLimit(queueLimit, SerialPortManager::Block);
+        if (!manager->openPort(port.portName(), BENCH_BAUD_RATE, 8, 1, "NoParity", c.flowControl)) {
+            out << c.name << " 打开串口失败：" << manager->getErrorString() << Qt::endl;
+            manager->closePort();
+            ioThread.quit();
+            ioThread.wait();
+            return failures + 1;
+        }
+
+        // 只在队列有余量时提交，模拟按队列深度节流的发送方（如发送固件）
+        qint64 submitted = 0;
+        QElapsedTimer elapsed;
+        elapsed.start();
+        QEventLoop loop;
+        QTimer sender;
+        sender.setInterval(2);
+        QObject::connect(&sender, &QTimer::timeout, &loop, [&]() {
+            while (submitted < totalBytes && manager->getQueuedBytes() + chunk.size() <= queueLimit) {
+                if (manager->sendData(chunk) <= 0) {
+                    break;
+                }
+                submitted += chunk.size();
+            }
+            const bool delivered = submitted >= totalBytes && qint64(port.peerReceivedBytes()) >= totalBytes;
+            if (delivered || elapsed.elapsed() > 15000) {
+                loop.quit();
+            }
+        });
+        sender.start();
+        loop.exec();
+        sender.stop();
+        const double seconds = double(elapsed.nsecsElapsed()) / 1e9;
+
+        manager->closePort();
+        ioThread.quit();
+        ioThread.wait();
+        port.close();
+
+        const qint64 received = qint64(port.peerReceivedBytes());
+        const quint64 overflow = port.peerOverflowBytes();
+        const bool lossless = received == totalBytes && overflow == 0;
+        out << QString("%1 %2 %3 %4 %5 %6")
+                   .arg(c.name, 16).arg(received, 12).arg(overflow, 10).arg(port.peerPauseCount(), 10)
+                   .arg(formatRate(double(received) / seconds), 14).arg(lossless ? "无丢失" : "有丢失", 6) << Qt::endl;
+        report.add("flowcontrol", c.name + "_overflow", double(overflow), "B");
+        report.add("flowcontrol", c.name + "_rate", double(received) / seconds, "B/s");
+
+        // 不启用流控的一组只作对照
+        if (c.flowControl != "none" && (!lossless || port.peerPauseCount() == 0)) {
+            out << c.name << " 流控下仍有丢失或未触发暂停" << Qt::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
@@ -1,19 +1,59 @@
 #include "buttondatabase.h"
 #include <QDebug>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+// 最后一次修改后等待该时间再保存，连续修改合并为一次写入
+static const int SAVE_DELAY_MS = 500;
+// 连续修改时距第一次未保存的修改最长的保存间隔
+static const int MAX_SAVE_DELAY_MS = 2000;
 
 ButtonDatabase::ButtonDatabase(QObject *parent)
+    : ButtonDatabase(QString(), parent)
+{
+}
+
+ButtonDatabase::ButtonDatabase(const QString &filePath, QObject *parent)
     : QObject(parent)
-    , tableRows(6)
-    , tableCols(8)
+    , dirty(false)
+    , saveTimer(new QTimer(this))
+    , writerThread(nullptr)
+    , contentPending(false)
+    , writing(false)
+    , stopWriter(false)
+    , lastWriteOk(true)
 {
-    initializeConfig();
+    if (filePath.isEmpty()) {
+        initializeConfig();
+    } else {
+        configFilePath = filePath;
+    }
+    const QFileInfo configInfo(configFilePath);
+    cacheFilePath = configInfo.path() + "/" + configInfo.completeBaseName() + ".cache";
+
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(SAVE_DELAY_MS);
+    connect(saveTimer, &QTimer::timeout, this, &ButtonDatabase::scheduleSave);
+
+    writerThread = QThread::create([this]() { runWriter(); });
+    writerThread->setObjectName("ConfigWriter");
+    writerThread->start(QThread::LowPriority);
+
     loadFromFile();
 }
 
 ButtonDatabase::~ButtonDatabase()
 {
-    saveToFile();
-    delete settings;
+    flush();
+
+    {
+        QMutexLocker locker(&writerMutex);
+        stopWriter = true;
+    }
+    writerCondition.wakeAll();
+    writerThread->wait();
+    delete writerThread;
 }
 
 void ButtonDatabase::initializeConfig()
@@ -23,280 +63,315 @@ void ButtonDatabase::initializeConfig()
     QDir().mkpath(exeDir);
 
     configFilePath = exeDir + "/flex_serialport_config.yaml";
+}
+
+ConfigData &ButtonDatabase::current()
+{
+    return configSet.profiles[configSet.activeProfile].data;
+}
+
+const ConfigData &ButtonDatabase::current() const
+{
+    return configSet.profiles.at(configSet.activeProfile).data;
+}
+
+void ButtonDatabase::markDirty()
+{
+    if (!dirty) {
+        dirty = true;
+        dirtyClock.start();
+    }
+    // 连续修改时推迟保存，但距第一次修改不超过 MAX_SAVE_DELAY_MS
+    if (dirtyClock.elapsed() < MAX_SAVE_DELAY_MS || !saveTimer->isActive()) {
+        saveTimer->start();
+    }
+}
+
+void ButtonDatabase::scheduleSave()
+{
+    if (!dirty) {
+        return;
+    }
+    // GUI线程只复制一份配置快照（按键网格隐式共享），生成文件内容和写文件都交给后台线程
+    dirty = false;
+    {
+        QMutexLocker locker(&writerMutex);
+        pendingData = configSet;
+        contentPending = true;
+    }
+    writerCondition.wakeAll();
+}
 
-    // 使用QSettings模拟YAML格式（实际为INI格式，但文件名为.yaml）
-    settings = new QSettings(configFilePath, QSettings::IniFormat);
-    // Qt6中已移除setIniCodec，默认使用UTF-8编码
+bool ButtonDatabase::flush()
+{
+    saveTimer->stop();
+    scheduleSave();
+
+    QMutexLocker locker(&writerMutex);
+    while (contentPending || writing) {
+        writerCondition.wait(&writerMutex);
+    }
+    return lastWriteOk;
 }
 
-QString ButtonDatabase::makeKey(int row, int col) const
+void ButtonDatabase::runWriter()
 {
-    return QString("%1,%2").arg(row).arg(col);
+    QMutexLocker locker(&writerMutex);
+    while (true) {
+        while (!contentPending && !stopWriter) {
+            writerCondition.wait(&writerMutex);
+        }
+        if (!contentPending) {
+            return;
+        }
+
+        // 只写最新的内容，写入期间的修改在下一轮写入
+        const ConfigSet data = pendingData;
+        pendingData = ConfigSet();
+        contentPending = false;
+        writing = true;
+        locker.unlock();
+
+        const bool ok = writeFile(data);
+
+        locker.relock();
+        writing = false;
+        lastWriteOk = ok;
+        writerCondition.wakeAll();
+    }
 }
 
-void ButtonDatabase::setButtonData(int row, int col, const QString &remark, const QString &command, bool isHexCommand)
+bool ButtonDatabase::writeFile(const ConfigSet &data) const
 {
-    QString key = makeKey(row, col);
-    ButtonData data(remark, command, row, col, isHexCommand);
-    buttonMap[key] = data;
+    const QByteArray content = ConfigFile::toYaml(data);
+    QSaveFile file(configFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法打开配置文件进行写入:" << configFilePath;
+        return false;
+    }
+    if (file.write(content) != content.size() || !file.commit()) {
+        qDebug() << "写入配置文件失败:" << configFilePath << file.errorString();
+        return false;
+    }
 
-    saveToFile(); // 直接保存整个文件
+    // 缓存记录配置文件写入后的大小和修改时间，写入失败只影响下次启动的速度
+    const QFileInfo source(configFilePath);
+    const QByteArray cache = ConfigFile::toCache(data, source.size(), source.lastModified().toMSecsSinceEpoch());
+    QSaveFile cacheFile(cacheFilePath);
+    if (!cacheFile.open(QIODevice::WriteOnly) || cacheFile.write(cache) != cache.size() || !cacheFile.commit()) {
+        qDebug() << "写入配置缓存失败:" << cacheFilePath;
+    }
+    return true;
+}
+
+void ButtonDatabase::setButtonData(int row, int col, const QString &remark, const QString &command, bool isHexCommand,
+                                   ButtonData::Type type)
+{
+    if (!current().buttons.set(ButtonData(remark, command, row, col, isHexCommand, type))) {
+        return;
+    }
+
+    markDirty();
+    emit buttonChanged(row, col);
     emit dataChanged();
 }
 
-ButtonData ButtonDatabase::getButtonData(int row, int col) const
+const ButtonData &ButtonDatabase::getButtonData(int row, int col) const
 {
-    QString key = makeKey(row, col);
-    return buttonMap.value(key, ButtonData());
+    return current().buttons.at(row, col);
 }
 
 void ButtonDatabase::removeButtonData(int row, int col)
 {
-    QString key = makeKey(row, col);
-    buttonMap.remove(key);
+    if (!current().buttons.remove(row, col)) {
+        return;
+    }
+
+    markDirty();
+    emit buttonChanged(row, col);
+    emit dataChanged();
+}
+
+void ButtonDatabase::removeRow(int row)
+{
+    if (row < 0 || row >= current().buttons.rowCount()) {
+        return;
+    }
+    current().buttons.removeRow(row);
 
-    saveToFile(); // 直接保存整个文件
+    markDirty();
     emit dataChanged();
 }
 
 void ButtonDatabase::clearAllButtons()
 {
-    buttonMap.clear();
-    settings->beginGroup("Buttons");
-    settings->clear();
-    settings->endGroup();
+    current().buttons.clear();
 
+    markDirty();
     emit dataChanged();
 }
 
-QMap<QString, ButtonData> ButtonDatabase::getAllButtons() const
+const ButtonGrid &ButtonDatabase::getButtons() const
 {
-    return buttonMap;
+    return current().buttons;
 }
 
 void ButtonDatabase::setSerialConfig(const SerialPortConfig &config)
 {
-    serialConfig = config;
-
-    settings->beginGroup("SerialPort");
-    settings->setValue("portName", config.portName);
-    settings->setValue("baudRate", config.baudRate);
-    settings->setValue("dataBits", config.dataBits);
-    settings->setValue("stopBits", config.stopBits);
-    settings->setValue("parity", config.parity);
-    settings->setValue("timestampDisplay", config.timestampDisplay);
-    settings->setValue("hexDisplay", config.hexDisplay);
-    settings->setValue("hexSend", config.hexSend);
-    settings->setValue("autoSendEnter", config.autoSendEnter);
-    settings->setValue("enterChars", config.enterChars);
-    settings->setValue("encoding", config.encoding);
-    settings->endGroup();
-
-    settings->sync();
+    current().serialConfig = config;
+    markDirty();
 }
 
 SerialPortConfig ButtonDatabase::getSerialConfig() const
 {
-    return serialConfig;
+    return current().serialConfig;
 }
 
 void ButtonDatabase::setTableSize(int rows, int cols)
 {
-    tableRows = rows;
-    tableCols = cols;
-
-    settings->beginGroup("Table");
-    settings->setValue("rows", rows);
-    settings->setValue("cols", cols);
-    settings->endGroup();
-
-    settings->sync();
+    if (current().tableRows == rows && current().tableCols == cols) {
+        return;
+    }
+    current().tableRows = rows;
+    current().tableCols = cols;
+    markDirty();
 }
 
 QPair<int, int> ButtonDatabase::getTableSize() const
 {
-    return QPair<int, int>(tableRows, tableCols);
+    return QPair<int, int>(current().tableRows, current().tableCols);
 }
 
 // 窗口几何信息相关方法已移除
 
-bool ButtonDatabase::saveToFile()
+QStringList ButtonDatabase::getProfileNames() const
 {
-    // 使用自定义YAML格式保存
-    QFile file(configFilePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "无法打开配置文件进行写入:" << configFilePath;
-        return false;
+    QStringList names;
+    for (const ConfigProfile &profile : configSet.profiles) {
+        names << profile.name;
     }
+    return names;
+}
 
-    QTextStream out(&file);
-    out.setEncoding(QStringConverter::Utf8); // Qt6中使用setEncoding
-
-    // 写入YAML格式的配置
-    out << "# Flex SerialPort Configuration File\n";
-    out << "# 自动生成，请勿手动编辑\n\n";
-
-    // 保存串口配置
-    out << "SerialPort:\n";
-    out << "  portName: \"" << serialConfig.portName << "\"\n";
-    out << "  baudRate: " << serialConfig.baudRate << "\n";
-    out << "  dataBits: " << serialConfig.dataBits << "\n";
-    out << "  stopBits: " << serialConfig.stopBits << "\n";
-    out << "  parity: \"" << serialConfig.parity << "\"\n";
-    out << "  timestampDisplay: " << (serialConfig.timestampDisplay ? "true" : "false") << "\n";
-    out << "  hexDisplay: " << (serialConfig.hexDisplay ? "true" : "false") << "\n";
-    out << "  hexSend: " << (serialConfig.hexSend ? "true" : "false") << "\n";
-    out << "  autoSendEnter: " << (serialConfig.autoSendEnter ? "true" : "false") << "\n";
-    out << "  enterChars: \"" << serialConfig.enterChars << "\"\n";
-    out << "  encoding: \"" << serialConfig.encoding << "\"\n\n";
-
-    // 保存表格配置
-    out << "Table:\n";
-    out << "  rows: " << tableRows << "\n";
-    out << "  cols: " << tableCols << "\n\n";
-
-    // 窗口配置已移除，不再保存窗口几何信息
-
-    // 保存按键数据
-    if (!buttonMap.isEmpty()) {
-        out << "Buttons:\n";
-        for (auto it = buttonMap.begin(); it != buttonMap.end(); ++it) {
-            const ButtonData &data = it.value();
-            if (data.isValid) {
-                out << "  \"" << it.key() << "\":\n";
-                out << "    remark: \"" << data.remark << "\"\n";
-                out << "    command: \"" << data.command << "\"\n";
-                out << "    row: " << data.row << "\n";
-                out << "    col: " << data.col << "\n";
-                out << "    isValid: " << (data.isValid ? "true" : "false") << "\n";
-            }
-        }
+int ButtonDatabase::getActiveProfile() const
+{
+    return configSet.activeProfile;
+}
+
+QString ButtonDatabase::getActiveProfileName() const
+{
+    return configSet.profiles.at(configSet.activeProfile).name;
+}
+
+bool ButtonDatabase::setActiveProfile(int index)
+{
+    if (index < 0 || index >= configSet.profiles.size()) {
+        return false;
+    }
+    if (index == configSet.activeProfile) {
+        return true;
     }
 
-    file.close();
+    emit activeProfileAboutToChange();
+    configSet.activeProfile = index;
+    markDirty();
+    emit activeProfileChanged();
+    emit dataChanged();
     return true;
 }
 
-bool ButtonDatabase::loadFromFile()
+int ButtonDatabase::addProfile(const QString &name, bool copyCurrent)
 {
-    buttonMap.clear();
+    if (name.isEmpty() || configSet.indexOf(name) >= 0) {
+        return -1;
+    }
 
-    QFile configFile(configFilePath);
-    if(!configFile.exists()){
-        return false;
+    ConfigProfile profile;
+    profile.name = name;
+    if (copyCurrent) {
+        profile.data = current();
     }
+    configSet.profiles.append(profile);
+    const int index = int(configSet.profiles.size()) - 1;
+    emit profilesChanged();
+    setActiveProfile(index);
+    return index;
+}
 
-    if (!configFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+bool ButtonDatabase::renameProfile(int index, const QString &name)
+{
+    if (index < 0 || index >= configSet.profiles.size() || name.isEmpty()) {
+        return false;
+    }
+    const int existing = configSet.indexOf(name);
+    if (existing == index) {
+        return true;
+    }
+    if (existing >= 0) {
         return false;
     }
 
-    QTextStream in(&configFile);
-    in.setEncoding(QStringConverter::Utf8);
-
-    QString currentSection;
-    QString currentButtonKey;
-    ButtonData currentButtonData;
+    configSet.profiles[index].name = name;
+    markDirty();
+    emit profilesChanged();
+    return true;
+}
 
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        QString trimmedLine = line.trimmed();
+bool ButtonDatabase::removeProfile(int index)
+{
+    if (index < 0 || index >= configSet.profiles.size() || configSet.profiles.size() <= 1) {
+        return false;
+    }
 
-        // 跳过注释和空行
-        if (trimmedLine.isEmpty() || trimmedLine.startsWith("#")) {
-            continue;
+    if (index != configSet.activeProfile) {
+        configSet.profiles.remove(index);
+        if (index < configSet.activeProfile) {
+            --configSet.activeProfile;
         }
+        markDirty();
+        emit profilesChanged();
+        return true;
+    }
 
-        // 检查是否是节标题 (顶级节，不以空格开头)
-        if (trimmedLine.endsWith(":") && !line.startsWith(" ")) {
-            // 保存之前的按键数据
-            if (!currentButtonKey.isEmpty() && currentButtonData.isValid) {
-                buttonMap[currentButtonKey] = currentButtonData;
-                currentButtonKey.clear();
-                currentButtonData = ButtonData();
-            }
-
-            currentSection = trimmedLine.left(trimmedLine.length() - 1);
-            continue;
-        }
+    // 删除当前配置：切换到相邻的配置
+    emit activeProfileAboutToChange();
+    configSet.profiles.remove(index);
+    configSet.activeProfile = qMin(index, int(configSet.profiles.size()) - 1);
+    markDirty();
+    emit activeProfileChanged();
+    emit profilesChanged();
+    emit dataChanged();
+    return true;
+}
 
-        // 在Buttons节中处理按键数据
-        if (currentSection == "Buttons") {
-            // 检查是否是按键名 (两个空格缩进，以引号开头，以冒号结尾)
-            if (line.startsWith("  ") && !line.startsWith("    ") && trimmedLine.startsWith("\"") && trimmedLine.endsWith(":")) {
-                // 保存之前的按键数据
-                if (!currentButtonKey.isEmpty() && currentButtonData.isValid) {
-                    buttonMap[currentButtonKey] = currentButtonData;
-                }
-
-                // 提取按键名 (去掉引号和冒号)
-                currentButtonKey = trimmedLine.mid(1, trimmedLine.length() - 3);
-                currentButtonData = ButtonData();
-                currentButtonData.isValid = true;
-                continue;
-            }
-
-            // 检查是否是按键属性 (四个空格缩进)
-            if (line.startsWith("    ") && trimmedLine.contains(":")) {
-                QStringList parts = trimmedLine.split(":", Qt::SkipEmptyParts);
-                if (parts.size() >= 2) {
-                    QString key = parts[0].trimmed();
-                    QString value = parts[1].trimmed().remove("\"");
-
-                    if (key == "remark") {
-                        currentButtonData.remark = value;
-                    }
-                    else if (key == "command") {
-                        currentButtonData.command = value;
-                    }
-                    else if (key == "row") {
-                        currentButtonData.row = value.toInt();
-                    }
-                    else if (key == "col") {
-                        currentButtonData.col = value.toInt();
-                    }
-                    else if (key == "isValid") {
-                        currentButtonData.isValid = (value == "true");
-                    }
-                }
-                continue;
-            }
-        }
+bool ButtonDatabase::loadFromFile()
+{
+    configSet = ConfigSet();
 
-        // 处理其他节的键值对
-        if (trimmedLine.contains(":") && line.startsWith("  ") && !line.startsWith("    ")) {
-            QStringList parts = trimmedLine.split(":", Qt::SkipEmptyParts);
-            if (parts.size() >= 2) {
-                QString key = parts[0].trimmed();
-                QString value = parts[1].trimmed().remove("\"");
-
-                if (currentSection == "SerialPort") {
-                    if (key == "portName") serialConfig.portName = value;
-                    else if (key == "baudRate") serialConfig.baudRate = value.toInt();
-                    else if (key == "dataBits") serialConfig.dataBits = value.toInt();
-                    else if (key == "stopBits") serialConfig.stopBits = value.toInt();
-                    else if (key == "parity") serialConfig.parity = value;
-                    else if (key == "timestampDisplay") serialConfig.timestampDisplay = (value == "true");
-                    else if (key == "hexDisplay") serialConfig.hexDisplay = (value == "true");
-                    else if (key == "hexSend") serialConfig.hexSend = (value == "true");
-                    else if (key == "autoSendEnter") serialConfig.autoSendEnter = (value == "true");
-                    else if (key == "enterChars") serialConfig.enterChars = value;
-                    else if (key == "encoding") serialConfig.encoding = value;
-                }
-                else if (currentSection == "Table") {
-                    if (key == "rows") tableRows = value.toInt();
-                    else if (key == "cols") tableCols = value.toInt();
-                }
-                // Window配置已移除
-            }
-        }
+    const QFileInfo source(configFilePath);
+    if (!source.exists()) {
+        return false;
+    }
+    const qint64 sourceSize = source.size();
+    const qint64 sourceModified = source.lastModified().toMSecsSinceEpoch();
+
+    // 缓存与配置文件一致时只需读取并解析缓存
+    QFile cacheFile(cacheFilePath);
+    if (cacheFile.open(QIODevice::ReadOnly)
+        && ConfigFile::fromCache(cacheFile.readAll(), sourceSize, sourceModified, &configSet)) {
+        return true;
     }
 
-    // 保存最后一个按键数据
-    if (!currentButtonKey.isEmpty() && currentButtonData.isValid) {
-        buttonMap[currentButtonKey] = currentButtonData;
+    QFile configFile(configFilePath);
+    if (!configFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (!ConfigFile::fromYaml(configFile.readAll(), &configSet)) {
+        return false;
     }
 
-    configFile.close();
+    // 缓存缺失或已过期（旧格式文件、手动修改过），按当前格式重新保存一次并生成缓存
+    markDirty();
     return true;
 }
 
@@ -304,34 +379,3 @@ QString ButtonDatabase::getConfigFilePath() const
 {
     return configFilePath;
 }
-
-void ButtonDatabase::saveButtonToSettings(const QString &key, const ButtonData &data)
-{
-    settings->beginGroup("Buttons");
-    settings->beginGroup(key);
-    settings->setValue("remark", data.remark);
-    settings->setValue("command", data.command);
-    settings->setValue("row", data.row);
-    settings->setValue("col", data.col);
-    settings->setValue("isValid", data.isValid);
-    settings->setValue("isHexCommand", data.isHexCommand);
-    settings->endGroup(); // 结束key组
-    settings->endGroup(); // 结束Buttons组
-}
-
-ButtonData ButtonDatabase::loadButtonFromSettings(const QString &key)
-{
-    settings->beginGroup("Buttons");
-    settings->beginGroup(key);
-    ButtonData data;
-    data.remark = settings->value("remark", "").toString();
-    data.command = settings->value("command", "").toString();
-    data.row = settings->value("row", -1).toInt();
-    data.col = settings->value("col", -1).toInt();
-    data.isValid = settings->value("isValid", false).toBool();
-    data.isHexCommand = settings->value("isHexCommand", false).toBool();
-    settings->endGroup(); // 结束key组
-    settings->endGroup(); // 结束Buttons组
-
-    return data;
-}
@@ -3,8 +3,8 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QMap>
-#include <QSettings>
 #include <QStandardPaths>
 #include <QDir>
 #include <QCoreApplication>
@@ -12,66 +12,39 @@
 #include <QTextStream>
 #include <QIODevice>
 #include <QStringConverter>
-
-// 按键数据结构
-struct ButtonData {
-    QString remark;      // 按键备注
-    QString command;     // 按键指令
-    int row;            // 行位置
-    int col;            // 列位置
-    bool isValid;       // 是否有效
-    bool isHexCommand;  // 是否为16进制指令，false为字符指令
-
-    ButtonData() : row(-1), col(-1), isValid(false), isHexCommand(false) {}
-    ButtonData(const QString &r, const QString &c, int row, int col, bool isHex = false)
-        : remark(r), command(c), row(row), col(col), isValid(true), isHexCommand(isHex) {}
-};
-
-// 串口配置结构
-struct SerialPortConfig {
-    QString portName;
-    int baudRate;
-    int dataBits;
-    int stopBits;
-    QString parity;
-    bool timestampDisplay;
-    bool hexDisplay;
-    bool hexSend;
-    bool autoSendEnter;
-    QString enterChars;
-    QString encoding;  // 中文编码方式
-
-    SerialPortConfig() {
-        portName = "";
-        baudRate = 9600;
-        dataBits = 8;
-        stopBits = 1;
-        parity = "NoParity";
-        timestampDisplay = true;
-        hexDisplay = false;
-        hexSend = false;
-        autoSendEnter = true;
-        enterChars = "0D0A";
-        encoding = "UTF-8";
-    }
-};
-
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include "configfile.h"
+
+// 按键和串口配置数据库
+// 修改只更新内存并标记为脏，短暂无修改后（连续修改时最长2秒）由后台写线程保存；
+// 写入使用 QSaveFile，先写临时文件再原子替换，配置文件不会出现写了一半的情况。
+// 保存YAML后同时写二进制缓存，启动时缓存与YAML一致则直接读缓存。
+// 同一文件中保存多个命名配置（每种设备一个），以下按键、串口配置和表格大小的接口都作用于当前配置。
 class ButtonDatabase : public QObject
 {
     Q_OBJECT
 
 public:
     explicit ButtonDatabase(QObject *parent = nullptr);
+    // 使用指定的配置文件，而不是程序目录下的默认文件
+    explicit ButtonDatabase(const QString &filePath, QObject *parent = nullptr);
     ~ButtonDatabase();
 
     // 按键数据管理
-    void setButtonData(int row, int col, const QString &remark, const QString &command, bool isHexCommand = false);
-    ButtonData getButtonData(int row, int col) const;
+    void setButtonData(int row, int col, const QString &remark, const QString &command, bool isHexCommand = false,
+                       ButtonData::Type type = ButtonData::CommandButton);
+    const ButtonData &getButtonData(int row, int col) const;
     void removeButtonData(int row, int col);
+    // 删除一行按键，下面的按键上移一行
+    void removeRow(int row);
     void clearAllButtons();
 
-    // 获取所有按键数据
-    QMap<QString, ButtonData> getAllButtons() const;
+    // 获取所有按键数据（只读引用，不复制）
+    const ButtonGrid &getButtons() const;
 
     // 串口配置管理
     void setSerialConfig(const SerialPortConfig &config);
@@ -83,8 +56,21 @@ public:
 
     // 窗口配置已移除
 
+    // 命名配置
+    QStringList getProfileNames() const;
+    int getActiveProfile() const;
+    QString getActiveProfileName() const;
+    // 切换当前配置：只改变当前配置的下标，不重新读取文件
+    bool setActiveProfile(int index);
+    // 新建配置并切换过去，copyCurrent 为true时复制当前配置；名称为空或重复时返回-1
+    int addProfile(const QString &name, bool copyCurrent);
+    bool renameProfile(int index, const QString &name);
+    // 至少保留一个配置
+    bool removeProfile(int index);
+
     // 保存和加载
-    bool saveToFile();
+    // 把未保存的修改立即写入文件并等待写完（退出前调用），返回最近一次写入是否成功
+    bool flush();
     bool loadFromFile();
 
     // 获取配置文件路径
@@ -92,21 +78,43 @@ public:
 
 signals:
     void dataChanged();
+    // 单个按键被设置或删除
+    void buttonChanged(int row, int col);
+    // 当前配置切换前后（按键、串口配置和表格大小整体变化）
+    void activeProfileAboutToChange();
+    void activeProfileChanged();
+    // 配置的名称或数量变化
+    void profilesChanged();
 
 private:
-    QMap<QString, ButtonData> buttonMap;  // 使用"row,col"作为key
-    SerialPortConfig serialConfig;
-    int tableRows;
-    int tableCols;
+    ConfigSet configSet;    // 全部命名配置，每个包含串口配置、表格大小和按键网格
     // windowGeometry 已移除
 
     QString configFilePath;
-    QSettings *settings;  // 使用QSettings作为YAML的替代方案
+    QString cacheFilePath;      // 与配置文件同名的 .cache 文件
+
+    // 延迟保存
+    bool dirty;
+    QTimer *saveTimer;
+    QElapsedTimer dirtyClock;   // 第一次未保存的修改距今的时间
+
+    // 后台写线程
+    QThread *writerThread;
+    QMutex writerMutex;
+    QWaitCondition writerCondition;
+    ConfigSet pendingData;      // 待写入的配置快照（配置列表和按键网格隐式共享，不复制）
+    bool contentPending;
+    bool writing;
+    bool stopWriter;
+    bool lastWriteOk;
 
-    QString makeKey(int row, int col) const;
     void initializeConfig();
-    void saveButtonToSettings(const QString &key, const ButtonData &data);
-    ButtonData loadButtonFromSettings(const QString &key);
+    ConfigData &current();
+    const ConfigData &current() const;
+    void markDirty();
+    void scheduleSave();
+    void runWriter();
+    bool writeFile(const ConfigSet &data) const;
 };
 
 #endif // BUTTONDATABASE_H
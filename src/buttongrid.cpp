@@ -0,0 +1,170 @@
+#include "buttongrid.h"
+
+ButtonGrid::ButtonGrid()
+    : rows(0)
+    , cols(0)
+    , used(0)
+{
+}
+
+int ButtonGrid::rowCount() const
+{
+    return rows;
+}
+
+int ButtonGrid::columnCount() const
+{
+    return cols;
+}
+
+const ButtonData &ButtonGrid::at(int row, int col) const
+{
+    static const ButtonData empty;
+    if (row < 0 || col < 0 || row >= rows || col >= cols) {
+        return empty;
+    }
+    return cells.at(qsizetype(row) * cols + col);
+}
+
+bool ButtonGrid::set(const ButtonData &data)
+{
+    if (data.row < 0 || data.col < 0 || data.row >= MaxDimension || data.col >= MaxDimension) {
+        return false;
+    }
+    if (data.row >= rows || data.col >= cols) {
+        resize(qMax(rows, data.row + 1), qMax(cols, data.col + 1));
+    }
+
+    ButtonData &cell = cells[qsizetype(data.row) * cols + data.col];
+    used += int(data.isUsed()) - int(cell.isUsed());
+    cell = data;
+    return true;
+}
+
+bool ButtonGrid::remove(int row, int col)
+{
+    if (row < 0 || col < 0 || row >= rows || col >= cols) {
+        return false;
+    }
+    ButtonData &cell = cells[qsizetype(row) * cols + col];
+    if (!cell.isValid) {
+        return false;
+    }
+    used -= int(cell.isUsed());
+    cell = ButtonData();
+    return true;
+}
+
+void ButtonGrid::clear()
+{
+    cells.clear();
+    rows = 0;
+    cols = 0;
+    used = 0;
+}
+
+void ButtonGrid::insertRow(int row)
+{
+    if (row < 0 || row > rows || rows >= MaxDimension) {
+        return;
+    }
+    cells.insert(qsizetype(row) * cols, cols, ButtonData());
+    ++rows;
+    renumber(row * cols);
+}
+
+void ButtonGrid::removeRow(int row)
+{
+    if (row < 0 || row >= rows) {
+        return;
+    }
+    const qsizetype start = qsizetype(row) * cols;
+    for (qsizetype i = start; i < start + cols; ++i) {
+        used -= int(cells.at(i).isUsed());
+    }
+    cells.remove(start, cols);
+    --rows;
+    renumber(row * cols);
+}
+
+void ButtonGrid::insertColumn(int col)
+{
+    if (col < 0 || col > cols || cols >= MaxDimension) {
+        return;
+    }
+    // 从最后一行往前插入，前面的下标不受影响
+    for (int row = rows - 1; row >= 0; --row) {
+        cells.insert(qsizetype(row) * cols + col, ButtonData());
+    }
+    ++cols;
+    renumber(0);
+}
+
+void ButtonGrid::removeColumn(int col)
+{
+    if (col < 0 || col >= cols) {
+        return;
+    }
+    for (int row = rows - 1; row >= 0; --row) {
+        const qsizetype index = qsizetype(row) * cols + col;
+        used -= int(cells.at(index).isUsed());
+        cells.remove(index);
+    }
+    --cols;
+    if (cols == 0) {
+        rows = 0;
+    }
+    renumber(0);
+}
+
+bool ButtonGrid::isRowUsed(int row) const
+{
+    if (row < 0 || row >= rows) {
+        return false;
+    }
+    const qsizetype start = qsizetype(row) * cols;
+    for (qsizetype i = start; i < start + cols; ++i) {
+        if (cells.at(i).isUsed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ButtonGrid::usedCount() const
+{
+    return used;
+}
+
+void ButtonGrid::resize(int newRows, int newCols)
+{
+    if (newCols == cols) {
+        cells.resize(qsizetype(newRows) * newCols);
+    } else {
+        // 列数变化时按新的行宽重新排列
+        QVector<ButtonData> resized(qsizetype(newRows) * newCols);
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                resized[qsizetype(row) * newCols + col] = std::move(cells[qsizetype(row) * cols + col]);
+            }
+        }
+        cells.swap(resized);
+    }
+    rows = newRows;
+    cols = newCols;
+}
+
+// 从 fromIndex 开始重新填写有效按键的行列号
+void ButtonGrid::renumber(int fromIndex)
+{
+    if (cols == 0) {
+        return;
+    }
+    for (qsizetype i = fromIndex; i < cells.size(); ++i) {
+        ButtonData &data = cells[i];
+        if (data.isValid) {
+            data.row = int(i / cols);
+            data.col = int(i % cols);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef BUTTONGRID_H
+#define BUTTONGRID_H
+
+#include <QString>
+#include <QVector>
+
+// 按键数据结构
+struct ButtonData {
+    enum Type {
+        CommandButton,  // 点击发送指令
+        MacroButton     // 点击运行宏，command 为宏源文本（见 MacroProgram）
+    };
+
+    QString remark;      // 按键备注
+    QString command;     // 按键指令
+    int row;            // 行位置
+    int col;            // 列位置
+    bool isValid;       // 是否有效
+    bool isHexCommand;  // 是否为16进制指令，false为字符指令
+    Type type;          // 按键类型
+
+    ButtonData() : row(-1), col(-1), isValid(false), isHexCommand(false), type(CommandButton) {}
+    ButtonData(const QString &r, const QString &c, int row, int col, bool isHex = false, Type t = CommandButton)
+        : remark(r), command(c), row(row), col(col), isValid(true), isHexCommand(isHex), type(t) {}
+
+    // 有备注或指令的有效按键
+    bool isUsed() const { return isValid && (!remark.isEmpty() || !command.isEmpty()); }
+};
+
+// 按键网格
+// 按行优先顺序连续存放每个格子，按行列直接下标访问；行列插入删除只移动受影响的格子。
+// 设置超出当前范围的格子时自动扩展，每个方向最多 MaxDimension 格。
+class ButtonGrid
+{
+public:
+    enum { MaxDimension = 1024 };
+
+    ButtonGrid();
+
+    int rowCount() const;
+    int columnCount() const;
+
+    // 超出范围返回无效的空按键
+    const ButtonData &at(int row, int col) const;
+    // 按 data.row / data.col 放入网格，行列为负或超过上限返回false
+    bool set(const ButtonData &data);
+    // 清空一个格子，原来没有按键返回false
+    bool remove(int row, int col);
+    void clear();
+
+    // 插入/删除行列，后面的按键依次移动并更新行列号
+    void insertRow(int row);
+    void removeRow(int row);
+    void insertColumn(int col);
+    void removeColumn(int col);
+
+    bool isRowUsed(int row) const;
+    // 有备注或指令的按键数，增量维护
+    int usedCount() const;
+
+    // 按行优先顺序遍历有效按键，不复制数据
+    template <typename Visitor>
+    void forEach(Visitor visit) const
+    {
+        for (const ButtonData &data : cells) {
+            if (data.isValid) {
+                visit(data);
+            }
+        }
+    }
+
+private:
+    int rows;
+    int cols;
+    QVector<ButtonData> cells;
+    int used;
+
+    void resize(int newRows, int newCols);
+    void renumber(int fromIndex);
+};
+
+#endif // BUTTONGRID_H
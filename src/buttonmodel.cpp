@@ -0,0 +1,109 @@
+#include "buttonmodel.h"
+#include <QBrush>
+#include <QColor>
+
+ButtonModel::ButtonModel(ButtonDatabase *database, QObject *parent)
+    : QAbstractTableModel(parent)
+    , database(database)
+{
+    connect(database, &ButtonDatabase::buttonChanged, this, &ButtonModel::onButtonChanged);
+    // 切换配置时整体重置，视图只重新请求可见格子的数据
+    connect(database, &ButtonDatabase::activeProfileAboutToChange, this, &ButtonModel::beginResetModel);
+    connect(database, &ButtonDatabase::activeProfileChanged, this, &ButtonModel::endResetModel);
+}
+
+int ButtonModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : database->getTableSize().first;
+}
+
+int ButtonModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : database->getTableSize().second;
+}
+
+QVariant ButtonModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole) {
+        return int(Qt::AlignCenter);
+    }
+
+    const ButtonData &button = database->getButtonData(index.row(), index.column());
+    if (!button.isValid) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return button.remark;
+    case Qt::BackgroundRole:
+        // 适配黑色主题：有指令的按键浅蓝色，宏按键浅橙色，只有备注的按键浅绿色
+        if (button.command.isEmpty()) {
+            return QBrush(QColor(144, 238, 144));
+        }
+        return QBrush(button.type == ButtonData::MacroButton ? QColor(255, 218, 185) : QColor(173, 216, 230));
+    case Qt::ForegroundRole:
+        return QBrush(QColor(0, 0, 0));
+    default:
+        return QVariant();
+    }
+}
+
+QVariant ButtonModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return QString("按键%1").arg(section + 1);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool ButtonModel::insertRows(int row, int count, const QModelIndex &parent)
+{
+    const QPair<int, int> size = database->getTableSize();
+    // 与 ButtonGrid 一致，每个方向最多 MaxDimension 格，超出时拒绝插入
+    if (parent.isValid() || count < 1 || row != size.first || size.first + count > ButtonGrid::MaxDimension) {
+        return false;
+    }
+    beginInsertRows(QModelIndex(), row, row + count - 1);
+    database->setTableSize(size.first + count, size.second);
+    endInsertRows();
+    return true;
+}
+
+bool ButtonModel::insertColumns(int column, int count, const QModelIndex &parent)
+{
+    const QPair<int, int> size = database->getTableSize();
+    if (parent.isValid() || count < 1 || column != size.second || size.second + count > ButtonGrid::MaxDimension) {
+        return false;
+    }
+    beginInsertColumns(QModelIndex(), column, column + count - 1);
+    database->setTableSize(size.first, size.second + count);
+    endInsertColumns();
+    return true;
+}
+
+bool ButtonModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    const QPair<int, int> size = database->getTableSize();
+    if (parent.isValid() || count < 1 || row < 0 || row + count > size.first) {
+        return false;
+    }
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    for (int i = 0; i < count; ++i) {
+        database->removeRow(row);
+    }
+    database->setTableSize(size.first - count, size.second);
+    endRemoveRows();
+    return true;
+}
+
+void ButtonModel::onButtonChanged(int row, int col)
+{
+    const QModelIndex cell = index(row, col);
+    if (cell.isValid()) {
+        emit dataChanged(cell, cell, {Qt::DisplayRole, Qt::BackgroundRole, Qt::ForegroundRole});
+    }
+}
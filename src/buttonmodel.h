@@ -0,0 +1,34 @@
+#ifndef BUTTONMODEL_H
+#define BUTTONMODEL_H
+
+#include <QAbstractTableModel>
+#include "buttondatabase.h"
+
+// 自定义按键表格模型
+// 直接读取 ButtonDatabase 中的按键网格和表格大小，不为每个格子创建条目；
+// 视图只请求可见格子的数据。单个按键修改时只通知该格子刷新，切换配置时重置模型。
+class ButtonModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ButtonModel(ButtonDatabase *database, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // 只支持在末尾添加行列；删除行时数据库中下面的按键上移
+    bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    bool insertColumns(int column, int count, const QModelIndex &parent = QModelIndex()) override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+private slots:
+    void onButtonChanged(int row, int col);
+
+private:
+    ButtonDatabase *database;
+};
+
+#endif // BUTTONMODEL_H
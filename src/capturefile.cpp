@@ -0,0 +1,611 @@
+#include "capturefile.h"
+#include "hexcodec.h"
+#include <QtEndian>
+#include <QDateTime>
+#include <algorithm>
+#include <cstring>
+
+// 写入缓冲攒到该大小后落到文件
+static const qsizetype WRITE_BUFFER_SIZE = 1024 * 1024;
+
+// 单条记录负载上限，读取时用于识别损坏的记录
+static const quint32 MAX_RECORD_LENGTH = 256 * 1024 * 1024;
+
+static void putRecordHeader(char *out, quint8 direction, quint8 portId, quint32 length, qint64 timestampNs)
+{
+    out[0] = char(direction);
+    out[1] = char(portId);
+    out[2] = 0;
+    out[3] = 0;
+    qToLittleEndian<quint32>(length, out + 4);
+    qToLittleEndian<qint64>(timestampNs, out + 8);
+}
+
+// ==================== CaptureFileWriter ====================
+
+CaptureFileWriter::CaptureFileWriter()
+    : offset(0)
+    , lastIndexedOffset(0)
+    , records(0)
+{
+}
+
+CaptureFileWriter::~CaptureFileWriter()
+{
+    close();
+}
+
+bool CaptureFileWriter::open(const QString &filePath, qint64 wallOffsetNs)
+{
+    close();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        lastError = file.errorString();
+        return false;
+    }
+
+    char header[CaptureFormat::FileHeaderSize];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, CaptureFormat::FileMagic, 8);
+    qToLittleEndian<quint16>(CaptureFormat::Version, header + 8);
+    qToLittleEndian<quint16>(quint16(CaptureFormat::FileHeaderSize), header + 10);
+    qToLittleEndian<qint64>(wallOffsetNs, header + 16);
+
+    buffer.clear();
+    buffer.reserve(WRITE_BUFFER_SIZE + CaptureFormat::RecordHeaderSize);
+    buffer.append(header, sizeof(header));
+    index.clear();
+    offset = CaptureFormat::FileHeaderSize;
+    lastIndexedOffset = -CaptureFormat::IndexInterval;
+    records = 0;
+    return true;
+}
+
+void CaptureFileWriter::writeRecord(quint8 direction, quint8 portId, qint64 timestampNs, const char *data, qsizetype len)
+{
+    if (!file.isOpen() || len < 0) {
+        return;
+    }
+
+    // 每隔IndexInterval字节记一条索引，定位时最多顺序扫描这么多数据
+    if (offset - lastIndexedOffset >= CaptureFormat::IndexInterval) {
+        const IndexEntry entry = {timestampNs, offset};
+        index.append(entry);
+        lastIndexedOffset = offset;
+    }
+
+    const qsizetype pos = buffer.size();
+    buffer.resize(pos + CaptureFormat::RecordHeaderSize + len);
+    char *out = buffer.data() + pos;
+    putRecordHeader(out, direction, portId, quint32(len), timestampNs);
+    if (len > 0) {
+        std::memcpy(out + CaptureFormat::RecordHeaderSize, data, size_t(len));
+    }
+
+    offset += CaptureFormat::RecordHeaderSize + len;
+    ++records;
+
+    if (buffer.size() >= WRITE_BUFFER_SIZE) {
+        flushBuffer();
+    }
+}
+
+bool CaptureFileWriter::flush()
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+    flushBuffer();
+    return file.flush() && lastError.isEmpty();
+}
+
+bool CaptureFileWriter::close()
+{
+    if (!file.isOpen()) {
+        return true;
+    }
+
+    flushBuffer();
+
+    // 文件尾部写入索引，读取端打开时直接加载
+    QByteArray footer;
+    footer.resize(index.size() * CaptureFormat::IndexEntrySize + CaptureFormat::TrailerSize);
+    char *out = footer.data();
+    for (const IndexEntry &entry : index) {
+        qToLittleEndian<qint64>(entry.timestampNs, out);
+        qToLittleEndian<qint64>(entry.offset, out + 8);
+        out += CaptureFormat::IndexEntrySize;
+    }
+    qToLittleEndian<quint64>(quint64(offset), out);
+    qToLittleEndian<quint64>(quint64(index.size()), out + 8);
+    qToLittleEndian<quint64>(quint64(records), out + 16);
+    std::memcpy(out + 24, CaptureFormat::IndexMagic, 8);
+
+    bool ok = file.write(footer) == footer.size();
+    if (!ok) {
+        lastError = file.errorString();
+    }
+    file.close();
+    return ok;
+}
+
+bool CaptureFileWriter::isOpen() const
+{
+    return file.isOpen();
+}
+
+qint64 CaptureFileWriter::size() const
+{
+    return offset;
+}
+
+qint64 CaptureFileWriter::recordCount() const
+{
+    return records;
+}
+
+QFile *CaptureFileWriter::device()
+{
+    return &file;
+}
+
+QString CaptureFileWriter::errorString() const
+{
+    return lastError;
+}
+
+void CaptureFileWriter::flushBuffer()
+{
+    if (buffer.isEmpty()) {
+        return;
+    }
+    if (file.write(buffer) != buffer.size()) {
+        lastError = file.errorString();
+    }
+    buffer.resize(0);
+}
+
+// ==================== CaptureFileReader ====================
+
+CaptureFileReader::CaptureFileReader()
+    : wallOffset(0)
+    , dataEnd(0)
+    , readPos(0)
+    , records(0)
+    , lastTime(0)
+{
+}
+
+bool CaptureFileReader::open(const QString &filePath)
+{
+    close();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        lastError = file.errorString();
+        return false;
+    }
+
+    char header[CaptureFormat::FileHeaderSize];
+    if (file.read(header, sizeof(header)) != qint64(sizeof(header)) ||
+        std::memcmp(header, CaptureFormat::FileMagic, 8) != 0) {
+        lastError = "不是有效的录制文件";
+        file.close();
+        return false;
+    }
+    if (qFromLittleEndian<quint16>(header + 8) > CaptureFormat::Version) {
+        lastError = "录制文件版本过新，无法读取";
+        file.close();
+        return false;
+    }
+    wallOffset = qFromLittleEndian<qint64>(header + 16);
+
+    if (!readIndex() && !rebuildIndex()) {
+        file.close();
+        return false;
+    }
+
+    // 最后一条记录的时间：从最后一个索引点向后扫描
+    lastTime = index.isEmpty() ? 0 : index.last().timestampNs;
+    qint64 pos = index.isEmpty() ? dataEnd : index.last().offset;
+    CaptureRecord record;
+    quint32 length = 0;
+    while (pos < dataEnd && readRecordHeader(pos, &record, &length)) {
+        lastTime = record.timestampNs;
+        pos += CaptureFormat::RecordHeaderSize + length;
+    }
+
+    readPos = CaptureFormat::FileHeaderSize;
+    return true;
+}
+
+void CaptureFileReader::close()
+{
+    if (file.isOpen()) {
+        file.close();
+    }
+    index.clear();
+    wallOffset = 0;
+    dataEnd = 0;
+    readPos = 0;
+    records = 0;
+    lastTime = 0;
+}
+
+bool CaptureFileReader::isCaptureFile(const QString &filePath)
+{
+    QFile probe(filePath);
+    if (!probe.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return probe.read(8) == QByteArray(CaptureFormat::FileMagic, 8);
+}
+
+qint64 CaptureFileReader::wallOffsetNs() const
+{
+    return wallOffset;
+}
+
+qint64 CaptureFileReader::recordCount() const
+{
+    return records;
+}
+
+qint64 CaptureFileReader::firstTimestamp() const
+{
+    return index.isEmpty() ? 0 : index.first().timestampNs;
+}
+
+qint64 CaptureFileReader::lastTimestamp() const
+{
+    return lastTime;
+}
+
+QString CaptureFileReader::errorString() const
+{
+    return lastError;
+}
+
+bool CaptureFileReader::seekToTime(qint64 timestampNs)
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    // 索引上二分找到目标所在区间，再在区间内顺序扫描
+    auto it = std::lower_bound(index.constBegin(), index.constEnd(), timestampNs,
+                               [](const IndexEntry &entry, qint64 value) { return entry.timestampNs < value; });
+    qint64 pos = (it == index.constBegin()) ? qint64(CaptureFormat::FileHeaderSize) : (it - 1)->offset;
+
+    CaptureRecord record;
+    quint32 length = 0;
+    while (pos < dataEnd && readRecordHeader(pos, &record, &length)) {
+        if (record.timestampNs >= timestampNs) {
+            break;
+        }
+        pos += CaptureFormat::RecordHeaderSize + length;
+    }
+    readPos = pos;
+    return pos < dataEnd;
+}
+
+bool CaptureFileReader::seekToStart()
+{
+    readPos = CaptureFormat::FileHeaderSize;
+    return file.isOpen();
+}
+
+bool CaptureFileReader::readNext(CaptureRecord *record)
+{
+    quint32 length = 0;
+    if (!file.isOpen() || readPos >= dataEnd || !readRecordHeader(readPos, record, &length)) {
+        return false;
+    }
+    record->payload = file.read(length);
+    if (record->payload.size() != qsizetype(length)) {
+        return false;
+    }
+    readPos += CaptureFormat::RecordHeaderSize + length;
+    return true;
+}
+
+bool CaptureFileReader::readIndex()
+{
+    const qint64 fileSize = file.size();
+    if (fileSize < CaptureFormat::FileHeaderSize + CaptureFormat::TrailerSize) {
+        return false;
+    }
+
+    char trailer[CaptureFormat::TrailerSize];
+    if (!file.seek(fileSize - CaptureFormat::TrailerSize) ||
+        file.read(trailer, sizeof(trailer)) != qint64(sizeof(trailer)) ||
+        std::memcmp(trailer + 24, CaptureFormat::IndexMagic, 8) != 0) {
+        return false;
+    }
+
+    const quint64 indexOffset = qFromLittleEndian<quint64>(trailer);
+    const quint64 indexCount = qFromLittleEndian<quint64>(trailer + 8);
+    if (indexOffset < quint64(CaptureFormat::FileHeaderSize) ||
+        indexOffset + indexCount * CaptureFormat::IndexEntrySize + CaptureFormat::TrailerSize != quint64(fileSize)) {
+        return false;
+    }
+
+    file.seek(qint64(indexOffset));
+    const QByteArray raw = file.read(qint64(indexCount) * CaptureFormat::IndexEntrySize);
+    if (raw.size() != qsizetype(indexCount) * CaptureFormat::IndexEntrySize) {
+        return false;
+    }
+
+    index.resize(qsizetype(indexCount));
+    const char *in = raw.constData();
+    for (IndexEntry &entry : index) {
+        entry.timestampNs = qFromLittleEndian<qint64>(in);
+        entry.offset = qFromLittleEndian<qint64>(in + 8);
+        in += CaptureFormat::IndexEntrySize;
+    }
+    dataEnd = qint64(indexOffset);
+    records = qint64(qFromLittleEndian<quint64>(trailer + 16));
+    return true;
+}
+
+bool CaptureFileReader::rebuildIndex()
+{
+    // 录制未正常结束时没有文件尾，顺序扫描到最后一条完整记录为止
+    index.clear();
+    records = 0;
+    dataEnd = file.size();
+
+    qint64 pos = CaptureFormat::FileHeaderSize;
+    qint64 lastIndexed = -CaptureFormat::IndexInterval;
+    CaptureRecord record;
+    quint32 length = 0;
+    while (readRecordHeader(pos, &record, &length)) {
+        const qint64 next = pos + CaptureFormat::RecordHeaderSize + length;
+        if (next > dataEnd) {
+            break;
+        }
+        if (pos - lastIndexed >= CaptureFormat::IndexInterval) {
+            const IndexEntry entry = {record.timestampNs, pos};
+            index.append(entry);
+            lastIndexed = pos;
+        }
+        ++records;
+        pos = next;
+    }
+    dataEnd = pos;
+    return true;
+}
+
+bool CaptureFileReader::readRecordHeader(qint64 offset, CaptureRecord *record, quint32 *length)
+{
+    char header[CaptureFormat::RecordHeaderSize];
+    if (offset + CaptureFormat::RecordHeaderSize > dataEnd || !file.seek(offset) ||
+        file.read(header, sizeof(header)) != qint64(sizeof(header))) {
+        return false;
+    }
+
+    *length = qFromLittleEndian<quint32>(header + 4);
+    if (*length > MAX_RECORD_LENGTH) {
+        return false;
+    }
+    record->direction = quint8(header[0]);
+    record->portId = quint8(header[1]);
+    record->timestampNs = qFromLittleEndian<qint64>(header + 8);
+    record->fileOffset = offset;
+    return true;
+}
+
+// ==================== CaptureTextFormatter ====================
+
+CaptureTextFormatter::CaptureTextFormatter()
+    : cachedSecond(-1)
+{
+}
+
+void CaptureTextFormatter::append(QByteArray &out, int direction, qint64 wallClockNs, const char *data, qsizetype len)
+{
+    const qint64 second = wallClockNs / 1000000000;
+    if (second != cachedSecond) {
+        cachedSecond = second;
+        cachedSecondText = QDateTime::fromSecsSinceEpoch(second).toString("yyyy-MM-dd hh:mm:ss").toLatin1();
+    }
+    out.append(cachedSecondText);
+
+    int micros = int((wallClockNs / 1000) % 1000000);
+    char fraction[8];
+    fraction[0] = '.';
+    for (int i = 6; i >= 1; --i) {
+        fraction[i] = char('0' + micros % 10);
+        micros /= 10;
+    }
+    fraction[7] = ' ';
+    out.append(fraction, 8);
+    out.append(direction == 0 ? "[RX]" : "[TX]");
+    if (len > 0) {
+        out.append(' ');
+        HexCodec::appendHex(out, data, len);
+    }
+    out.append('\n');
+}
+
+// ==================== CaptureConverter ====================
+
+static bool decodeHexPayload(const QByteArray &text, qsizetype from, QByteArray *payload)
+{
+    payload->resize((text.size() - from) / 2);
+    const qsizetype written = HexCodec::decode(text.constData() + from, text.size() - from, payload->data());
+    if (written < 0) {
+        return false;
+    }
+    payload->resize(written);
+    return true;
+}
+
+// 解析行首的 "yyyy-MM-dd hh:mm:ss[.小数]"，返回时间戳之后的位置，失败返回-1
+static qsizetype parseTimestamp(const QByteArray &line, qint64 *wallClockNs,
+                                QByteArray *cachedText, qint64 *cachedSecondNs)
+{
+    static const int DATE_TIME_LENGTH = 19;
+    if (line.size() < DATE_TIME_LENGTH || line.at(4) != '-' || line.at(13) != ':') {
+        return -1;
+    }
+
+    const QByteArray secondText = line.left(DATE_TIME_LENGTH);
+    if (secondText != *cachedText) {
+        const QDateTime time = QDateTime::fromString(QString::fromLatin1(secondText), "yyyy-MM-dd hh:mm:ss");
+        if (!time.isValid()) {
+            return -1;
+        }
+        *cachedText = secondText;
+        *cachedSecondNs = time.toMSecsSinceEpoch() * 1000000;
+    }
+
+    qsizetype pos = DATE_TIME_LENGTH;
+    qint64 fractionNs = 0;
+    if (pos < line.size() && line.at(pos) == '.') {
+        qint64 scale = 100000000;
+        for (++pos; pos < line.size() && line.at(pos) >= '0' && line.at(pos) <= '9'; ++pos) {
+            fractionNs += (line.at(pos) - '0') * scale;
+            scale /= 10;
+        }
+    }
+    *wallClockNs = *cachedSecondNs + fractionNs;
+    if (pos < line.size() && line.at(pos) == ' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+// 百分比变化时才回调，返回false表示取消
+static bool reportProgress(const CaptureConverter::ProgressCallback &progress, qint64 done, qint64 total, int *lastPercent)
+{
+    if (!progress || total <= 0) {
+        return true;
+    }
+    const int percent = int(qMin<qint64>(100, done * 100 / total));
+    if (percent == *lastPercent) {
+        return true;
+    }
+    *lastPercent = percent;
+    return progress(percent);
+}
+
+bool CaptureConverter::exportToText(const QString &capturePath, const QString &textPath, QString *errorString,
+                                    const ProgressCallback &progress)
+{
+    CaptureFileReader reader;
+    if (!reader.open(capturePath)) {
+        if (errorString) *errorString = reader.errorString();
+        return false;
+    }
+
+    QFile out(textPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (errorString) *errorString = out.errorString();
+        return false;
+    }
+
+    CaptureTextFormatter formatter;
+    CaptureRecord record;
+    QByteArray text;
+    const qint64 total = reader.recordCount();
+    qint64 done = 0;
+    int lastPercent = -1;
+    while (reader.readNext(&record)) {
+        formatter.append(text, record.direction, record.timestampNs + reader.wallOffsetNs(),
+                         record.payload.constData(), record.payload.size());
+        if (text.size() >= WRITE_BUFFER_SIZE) {
+            // 写入失败（磁盘已满等）时不留下截断的文件
+            if (out.write(text) != text.size()) {
+                if (errorString) *errorString = out.errorString();
+                out.remove();
+                return false;
+            }
+            text.resize(0);
+        }
+        if (!reportProgress(progress, ++done, total, &lastPercent)) {
+            if (errorString) *errorString = "已取消";
+            out.remove();
+            return false;
+        }
+    }
+    if (out.write(text) != text.size() || !out.flush()) {
+        if (errorString) *errorString = out.errorString();
+        out.remove();
+        return false;
+    }
+    return true;
+}
+
+bool CaptureConverter::importFromText(const QString &textPath, const QString &capturePath, QString *errorString,
+                                      const ProgressCallback &progress)
+{
+    QFile in(textPath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = in.errorString();
+        return false;
+    }
+
+    // 文本中只有墙上时间，导入后时间戳即为Unix纪元纳秒，偏移为0
+    CaptureFileWriter writer;
+    if (!writer.open(capturePath, 0)) {
+        if (errorString) *errorString = writer.errorString();
+        return false;
+    }
+
+    QByteArray cachedText;
+    qint64 cachedSecondNs = 0;
+    qint64 lastTimestamp = 0;
+    QByteArray payload;
+    qint64 lineNumber = 0;
+    const qint64 total = in.size();
+    int lastPercent = -1;
+
+    while (!in.atEnd()) {
+        if (!reportProgress(progress, in.pos(), total, &lastPercent)) {
+            if (errorString) *errorString = "已取消";
+            writer.close();
+            QFile::remove(capturePath);
+            return false;
+        }
+        QByteArray line = in.readLine();
+        ++lineNumber;
+        if (line.endsWith('\n')) line.chop(1);
+        if (line.endsWith('\r')) line.chop(1);
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        qint64 timestamp = lastTimestamp;
+        qsizetype pos = parseTimestamp(line, &timestamp, &cachedText, &cachedSecondNs);
+        if (pos < 0) {
+            pos = 0;   // 没有时间戳的行沿用上一条记录的时间
+        }
+        lastTimestamp = timestamp;
+
+        const QByteArray tag = line.mid(pos, 4);
+        if (tag == "[RX]" || tag == "[TX]") {
+            // 录制文本：十六进制负载
+            if (!decodeHexPayload(line, pos + 4, &payload)) {
+                if (errorString) *errorString = QString("第 %1 行十六进制数据无效").arg(lineNumber);
+                writer.close();
+                QFile::remove(capturePath);
+                return false;
+            }
+            writer.writeRecord(tag == "[RX]" ? 0 : 1, 0, timestamp, payload.constData(), payload.size());
+        } else {
+            // 保存的接收日志：整行文本作为接收数据
+            payload = line.mid(pos);
+            payload.append('\n');
+            writer.writeRecord(0, 0, timestamp, payload.constData(), payload.size());
+        }
+    }
+
+    if (!writer.close()) {
+        if (errorString) *errorString = writer.errorString();
+        QFile::remove(capturePath);
+        return false;
+    }
+    return true;
+}
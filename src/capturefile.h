@@ -0,0 +1,145 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// 二进制录制文件格式 (.fcap，所有整数均为小端)
+//
+//   文件头 32字节: magic "FSPCAP01" | version u16 | headerSize u16 | reserved u32 | wallOffsetNs i64 | reserved u64
+//   记录   16字节头 + 负载: direction u8 | portId u8 | reserved u16 | length u32 | timestampNs i64 | payload
+//   索引   每条 16字节: timestampNs i64 | fileOffset u64 （每隔约64KB记录一条）
+//   文件尾 32字节: indexOffset u64 | indexCount u64 | recordCount u64 | magic "FSPIDX01"
+//
+// timestampNs 为单调时钟纳秒，加上 wallOffsetNs 得到Unix纪元纳秒。
+// 文件尾缺失（录制中断）时读取端会顺序扫描重建索引。
+namespace CaptureFormat {
+    const char FileMagic[] = "FSPCAP01";
+    const char IndexMagic[] = "FSPIDX01";
+    const quint16 Version = 1;
+    const int FileHeaderSize = 32;
+    const int RecordHeaderSize = 16;
+    const int IndexEntrySize = 16;
+    const int TrailerSize = 32;
+    const qint64 IndexInterval = 64 * 1024;
+}
+
+// 单条录制记录
+struct CaptureRecord {
+    quint8 direction;    // 0 接收，1 发送
+    quint8 portId;
+    qint64 timestampNs;  // 单调时钟纳秒
+    QByteArray payload;
+    qint64 fileOffset;   // 记录在文件中的偏移
+
+    CaptureRecord() : direction(0), portId(0), timestampNs(0), fileOffset(-1) {}
+};
+
+// 二进制录制文件写入
+class CaptureFileWriter
+{
+public:
+    CaptureFileWriter();
+    ~CaptureFileWriter();
+
+    bool open(const QString &filePath, qint64 wallOffsetNs);
+    void writeRecord(quint8 direction, quint8 portId, qint64 timestampNs, const char *data, qsizetype len);
+    bool flush();   // 把缓冲的记录写入文件
+    bool close();   // 写入索引和文件尾
+
+    bool isOpen() const;
+    qint64 size() const;
+    qint64 recordCount() const;
+    QFile *device();
+    QString errorString() const;
+
+private:
+    struct IndexEntry {
+        qint64 timestampNs;
+        qint64 offset;
+    };
+
+    QFile file;
+    QByteArray buffer;   // 待写入的数据，攒满后一次写入
+    QVector<IndexEntry> index;
+    qint64 offset;       // 下一条记录的文件偏移
+    qint64 lastIndexedOffset;
+    qint64 records;
+    QString lastError;
+
+    void flushBuffer();
+};
+
+// 二进制录制文件读取：打开时只读文件头和索引，按时间定位为索引上的二分查找
+class CaptureFileReader
+{
+public:
+    CaptureFileReader();
+
+    bool open(const QString &filePath);
+    void close();
+
+    static bool isCaptureFile(const QString &filePath);
+
+    qint64 wallOffsetNs() const;
+    qint64 recordCount() const;
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    QString errorString() const;
+
+    // 定位到时间戳不早于timestampNs的第一条记录
+    bool seekToTime(qint64 timestampNs);
+    bool seekToStart();
+
+    // 顺序读取下一条记录，到达末尾返回false
+    bool readNext(CaptureRecord *record);
+
+private:
+    struct IndexEntry {
+        qint64 timestampNs;
+        qint64 offset;
+    };
+
+    QFile file;
+    QVector<IndexEntry> index;
+    qint64 wallOffset;
+    qint64 dataEnd;       // 记录区结束位置（索引开始处）
+    qint64 readPos;
+    qint64 records;
+    qint64 lastTime;
+    QString lastError;
+
+    bool readIndex();
+    bool rebuildIndex();
+    bool readRecordHeader(qint64 offset, CaptureRecord *record, quint32 *length);
+};
+
+// 文本格式：yyyy-MM-dd hh:mm:ss.uuuuuu [RX|TX] 十六进制负载
+class CaptureTextFormatter
+{
+public:
+    CaptureTextFormatter();
+    void append(QByteArray &out, int direction, qint64 wallClockNs, const char *data, qsizetype len);
+
+private:
+    qint64 cachedSecond;   // 缓存最近一次格式化的秒，避免每条记录都格式化日期
+    QByteArray cachedSecondText;
+};
+
+// 二进制与文本格式互转
+// 耗时与文件大小成正比，界面应在工作线程中调用
+namespace CaptureConverter {
+    // 进度（0~100）变化时在转换线程中回调，返回false取消转换。
+    // 取消或失败（数据无效、写入失败）时删除未写完的输出文件
+    using ProgressCallback = std::function<bool(int percent)>;
+
+    bool exportToText(const QString &capturePath, const QString &textPath, QString *errorString,
+                      const ProgressCallback &progress = ProgressCallback());
+    bool importFromText(const QString &textPath, const QString &capturePath, QString *errorString,
+                        const ProgressCallback &progress = ProgressCallback());
+}
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,436 @@
+#include "captureview.h"
+#include "hexcodec.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QApplication>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+
+// 文本左侧留白
+static const int TEXT_MARGIN = 4;
+
+// 单行最多解码的负载字节数，超长记录截断显示
+static const qint64 MAX_ROW_BYTES = 512;
+
+// 索引线程每攒够这么多个索引点发布一次
+static const int PUBLISH_BATCH = 4096;
+
+CaptureView::CaptureView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , mapped(nullptr)
+    , mappedSize(0)
+    , binary(false)
+    , dataBegin(0)
+    , dataEnd(0)
+    , wallOffset(0)
+    , indexedRows(0)
+    , scannedBytes(0)
+    , cancelIndexing(false)
+    , indexThread(nullptr)
+    , indexGeneration(0)
+    , mode(HexMode)
+    , currentRow(-1)
+    , maxRowWidth(0)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(100);
+    connect(progressTimer, &QTimer::timeout, this, &CaptureView::onProgressTimer);
+    updateScrollBars();
+}
+
+CaptureView::~CaptureView()
+{
+    closeFile();
+}
+
+bool CaptureView::openFile(const QString &filePath)
+{
+    closeFile();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        lastError = file.errorString();
+        return false;
+    }
+
+    mappedSize = file.size();
+    if (mappedSize > 0) {
+        mapped = file.map(0, mappedSize);
+        if (!mapped) {
+            lastError = QString("无法映射文件：%1").arg(file.errorString());
+            file.close();
+            mappedSize = 0;
+            return false;
+        }
+    }
+
+    // 识别格式：.fcap 文件头魔数，否则按文本逐行处理
+    binary = mappedSize >= CaptureFormat::FileHeaderSize &&
+             std::memcmp(mapped, CaptureFormat::FileMagic, 8) == 0;
+    if (binary) {
+        wallOffset = qFromLittleEndian<qint64>(mapped + 16);
+        dataBegin = CaptureFormat::FileHeaderSize;
+        dataEnd = mappedSize;
+        // 有完整文件尾时记录区在索引之前结束
+        if (mappedSize >= CaptureFormat::FileHeaderSize + CaptureFormat::TrailerSize) {
+            const uchar *trailer = mapped + mappedSize - CaptureFormat::TrailerSize;
+            const quint64 indexOffset = qFromLittleEndian<quint64>(trailer);
+            if (std::memcmp(trailer + 24, CaptureFormat::IndexMagic, 8) == 0 &&
+                indexOffset >= quint64(dataBegin) && indexOffset <= quint64(mappedSize)) {
+                dataEnd = qint64(indexOffset);
+            }
+        }
+    } else {
+        wallOffset = 0;
+        dataBegin = (mappedSize >= 3 && std::memcmp(mapped, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+        dataEnd = mappedSize;
+    }
+
+    cancelIndexing = false;
+    indexThread = QThread::create([this]() { buildIndex(); });
+    const quint64 generation = indexGeneration;
+    connect(indexThread, &QThread::finished, this, [this, generation]() {
+        if (generation != indexGeneration) {
+            return;
+        }
+        progressTimer->stop();
+        onProgressTimer();
+        emit indexFinished(indexedRows);
+    });
+    progressTimer->start();
+    indexThread->start(QThread::LowPriority);
+    return true;
+}
+
+void CaptureView::closeFile()
+{
+    ++indexGeneration;
+    if (indexThread) {
+        cancelIndexing = true;
+        indexThread->wait();
+        delete indexThread;
+        indexThread = nullptr;
+    }
+    progressTimer->stop();
+
+    if (mapped) {
+        file.unmap(const_cast<uchar *>(mapped));
+        mapped = nullptr;
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+
+    {
+        QMutexLocker locker(&indexMutex);
+        checkpoints.clear();
+        checkpoints.squeeze();
+    }
+    mappedSize = 0;
+    dataBegin = 0;
+    dataEnd = 0;
+    indexedRows = 0;
+    scannedBytes = 0;
+    currentRow = -1;
+    maxRowWidth = 0;
+    updateScrollBars();
+    viewport()->update();
+}
+
+QString CaptureView::errorString() const
+{
+    return lastError;
+}
+
+bool CaptureView::isBinaryCapture() const
+{
+    return binary;
+}
+
+bool CaptureView::isIndexing() const
+{
+    return indexThread && indexThread->isRunning();
+}
+
+qint64 CaptureView::rowCount() const
+{
+    return indexedRows;
+}
+
+void CaptureView::setDisplayMode(DisplayMode displayMode)
+{
+    if (mode == displayMode) {
+        return;
+    }
+    mode = displayMode;
+    maxRowWidth = 0;
+    updateScrollBars();
+    viewport()->update();
+}
+
+CaptureView::DisplayMode CaptureView::displayMode() const
+{
+    return mode;
+}
+
+void CaptureView::copyCurrentRow()
+{
+    if (currentRow < 0 || currentRow >= indexedRows) {
+        return;
+    }
+    QApplication::clipboard()->setText(rowText(rowOffset(currentRow)));
+}
+
+void CaptureView::buildIndex()
+{
+    // 只顺序访问映射内存，不做任何拷贝
+    QVector<qint64> batch;
+    batch.reserve(PUBLISH_BATCH);
+    qint64 pos = dataBegin;
+    qint64 rows = 0;
+
+    while (pos < dataEnd && !cancelIndexing) {
+        const qint64 next = nextRowOffset(pos);
+        if (next <= pos) {
+            break;   // 不完整的尾部记录
+        }
+        if (rows % CHECKPOINT_STRIDE == 0) {
+            batch.append(pos);
+        }
+        ++rows;
+        pos = next;
+
+        if (batch.size() >= PUBLISH_BATCH) {
+            {
+                QMutexLocker locker(&indexMutex);
+                checkpoints += batch;
+            }
+            batch.resize(0);
+            indexedRows = rows;
+            scannedBytes = pos;
+        }
+    }
+
+    {
+        QMutexLocker locker(&indexMutex);
+        checkpoints += batch;
+    }
+    indexedRows = rows;
+    scannedBytes = dataEnd;
+}
+
+qint64 CaptureView::nextRowOffset(qint64 offset) const
+{
+    if (binary) {
+        if (offset + CaptureFormat::RecordHeaderSize > dataEnd) {
+            return -1;
+        }
+        const quint32 length = qFromLittleEndian<quint32>(mapped + offset + 4);
+        const qint64 next = offset + CaptureFormat::RecordHeaderSize + length;
+        return next <= dataEnd ? next : -1;
+    }
+
+    const void *newline = std::memchr(mapped + offset, '\n', size_t(dataEnd - offset));
+    return newline ? qint64(static_cast<const uchar *>(newline) - mapped) + 1 : dataEnd;
+}
+
+qint64 CaptureView::rowOffset(qint64 row) const
+{
+    qint64 offset;
+    {
+        QMutexLocker locker(&indexMutex);
+        const qint64 checkpoint = row / CHECKPOINT_STRIDE;
+        if (checkpoint >= checkpoints.size()) {
+            return -1;
+        }
+        offset = checkpoints.at(checkpoint);
+    }
+    for (qint64 i = row % CHECKPOINT_STRIDE; i > 0 && offset >= 0; --i) {
+        offset = nextRowOffset(offset);
+    }
+    return offset;
+}
+
+QString CaptureView::rowText(qint64 offset) const
+{
+    if (offset < 0 || offset >= dataEnd) {
+        return QString();
+    }
+
+    const char *data = reinterpret_cast<const char *>(mapped + offset);
+    QByteArray text;
+
+    if (binary) {
+        const quint8 direction = quint8(data[0]);
+        const quint32 length = qFromLittleEndian<quint32>(data + 4);
+        const qint64 timestamp = qFromLittleEndian<qint64>(data + 8) + wallOffset;
+        const char *payload = data + CaptureFormat::RecordHeaderSize;
+        const qsizetype shown = qsizetype(qMin<qint64>(length, MAX_ROW_BYTES));
+
+        if (mode == HexMode) {
+            formatter.append(text, direction, timestamp, payload, shown);
+            text.chop(1);
+        } else {
+            formatter.append(text, direction, timestamp, payload, 0);
+            text.chop(1);
+            text.append(' ');
+            QString result = QString::fromLatin1(text) + QString::fromUtf8(payload, shown);
+            for (QChar &ch : result) {
+                if (ch.unicode() < 0x20) {
+                    ch = QLatin1Char('.');
+                }
+            }
+            if (qint64(length) > shown) {
+                result += QString(" …(共%1字节)").arg(length);
+            }
+            return result;
+        }
+        if (qint64(length) > shown) {
+            text.append(QString(" …(共%1字节)").arg(length).toUtf8());
+        }
+        return QString::fromUtf8(text);
+    }
+
+    qint64 end = nextRowOffset(offset);
+    qint64 length = end - offset;
+    while (length > 0 && (data[length - 1] == '\n' || data[length - 1] == '\r')) {
+        --length;
+    }
+
+    if (mode == HexMode) {
+        const qint64 shown = qMin(length, MAX_ROW_BYTES);
+        HexCodec::appendHex(text, data, qsizetype(shown));
+        if (length > shown) {
+            text.append(QString(" …(共%1字节)").arg(length).toUtf8());
+        }
+        return QString::fromUtf8(text);
+    }
+
+    return QString::fromUtf8(data, qsizetype(qMin<qint64>(length, MAX_ROW_BYTES * 8)));
+}
+
+void CaptureView::onProgressTimer()
+{
+    const qint64 total = qMax<qint64>(1, dataEnd - dataBegin);
+    const int percent = int(qBound<qint64>(0, (scannedBytes - dataBegin) * 100 / total, 100));
+    updateScrollBars();
+    viewport()->update();
+    emit indexProgress(percent, indexedRows);
+}
+
+void CaptureView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().base());
+    if (!mapped) {
+        return;
+    }
+
+    const QFontMetrics metrics = fontMetrics();
+    const int height = rowHeight();
+    const qint64 firstRow = verticalScrollBar()->value();
+    const qint64 rows = indexedRows;
+    const int x = TEXT_MARGIN - horizontalScrollBar()->value();
+
+    // 只定位一次首个可见行，之后顺序向后走
+    qint64 offset = rowOffset(firstRow);
+    int widest = maxRowWidth;
+    const int count = visibleRowCount() + 1;
+    for (int i = 0; i < count && firstRow + i < rows && offset >= 0; ++i) {
+        const QString text = rowText(offset);
+        const int y = i * height;
+
+        if (firstRow + i == currentRow) {
+            painter.fillRect(0, y, viewport()->width(), height, palette().highlight());
+            painter.setPen(palette().highlightedText().color());
+        } else {
+            painter.setPen(palette().text().color());
+        }
+        painter.drawText(x, y + metrics.ascent(), text);
+        widest = qMax(widest, metrics.horizontalAdvance(text));
+        offset = nextRowOffset(offset);
+    }
+
+    if (widest != maxRowWidth) {
+        maxRowWidth = widest;
+        QMetaObject::invokeMethod(this, [this]() { updateScrollBars(); }, Qt::QueuedConnection);
+    }
+}
+
+void CaptureView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void CaptureView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && indexedRows > 0) {
+        const qint64 row = verticalScrollBar()->value() + event->position().toPoint().y() / rowHeight();
+        currentRow = qBound<qint64>(0, row, indexedRows - 1);
+        viewport()->update();
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void CaptureView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copyCurrentRow();
+        return;
+    }
+    if (event->key() == Qt::Key_Home && (event->modifiers() & Qt::ControlModifier)) {
+        verticalScrollBar()->setValue(0);
+        return;
+    }
+    if (event->key() == Qt::Key_End && (event->modifiers() & Qt::ControlModifier)) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void CaptureView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        maxRowWidth = 0;
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+int CaptureView::rowHeight() const
+{
+    return qMax(1, fontMetrics().lineSpacing());
+}
+
+int CaptureView::visibleRowCount() const
+{
+    return qMax(1, viewport()->height() / rowHeight());
+}
+
+void CaptureView::updateScrollBars()
+{
+    const int visible = visibleRowCount();
+    const qint64 maximum = qMax<qint64>(0, indexedRows - visible);
+    verticalScrollBar()->setSingleStep(1);
+    verticalScrollBar()->setPageStep(visible);
+    verticalScrollBar()->setRange(0, int(qMin<qint64>(maximum, INT_MAX)));
+
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth() * 4);
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, maxRowWidth + 2 * TEXT_MARGIN - viewport()->width()));
+}
@@ -0,0 +1,93 @@
+#ifndef CAPTUREVIEW_H
+#define CAPTUREVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include "capturefile.h"
+
+// 只读录制文件查看器
+// 文件整体内存映射，后台线程扫描出行（文本文件）或记录（.fcap）的稀疏偏移索引，
+// 每64行只记一个偏移；绘制时从最近的索引点向后走不超过63行即可定位，
+// 只解码可见范围。常驻内存只有索引和被访问过的映射页，与文件大小无关。
+class CaptureView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    enum DisplayMode {
+        HexMode,    // 负载显示为十六进制
+        TextMode    // 负载显示为文本
+    };
+
+    explicit CaptureView(QWidget *parent = nullptr);
+    ~CaptureView();
+
+    bool openFile(const QString &filePath);
+    void closeFile();
+    QString errorString() const;
+
+    bool isBinaryCapture() const;
+    bool isIndexing() const;
+    qint64 rowCount() const;     // 已建立索引的行数，索引完成前持续增长
+
+    void setDisplayMode(DisplayMode mode);
+    DisplayMode displayMode() const;
+
+public slots:
+    void copyCurrentRow();
+
+signals:
+    void indexProgress(int percent, qint64 rows);
+    void indexFinished(qint64 rows);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    static const int CHECKPOINT_STRIDE = 64;
+
+    QFile file;
+    const uchar *mapped;
+    qint64 mappedSize;
+    bool binary;
+    qint64 dataBegin;
+    qint64 dataEnd;
+    qint64 wallOffset;
+    QString lastError;
+
+    // 后台索引线程写入，GUI线程读取
+    mutable QMutex indexMutex;
+    QVector<qint64> checkpoints;           // 第 i*CHECKPOINT_STRIDE 行的文件偏移
+    std::atomic<qint64> indexedRows;
+    std::atomic<qint64> scannedBytes;
+    std::atomic<bool> cancelIndexing;
+    QThread *indexThread;
+    quint64 indexGeneration;               // 每次关闭文件加1，丢弃上一个文件排队中的完成通知
+    QTimer *progressTimer;                 // 索引期间定时刷新滚动范围和进度
+
+    DisplayMode mode;
+    qint64 currentRow;
+    int maxRowWidth;
+    mutable CaptureTextFormatter formatter;
+
+    void buildIndex();
+    qint64 nextRowOffset(qint64 offset) const;
+    qint64 rowOffset(qint64 row) const;
+    QString rowText(qint64 offset) const;
+    void onProgressTimer();
+
+    int rowHeight() const;
+    int visibleRowCount() const;
+    void updateScrollBars();
+};
+
+#endif // CAPTUREVIEW_H
@@ -0,0 +1,345 @@
+#include "capturewriter.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 内存中每条记录的头部：方向(1) + 时间戳纳秒(8) + 长度(4)
+static const qsizetype RECORD_HEADER_SIZE = 1 + 8 + 4;
+
+// 写盘长期跟不上时前台块允许积压的上限，超出后丢弃并计数
+static const qsizetype MAX_BACKLOG = 64 * 1024 * 1024;
+
+static qint64 wallClockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 记录使用单调时钟，不受系统校时影响；墙上时间由开始录制时的偏移换算
+static qint64 monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CaptureWriter::CaptureWriter(QObject *parent)
+    : QObject(parent)
+    , writerThread(nullptr)
+    , recording(false)
+    , stopRequested(false)
+    , fileBytes(0)
+    , writeErrorReported(false)
+    , lastFsyncMs(0)
+    , wallOffsetNs(0)
+    , writtenBytes(0)
+    , lostBytes(0)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    stop();
+}
+
+bool CaptureWriter::start(const CaptureOptions &options)
+{
+    stop();
+
+    if (!QDir().mkpath(options.directory)) {
+        setError(QString("无法创建录制目录：%1").arg(options.directory));
+        return false;
+    }
+
+    captureOptions = options;
+    captureOptions.blockSize = qMax<qsizetype>(captureOptions.blockSize, 4096);
+    frontBlock.clear();
+    frontBlock.reserve(captureOptions.blockSize + RECORD_HEADER_SIZE);
+    backBlock.clear();
+    backBlock.reserve(captureOptions.blockSize + RECORD_HEADER_SIZE);
+    writtenBytes = 0;
+    lostBytes = 0;
+    wallOffsetNs = wallClockNs() - monotonicNs();
+
+    if (!openNextFile()) {
+        return false;
+    }
+
+    stopRequested = false;
+    recording = true;
+    writerThread = QThread::create([this]() { writerLoop(); });
+    writerThread->start();
+    return true;
+}
+
+void CaptureWriter::stop()
+{
+    if (!writerThread) {
+        return;
+    }
+
+    recording = false;
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        dataReady.wakeOne();
+    }
+    writerThread->wait();
+    delete writerThread;
+    writerThread = nullptr;
+    closeFile();
+}
+
+bool CaptureWriter::isRecording() const
+{
+    return recording;
+}
+
+void CaptureWriter::append(Direction direction, const char *data, qsizetype len)
+{
+    if (!recording || len <= 0) {
+        return;
+    }
+
+    const qint64 timestamp = monotonicNs();
+    const quint8 dir = quint8(direction);
+    const quint32 length = quint32(len);
+
+    QMutexLocker locker(&mutex);
+    // 上面的检查不加锁，stop() 可能在这之间完成；写线程退出后追加的数据不会再写盘
+    if (stopRequested) {
+        return;
+    }
+    if (frontBlock.size() + RECORD_HEADER_SIZE + len > MAX_BACKLOG) {
+        lostBytes += quint64(len);
+        return;
+    }
+
+    // 生产者只做一次内存拷贝，格式化工作留给写线程
+    const qsizetype offset = frontBlock.size();
+    frontBlock.resize(offset + RECORD_HEADER_SIZE + len);
+    char *out = frontBlock.data() + offset;
+    std::memcpy(out, &dir, 1);
+    std::memcpy(out + 1, &timestamp, 8);
+    std::memcpy(out + 9, &length, 4);
+    std::memcpy(out + RECORD_HEADER_SIZE, data, size_t(len));
+
+    if (frontBlock.size() >= captureOptions.blockSize) {
+        dataReady.wakeOne();
+    }
+}
+
+QString CaptureWriter::currentFilePath() const
+{
+    QMutexLocker locker(&mutex);
+    return filePath;
+}
+
+QString CaptureWriter::errorString() const
+{
+    QMutexLocker locker(&mutex);
+    return lastError;
+}
+
+quint64 CaptureWriter::recordedBytes() const
+{
+    return writtenBytes;
+}
+
+quint64 CaptureWriter::droppedBytes() const
+{
+    return lostBytes;
+}
+
+void CaptureWriter::writerLoop()
+{
+    QMutexLocker locker(&mutex);
+    for (;;) {
+        if (!stopRequested && frontBlock.size() < captureOptions.blockSize) {
+            dataReady.wait(&mutex, captureOptions.flushIntervalMs);
+        }
+
+        // 交换前后台块，写盘期间生产者继续向新的前台块追加
+        frontBlock.swap(backBlock);
+        const bool finished = stopRequested;
+        locker.unlock();
+
+        if (!backBlock.isEmpty()) {
+            writeBlock(backBlock);
+            backBlock.resize(0);
+        }
+
+        if (captureOptions.fsyncPolicy == CaptureOptions::FsyncInterval &&
+            QDateTime::currentMSecsSinceEpoch() - lastFsyncMs >= captureOptions.fsyncIntervalMs) {
+            syncFile();
+        }
+
+        locker.relock();
+        if (finished && frontBlock.isEmpty()) {
+            break;
+        }
+    }
+}
+
+bool CaptureWriter::openNextFile()
+{
+    closeFile();
+
+    const bool binary = captureOptions.format == CaptureOptions::FormatBinary;
+    const QString suffix = binary ? "fcap" : "txt";
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+    QString path = QDir(captureOptions.directory).filePath(
+        QString("%1_%2.%3").arg(captureOptions.baseName, stamp, suffix));
+    for (int i = 1; QFileInfo::exists(path); ++i) {
+        path = QDir(captureOptions.directory).filePath(
+            QString("%1_%2_%3.%4").arg(captureOptions.baseName, stamp).arg(i).arg(suffix));
+    }
+
+    if (binary) {
+        if (!binaryFile.open(path, wallOffsetNs)) {
+            setError(QString("无法创建录制文件：%1\n%2").arg(path, binaryFile.errorString()));
+            return false;
+        }
+    } else {
+        file.setFileName(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            setError(QString("无法创建录制文件：%1\n%2").arg(path, file.errorString()));
+            return false;
+        }
+    }
+
+    fileBytes = 0;
+    writeErrorReported = false;
+    fileOpenedAt = QDateTime::currentDateTime();
+    lastFsyncMs = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker locker(&mutex);
+        filePath = path;
+    }
+    emit fileRotated(path);
+    return true;
+}
+
+void CaptureWriter::closeFile()
+{
+    if (binaryFile.isOpen()) {
+        if (captureOptions.fsyncPolicy != CaptureOptions::FsyncNone) {
+            syncFile();
+        }
+        if (!binaryFile.close()) {
+            reportWriteError(binaryFile.errorString());
+        }
+    }
+    if (file.isOpen()) {
+        file.flush();
+        if (captureOptions.fsyncPolicy != CaptureOptions::FsyncNone) {
+            syncFile();
+        }
+        file.close();
+    }
+}
+
+void CaptureWriter::writeBlock(const QByteArray &block)
+{
+    const char *data = block.constData();
+    const qsizetype size = block.size();
+    const bool binary = captureOptions.format == CaptureOptions::FormatBinary;
+
+    encodeBuffer.resize(0);
+    qsizetype pos = 0;
+    while (pos + RECORD_HEADER_SIZE <= size) {
+        quint8 dir;
+        qint64 timestamp;
+        quint32 length;
+        std::memcpy(&dir, data + pos, 1);
+        std::memcpy(&timestamp, data + pos + 1, 8);
+        std::memcpy(&length, data + pos + 9, 4);
+        pos += RECORD_HEADER_SIZE;
+
+        if (binary) {
+            binaryFile.writeRecord(dir, captureOptions.portId, timestamp, data + pos, length);
+        } else {
+            textFormatter.append(encodeBuffer, dir, timestamp + wallOffsetNs, data + pos, length);
+        }
+        pos += length;
+        writtenBytes += length;
+    }
+
+    if (binary) {
+        if (!binaryFile.isOpen()) {
+            return;
+        }
+        if (!binaryFile.errorString().isEmpty()) {
+            // 二进制写入器的错误一直保留到文件关闭
+            reportWriteError(binaryFile.errorString());
+            return;
+        }
+        fileBytes = binaryFile.size();
+    } else {
+        if (!file.isOpen()) {
+            return;
+        }
+        if (file.write(encodeBuffer) != encodeBuffer.size()) {
+            reportWriteError(file.errorString());
+            return;
+        }
+        fileBytes += encodeBuffer.size();
+    }
+
+    if (captureOptions.fsyncPolicy == CaptureOptions::FsyncPerBlock) {
+        syncFile();
+    }
+
+    // 按大小或时间切换文件
+    const bool sizeExceeded = captureOptions.rotateBytes > 0 && fileBytes >= captureOptions.rotateBytes;
+    const bool timeExceeded = captureOptions.rotateSeconds > 0 &&
+                              fileOpenedAt.secsTo(QDateTime::currentDateTime()) >= captureOptions.rotateSeconds;
+    if (sizeExceeded || timeExceeded) {
+        openNextFile();
+    }
+}
+
+void CaptureWriter::syncFile()
+{
+    QFile *target = &file;
+    if (binaryFile.isOpen()) {
+        binaryFile.flush();
+        target = binaryFile.device();
+    }
+    if (!target->isOpen()) {
+        return;
+    }
+    target->flush();
+#ifdef Q_OS_WIN
+    _commit(target->handle());
+#else
+    ::fsync(target->handle());
+#endif
+    lastFsyncMs = QDateTime::currentMSecsSinceEpoch();
+}
+
+void CaptureWriter::reportWriteError(const QString &errorString)
+{
+    if (writeErrorReported) {
+        return;
+    }
+    writeErrorReported = true;
+    setError(QString("录制文件写入失败：%1").arg(errorString));
+}
+
+void CaptureWriter::setError(const QString &errorString)
+{
+    {
+        QMutexLocker locker(&mutex);
+        lastError = errorString;
+    }
+    emit errorOccurred(errorString);
+}
@@ -0,0 +1,122 @@
+#ifndef CAPTUREWRITER_H
+#define CAPTUREWRITER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QDateTime>
+#include <atomic>
+#include "capturefile.h"
+
+// 录制选项
+struct CaptureOptions {
+    enum FsyncPolicy {
+        FsyncNone,      // 只写入系统缓存，由操作系统决定何时落盘
+        FsyncPerBlock,  // 每写完一个数据块执行一次fsync
+        FsyncInterval   // 按固定时间间隔执行fsync
+    };
+
+    enum Format {
+        FormatText,     // 每条记录一行：时间 [RX|TX] 十六进制
+        FormatBinary    // 紧凑二进制格式(.fcap)，见 capturefile.h
+    };
+
+    QString directory;       // 录制文件目录
+    QString baseName;        // 文件名前缀
+    Format format;
+    quint8 portId;           // 写入二进制记录的端口号
+    qint64 rotateBytes;      // 单个文件超过该大小后切换新文件，0为不切换
+    int rotateSeconds;       // 单个文件录制超过该时长后切换新文件，0为不切换
+    FsyncPolicy fsyncPolicy;
+    int fsyncIntervalMs;
+    qsizetype blockSize;     // 双缓冲块大小，达到该大小即唤醒写线程
+    int flushIntervalMs;     // 数据不足一块时的最长滞留时间
+
+    CaptureOptions() {
+        baseName = "capture";
+        format = FormatBinary;
+        portId = 0;
+        rotateBytes = 256LL * 1024 * 1024;
+        rotateSeconds = 0;
+        fsyncPolicy = FsyncInterval;
+        fsyncIntervalMs = 1000;
+        blockSize = 1024 * 1024;
+        flushIntervalMs = 200;
+    }
+};
+
+// 流式录制引擎
+// 收发的每个字节连同单调时钟时间戳先追加到内存前台块（任意线程调用，只做一次内存拷贝），
+// 后台写线程与前台块交换后把后台块编码写入磁盘，实现双缓冲；
+// 文件按大小或时间切换，落盘策略可配置。写线程与GUI无关，界面繁忙不影响录制。
+class CaptureWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Direction {
+        Receive = 0,
+        Send = 1
+    };
+
+    explicit CaptureWriter(QObject *parent = nullptr);
+    ~CaptureWriter();
+
+    bool start(const CaptureOptions &options);
+    void stop();
+    bool isRecording() const;
+
+    // 追加一段收发数据（线程安全）
+    void append(Direction direction, const char *data, qsizetype len);
+
+    QString currentFilePath() const;
+    QString errorString() const;
+    quint64 recordedBytes() const;   // 已写入磁盘的负载字节数
+    quint64 droppedBytes() const;    // 写盘长期跟不上、内存积压超限后丢弃的字节数
+
+signals:
+    void fileRotated(const QString &filePath);
+    void errorOccurred(const QString &errorString);
+
+private:
+    CaptureOptions captureOptions;
+    QThread *writerThread;
+    std::atomic<bool> recording;
+
+    mutable QMutex mutex;           // 保护前台块、运行标志和状态字符串
+    QWaitCondition dataReady;
+    QByteArray frontBlock;          // 生产者追加的记录
+    QByteArray backBlock;           // 写线程正在编码的记录
+    bool stopRequested;
+    QString filePath;
+    QString lastError;
+
+    // 以下仅在写线程中访问
+    QFile file;                     // 文本格式
+    CaptureFileWriter binaryFile;   // 二进制格式
+    qint64 fileBytes;
+    bool writeErrorReported;        // 当前文件的写入错误已通知过，错误持续时不再逐块重复通知
+    QDateTime fileOpenedAt;
+    qint64 lastFsyncMs;
+    QByteArray encodeBuffer;
+    CaptureTextFormatter textFormatter;
+
+    qint64 wallOffsetNs;            // 墙上时间 - 单调时钟，开始录制时确定
+
+    std::atomic<quint64> writtenBytes;
+    std::atomic<quint64> lostBytes;
+
+    void writerLoop();
+    bool openNextFile();
+    void closeFile();
+    void writeBlock(const QByteArray &block);
+    void syncFile();
+    void setError(const QString &errorString);
+    void reportWriteError(const QString &errorString);
+};
+
+#endif // CAPTUREWRITER_H
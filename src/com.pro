@@ -19,7 +19,29 @@ SOURCES += \
     configmanager.cpp \
     serialportmanager.cpp \
     logmanager.cpp \
-    buttondatabase.cpp
+    buttondatabase.cpp \
+    ringbuffer.cpp \
+    rendercoalescer.cpp \
+    logstore.cpp \
+    logview.cpp \
+    capturewriter.cpp \
+    capturefile.cpp \
+    captureview.cpp \
+    hexcodec.cpp \
+    sendpayload.cpp \
+    sendscheduler.cpp \
+    sessionmanager.cpp \
+    multiportwindow.cpp \
+    virtualport.cpp \
+    perfmetrics.cpp \
+    perfpanel.cpp \
+    frameassembler.cpp \
+    nativeserialport.cpp \
+    buttongrid.cpp \
+    buttonmodel.cpp \
+    configfile.cpp \
+    deadlinesleeper.cpp \
+    macroengine.cpp
 
 # 头文件
 HEADERS += \
@@ -27,7 +49,32 @@ HEADERS += \
     configmanager.h \
     serialportmanager.h \
     logmanager.h \
-    buttondatabase.h
+    buttondatabase.h \
+    ringbuffer.h \
+    rendercoalescer.h \
+    logstore.h \
+    logview.h \
+    capturewriter.h \
+    capturefile.h \
+    captureview.h \
+    hexcodec.h \
+    sendpayload.h \
+    sendscheduler.h \
+    sessionmanager.h \
+    multiportwindow.h \
+    virtualport.h \
+    perfmetrics.h \
+    perfpanel.h \
+    frameassembler.h \
+    nativeserialport.h \
+    buttongrid.h \
+    buttonmodel.h \
+    configfile.h \
+    deadlinesleeper.h \
+    macroengine.h
+
+# 虚拟串口使用 openpty()
+unix:!macx: LIBS += -lutil
 
 # UI文件
 FORMS += \
@@ -0,0 +1,619 @@
+#include "configfile.h"
+#include <QDataStream>
+#include <QHash>
+#include <QStringList>
+#include <QTextStream>
+#include <climits>
+
+// 串口配置字段表：YAML 读写和缓存读写共用，新增配置项只需在这里加一行
+struct SerialField {
+    const char *name;
+    QString SerialPortConfig::*text;
+    int SerialPortConfig::*number;
+    bool SerialPortConfig::*flag;
+    int minimum;    // 读取时数值限制在 [minimum, maximum]
+    int maximum;
+
+    SerialField(const char *name, QString SerialPortConfig::*text)
+        : name(name), text(text), number(nullptr), flag(nullptr), minimum(INT_MIN), maximum(INT_MAX) {}
+    SerialField(const char *name, int SerialPortConfig::*number, int minimum = INT_MIN, int maximum = INT_MAX)
+        : name(name), text(nullptr), number(number), flag(nullptr), minimum(minimum), maximum(maximum) {}
+    SerialField(const char *name, bool SerialPortConfig::*flag)
+        : name(name), text(nullptr), number(nullptr), flag(flag), minimum(INT_MIN), maximum(INT_MAX) {}
+};
+
+static const SerialField SERIAL_FIELDS[] = {
+    {"portName", &SerialPortConfig::portName},
+    {"baudRate", &SerialPortConfig::baudRate},
+    {"dataBits", &SerialPortConfig::dataBits},
+    {"stopBits", &SerialPortConfig::stopBits},
+    {"parity", &SerialPortConfig::parity},
+    {"flowControl", &SerialPortConfig::flowControl},
+    {"timestampDisplay", &SerialPortConfig::timestampDisplay},
+    {"timestampMode", &SerialPortConfig::timestampMode},
+    {"hexDisplay", &SerialPortConfig::hexDisplay},
+    {"hexSend", &SerialPortConfig::hexSend},
+    {"autoSendEnter", &SerialPortConfig::autoSendEnter},
+    {"enterChars", &SerialPortConfig::enterChars},
+    {"encoding", &SerialPortConfig::encoding},
+    {"renderFps", &SerialPortConfig::renderFps, 1, 1000},
+    {"logMaxLines", &SerialPortConfig::logMaxLines, 0},
+    {"logMaxMegabytes", &SerialPortConfig::logMaxMegabytes, 0},
+    {"captureDirectory", &SerialPortConfig::captureDirectory},
+    {"captureRotateMegabytes", &SerialPortConfig::captureRotateMegabytes, 0},
+    {"captureRotateMinutes", &SerialPortConfig::captureRotateMinutes, 0},
+    {"captureFsync", &SerialPortConfig::captureFsync},
+    {"captureFormat", &SerialPortConfig::captureFormat},
+    {"sendQueueKilobytes", &SerialPortConfig::sendQueueKilobytes, 1},
+    {"sendQueuePolicy", &SerialPortConfig::sendQueuePolicy},
+    {"metricsDumpSeconds", &SerialPortConfig::metricsDumpSeconds, 0},
+    {"frameMode", &SerialPortConfig::frameMode},
+    {"frameDelimiter", &SerialPortConfig::frameDelimiter},
+    {"frameLength", &SerialPortConfig::frameLength, 1},
+    {"frameLengthOffset", &SerialPortConfig::frameLengthOffset, 0},
+    {"frameLengthBytes", &SerialPortConfig::frameLengthBytes},
+    {"frameLengthBigEndian", &SerialPortConfig::frameLengthBigEndian},
+    {"frameLengthAdjust", &SerialPortConfig::frameLengthAdjust},
+    {"frameIdleMicroseconds", &SerialPortConfig::frameIdleMicroseconds, 0},
+    {"frameTimeoutMs", &SerialPortConfig::frameTimeoutMs, 0},
+    {"serialBackend", &SerialPortConfig::serialBackend},
+    {"nativeProfile", &SerialPortConfig::nativeProfile},
+};
+
+static const quint32 CACHE_MAGIC = 0x46535043;  // "FSPC"
+static const quint16 CACHE_VERSION = 3;
+static const int CACHE_CHECKSUM_BYTES = 2;     // 末尾 CRC-16，覆盖前面全部内容
+
+// 没有 Profiles 节的旧文件读作该名称的配置
+static const char *const DEFAULT_PROFILE_NAME = "默认";
+
+ConfigSet::ConfigSet()
+    : profiles(1)
+    , activeProfile(0)
+{
+    profiles[0].name = DEFAULT_PROFILE_NAME;
+}
+
+int ConfigSet::indexOf(const QString &name) const
+{
+    for (int i = 0; i < profiles.size(); ++i) {
+        if (profiles.at(i).name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 字段表的指纹，字段增删或改类型后旧缓存自动失效
+static quint32 cacheSchema()
+{
+    static const quint32 schema = []() {
+        QByteArray names;
+        for (const SerialField &field : SERIAL_FIELDS) {
+            names += field.name;
+            names += field.text ? 's' : (field.number ? 'i' : 'b');
+        }
+        return quint32(qHash(names));
+    }();
+    return schema;
+}
+
+static const SerialField *findField(QStringView name)
+{
+    for (const SerialField &field : SERIAL_FIELDS) {
+        if (name == QLatin1String(field.name)) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+static void setField(SerialPortConfig &config, const SerialField &field, const QString &value)
+{
+    if (field.text) {
+        config.*field.text = value;
+    } else if (field.number) {
+        config.*field.number = qBound(field.minimum, value.toInt(), field.maximum);
+    } else {
+        config.*field.flag = (value == "true");
+    }
+}
+
+// 读取 s[i] 开始的 digits 位十六进制数
+static bool readHex(QStringView s, qsizetype i, int digits, uint *code)
+{
+    if (i + digits > s.size()) {
+        return false;
+    }
+    bool ok = false;
+    *code = s.mid(i, digits).toUInt(&ok, 16);
+    return ok;
+}
+
+// 读取以 s[0] 的双引号开始的字符串，返回结束引号之后的位置，没有结束引号返回-1
+static qsizetype readQuoted(QStringView s, QString *out)
+{
+    out->clear();
+    qsizetype i = 1;
+    while (i < s.size()) {
+        const QChar c = s.at(i++);
+        if (c == '"') {
+            return i;
+        }
+        if (c != '\\' || i >= s.size()) {
+            out->append(c);
+            continue;
+        }
+
+        const QChar e = s.at(i++);
+        uint code = 0;
+        switch (e.unicode()) {
+        case 'n': out->append('\n'); break;
+        case 'r': out->append('\r'); break;
+        case 't': out->append('\t'); break;
+        case '0': out->append(QChar(0)); break;
+        case 'a': out->append(QChar(0x07)); break;
+        case 'b': out->append(QChar(0x08)); break;
+        case 'e': out->append(QChar(0x1B)); break;
+        case 'f': out->append(QChar(0x0C)); break;
+        case 'v': out->append(QChar(0x0B)); break;
+        case 'x':
+        case 'u':
+        case 'U': {
+            const int digits = e == 'x' ? 2 : (e == 'u' ? 4 : 8);
+            if (!readHex(s, i, digits, &code)) {
+                out->append('\\');
+                out->append(e);
+                break;
+            }
+            i += digits;
+            if (e == 'U') {
+                if (code > 0x10FFFF) {
+                    out->append(QChar::ReplacementCharacter);
+                } else {
+                    const char32_t ucs4 = code;
+                    out->append(QString::fromUcs4(&ucs4, 1));
+                }
+            } else {
+                out->append(QChar(char16_t(code)));
+            }
+            break;
+        }
+        default:
+            // \" \\ \/ 以及无法识别的转义都原样保留转义后的字符
+            if (e != '"' && e != '\\' && e != '/') {
+                out->append('\\');
+            }
+            out->append(e);
+            break;
+        }
+    }
+    return -1;
+}
+
+// 解析一行 "key: value"，hasValue 为false时是节或按键的标题行
+static bool parseEntry(QStringView content, bool escapes, QString *key, QString *value, bool *hasValue)
+{
+    qsizetype pos = 0;
+    if (content.startsWith('"')) {
+        const qsizetype end = readQuoted(content, key);
+        if (end < 0) {
+            return false;
+        }
+        pos = end;
+        while (pos < content.size() && content.at(pos) == ' ') {
+            ++pos;
+        }
+        if (pos >= content.size() || content.at(pos) != ':') {
+            return false;
+        }
+    } else {
+        pos = content.indexOf(':');
+        if (pos <= 0) {
+            return false;
+        }
+        *key = content.left(pos).trimmed().toString();
+    }
+
+    QStringView rest = content.mid(pos + 1).trimmed();
+    *hasValue = !rest.isEmpty() && !rest.startsWith('#');
+    value->clear();
+    if (!*hasValue) {
+        return true;
+    }
+
+    if (rest.startsWith('"')) {
+        if (escapes) {
+            if (readQuoted(rest, value) < 0) {
+                return false;
+            }
+        } else {
+            // 旧文件不转义：取第一个和最后一个引号之间的全部内容
+            const qsizetype last = rest.lastIndexOf('"');
+            *value = (last > 0 ? rest.mid(1, last - 1) : rest.mid(1)).toString();
+        }
+        return true;
+    }
+
+    const qsizetype comment = rest.indexOf(QLatin1String(" #"));
+    *value = (comment < 0 ? rest : rest.left(comment)).trimmed().toString();
+    return true;
+}
+
+// 放入网格，缺少 row/col 字段时从 "row,col" 键中取
+static void storeButton(ButtonGrid &buttons, const QString &key, ButtonData button)
+{
+    if (!button.isValid) {
+        return;
+    }
+    if (button.row < 0 || button.col < 0) {
+        const QStringList parts = key.split(',');
+        if (parts.size() == 2) {
+            button.row = parts.at(0).trimmed().toInt();
+            button.col = parts.at(1).trimmed().toInt();
+        }
+    }
+    buttons.set(button);
+}
+
+QString ConfigFile::quote(const QString &text)
+{
+    QString result;
+    result.reserve(text.size() + 2);
+    result += '"';
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        switch (c.unicode()) {
+        case '"': result += QLatin1String("\\\""); break;
+        case '\\': result += QLatin1String("\\\\"); break;
+        case '\n': result += QLatin1String("\\n"); break;
+        case '\r': result += QLatin1String("\\r"); break;
+        case '\t': result += QLatin1String("\\t"); break;
+        case 0: result += QLatin1String("\\0"); break;
+        default:
+            if (c.unicode() < 0x20 || c.unicode() == 0x7F) {
+                result += QString("\\x%1").arg(c.unicode(), 2, 16, QChar('0'));
+            } else if (c.isHighSurrogate() && i + 1 < text.size() && text.at(i + 1).isLowSurrogate()) {
+                result += c;
+                result += text.at(++i);
+            } else if (c.isSurrogate()) {
+                // 不成对的代理项无法编码为UTF-8
+                result += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+            } else {
+                result += c;
+            }
+            break;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+// 写出一个配置的各节，indent 为节标题的缩进
+static void writeProfile(QTextStream &out, const ConfigData &data, const QString &indent)
+{
+    // 串口配置
+    out << indent << "SerialPort:\n";
+    for (const SerialField &field : SERIAL_FIELDS) {
+        out << indent << "  " << field.name << ": ";
+        if (field.text) {
+            out << ConfigFile::quote(data.serialConfig.*field.text);
+        } else if (field.number) {
+            out << data.serialConfig.*field.number;
+        } else {
+            out << (data.serialConfig.*field.flag ? "true" : "false");
+        }
+        out << "\n";
+    }
+    out << "\n";
+
+    // 表格配置
+    out << indent << "Table:\n";
+    out << indent << "  rows: " << data.tableRows << "\n";
+    out << indent << "  cols: " << data.tableCols << "\n\n";
+
+    // 按键数据
+    bool hasButtons = false;
+    data.buttons.forEach([&](const ButtonData &button) {
+        if (!hasButtons) {
+            out << indent << "Buttons:\n";
+            hasButtons = true;
+        }
+        out << indent << "  \"" << button.row << "," << button.col << "\":\n";
+        out << indent << "    remark: " << ConfigFile::quote(button.remark) << "\n";
+        out << indent << "    command: " << ConfigFile::quote(button.command) << "\n";
+        out << indent << "    isHexCommand: " << (button.isHexCommand ? "true" : "false") << "\n";
+        out << indent << "    type: " << ConfigFile::quote(button.type == ButtonData::MacroButton ? "macro" : "command") << "\n";
+        out << indent << "    row: " << button.row << "\n";
+        out << indent << "    col: " << button.col << "\n";
+        out << indent << "    isValid: true\n";
+    });
+    if (hasButtons) {
+        out << "\n";
+    }
+}
+
+QByteArray ConfigFile::toYaml(const ConfigSet &set)
+{
+    QString text;
+    QTextStream out(&text);
+
+    out << "# Flex SerialPort Configuration File\n";
+    out << "# 自动生成，请勿手动编辑\n\n";
+    out << "FormatVersion: " << int(FormatVersion) << "\n";
+    out << "ActiveProfile: " << quote(set.profiles.value(set.activeProfile).name) << "\n\n";
+
+    // 命名配置
+    const QString sectionIndent(4, ' ');
+    out << "Profiles:\n";
+    for (const ConfigProfile &profile : set.profiles) {
+        out << "  " << quote(profile.name) << ":\n";
+        writeProfile(out, profile.data, sectionIndent);
+    }
+
+    out.flush();
+    return text.toUtf8();
+}
+
+bool ConfigFile::fromYaml(const QByteArray &yaml, ConfigSet *set)
+{
+    const QString text = QString::fromUtf8(yaml);
+    QStringView rest(text);
+    if (rest.startsWith(QChar(0xFEFF))) {
+        rest = rest.mid(1);
+    }
+
+    ConfigSet loaded;
+    loaded.profiles.clear();
+    int version = 1;
+    bool foundSection = false;
+    bool inProfiles = false;    // 正在读取 Profiles 节
+    int current = -1;           // 正在读取的配置
+    int legacyProfile = -1;     // 旧文件顶级各节所属的默认配置
+    QString activeName;
+    QString section;
+    QString key;
+    QString value;
+    bool hasValue = false;
+
+    // 正在读取的按键
+    QString buttonKey;
+    ButtonData button;
+    bool inButton = false;
+    auto finishButton = [&]() {
+        if (inButton) {
+            storeButton(loaded.profiles[current].data.buttons, buttonKey, button);
+            inButton = false;
+        }
+    };
+
+    while (!rest.isEmpty()) {
+        const qsizetype end = rest.indexOf('\n');
+        QStringView line = end < 0 ? rest : rest.left(end);
+        rest = end < 0 ? QStringView() : rest.mid(end + 1);
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        qsizetype indent = 0;
+        while (indent < line.size() && line.at(indent) == ' ') {
+            ++indent;
+        }
+        const QStringView content = line.mid(indent);
+        if (content.trimmed().isEmpty() || content.startsWith('#')) {
+            continue;
+        }
+        if (!parseEntry(content, version >= 2, &key, &value, &hasValue)) {
+            continue;
+        }
+
+        // 顶级：节标题、文件格式版本或当前配置名称
+        if (indent == 0) {
+            finishButton();
+            if (!hasValue) {
+                foundSection = true;
+                inProfiles = (key == "Profiles");
+                section = inProfiles ? QString() : key;
+                if (!inProfiles) {
+                    // 旧文件：顶级的 SerialPort / Table / Buttons 属于同一个默认配置
+                    if (legacyProfile < 0) {
+                        legacyProfile = int(loaded.profiles.size());
+                        loaded.profiles.append(ConfigProfile());
+                        loaded.profiles.last().name = DEFAULT_PROFILE_NAME;
+                    }
+                    current = legacyProfile;
+                }
+            } else if (key == "FormatVersion") {
+                version = value.toInt();
+            } else if (key == "ActiveProfile") {
+                activeName = value;
+            }
+            continue;
+        }
+
+        // Profiles 节内：缩进2为配置名称，缩进4为该配置的节标题，其余内容比旧文件多缩进4格
+        qsizetype base = 0;
+        if (inProfiles) {
+            if (indent < 4) {
+                finishButton();
+                if (!hasValue) {
+                    current = int(loaded.profiles.size());
+                    loaded.profiles.append(ConfigProfile());
+                    loaded.profiles.last().name = key;
+                    section.clear();
+                }
+                continue;
+            }
+            if (indent < 6) {
+                finishButton();
+                section = hasValue ? QString() : key;
+                continue;
+            }
+            base = 4;
+        }
+        if (current < 0) {
+            continue;
+        }
+        ConfigData &data = loaded.profiles[current].data;
+
+        if (section == "Buttons") {
+            // 按键标题："row,col":
+            if (indent - base < 4 && !hasValue) {
+                finishButton();
+                buttonKey = key;
+                button = ButtonData();
+                button.isValid = true;
+                inButton = true;
+            } else if (inButton && hasValue) {
+                if (key == "remark") button.remark = value;
+                else if (key == "command") button.command = value;
+                else if (key == "isHexCommand") button.isHexCommand = (value == "true");
+                else if (key == "type") button.type = value == "macro" ? ButtonData::MacroButton : ButtonData::CommandButton;
+                else if (key == "row") button.row = value.toInt();
+                else if (key == "col") button.col = value.toInt();
+                else if (key == "isValid") button.isValid = (value == "true");
+            }
+        } else if (section == "SerialPort" && hasValue) {
+            if (const SerialField *field = findField(key)) {
+                setField(data.serialConfig, *field, value);
+            }
+        } else if (section == "Table" && hasValue) {
+            if (key == "rows") data.tableRows = value.toInt();
+            else if (key == "cols") data.tableCols = value.toInt();
+        }
+    }
+    finishButton();
+
+    if (!foundSection || loaded.profiles.isEmpty()) {
+        return false;
+    }
+    loaded.activeProfile = qMax(0, loaded.indexOf(activeName));
+    *set = std::move(loaded);
+    return true;
+}
+
+static void writeCacheData(QDataStream &out, const ConfigData &data)
+{
+    for (const SerialField &field : SERIAL_FIELDS) {
+        if (field.text) {
+            out << data.serialConfig.*field.text;
+        } else if (field.number) {
+            out << qint32(data.serialConfig.*field.number);
+        } else {
+            out << data.serialConfig.*field.flag;
+        }
+    }
+    out << qint32(data.tableRows) << qint32(data.tableCols);
+
+    qint32 count = 0;
+    data.buttons.forEach([&](const ButtonData &) { ++count; });
+    out << count;
+    data.buttons.forEach([&](const ButtonData &button) {
+        out << qint32(button.row) << qint32(button.col) << button.isHexCommand << quint8(button.type)
+            << button.remark << button.command;
+    });
+}
+
+static bool readCacheData(QDataStream &in, ConfigData *data)
+{
+    for (const SerialField &field : SERIAL_FIELDS) {
+        if (field.text) {
+            in >> data->serialConfig.*field.text;
+        } else if (field.number) {
+            qint32 number = 0;
+            in >> number;
+            data->serialConfig.*field.number = number;
+        } else {
+            in >> data->serialConfig.*field.flag;
+        }
+    }
+    qint32 rows = 0;
+    qint32 cols = 0;
+    qint32 count = 0;
+    in >> rows >> cols >> count;
+    if (in.status() != QDataStream::Ok || count < 0) {
+        return false;
+    }
+    data->tableRows = rows;
+    data->tableCols = cols;
+
+    for (qint32 i = 0; i < count; ++i) {
+        qint32 row = 0;
+        qint32 col = 0;
+        quint8 type = 0;
+        ButtonData button;
+        in >> row >> col >> button.isHexCommand >> type >> button.remark >> button.command;
+        if (in.status() != QDataStream::Ok || type > ButtonData::MacroButton) {
+            return false;
+        }
+        button.type = ButtonData::Type(type);
+        button.row = row;
+        button.col = col;
+        button.isValid = true;
+        data->buttons.set(button);
+    }
+    return true;
+}
+
+QByteArray ConfigFile::toCache(const ConfigSet &set, qint64 sourceSize, qint64 sourceModifiedMs)
+{
+    QByteArray cache;
+    QDataStream out(&cache, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CACHE_MAGIC << CACHE_VERSION << cacheSchema() << sourceSize << sourceModifiedMs;
+
+    out << qint32(set.activeProfile) << qint32(set.profiles.size());
+    for (const ConfigProfile &profile : set.profiles) {
+        out << profile.name;
+        writeCacheData(out, profile.data);
+    }
+    out << quint16(qChecksum(cache));
+    return cache;
+}
+
+bool ConfigFile::fromCache(const QByteArray &cache, qint64 sourceSize, qint64 sourceModifiedMs, ConfigSet *set)
+{
+    if (cache.size() < CACHE_CHECKSUM_BYTES) {
+        return false;
+    }
+    const QByteArray body = cache.left(cache.size() - CACHE_CHECKSUM_BYTES);
+    const quint16 checksum = quint16((uchar(cache.at(body.size())) << 8) | uchar(cache.at(body.size() + 1)));
+    if (qChecksum(body) != checksum) {
+        return false;
+    }
+
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 schema = 0;
+    qint64 size = -1;
+    qint64 modified = -1;
+    qint32 active = -1;
+    qint32 count = 0;
+    in >> magic >> version >> schema >> size >> modified >> active >> count;
+    if (in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION
+        || schema != cacheSchema() || size != sourceSize || modified != sourceModifiedMs
+        || count < 1 || active < 0 || active >= count) {
+        return false;
+    }
+
+    ConfigSet loaded;
+    loaded.profiles.clear();
+    for (qint32 i = 0; i < count; ++i) {
+        ConfigProfile profile;
+        in >> profile.name;
+        if (!readCacheData(in, &profile.data)) {
+            return false;
+        }
+        loaded.profiles.append(profile);
+    }
+    if (!in.atEnd()) {
+        return false;
+    }
+
+    loaded.activeProfile = active;
+    *set = std::move(loaded);
+    return true;
+}
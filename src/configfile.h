@@ -0,0 +1,134 @@
+#ifndef CONFIGFILE_H
+#define CONFIGFILE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "buttongrid.h"
+
+// 串口配置结构
+struct SerialPortConfig {
+    QString portName;
+    int baudRate;
+    int dataBits;
+    int stopBits;
+    QString parity;
+    QString flowControl;    // 流控：none / rtscts / xonxoff
+    bool timestampDisplay;
+    QString timestampMode;  // 时间戳显示方式：absolute / delta（与上一行间隔）/ tx（与最近一次发送间隔）
+    bool hexDisplay;
+    bool hexSend;
+    bool autoSendEnter;
+    QString enterChars;
+    QString encoding;  // 中文编码方式
+    int renderFps;     // 接收日志每秒最大刷新次数
+    int logMaxLines;      // 每个日志窗口最多保留的行数，0为不限
+    int logMaxMegabytes;  // 每个日志窗口最多保留的数据量(MB)，0为不限
+    QString captureDirectory;   // 录制文件目录
+    int captureRotateMegabytes; // 录制文件按大小切换(MB)，0为不切换
+    int captureRotateMinutes;   // 录制文件按时间切换(分钟)，0为不切换
+    QString captureFsync;       // 录制落盘策略：none / block / interval
+    QString captureFormat;      // 录制文件格式：binary / text
+    int sendQueueKilobytes;     // 发送队列高水位(KB)
+    QString sendQueuePolicy;    // 发送队列满时的策略：drop / block / coalesce
+    int metricsDumpSeconds;     // 性能指标快照写入文件的周期(秒)，0为不写
+    QString frameMode;          // 接收分帧：none / delimiter / fixed / length / idle
+    QString frameDelimiter;     // 分隔符（十六进制）
+    int frameLength;            // 定长帧字节数
+    int frameLengthOffset;      // 长度字段在帧内的偏移
+    int frameLengthBytes;       // 长度字段字节数：1 / 2 / 4
+    bool frameLengthBigEndian;  // 长度字段是否大端
+    int frameLengthAdjust;      // 帧总长 = 偏移 + 字段字节数 + 字段值 + 该值
+    int frameIdleMicroseconds;  // 空闲分帧间隔(us)，0为按波特率取3.5字符时间
+    int frameTimeoutMs;         // 未收齐的帧超过该时间照常显示，0为一直等待
+    QString serialBackend;      // 串口后端：qt / native（termios + epoll，仅 Linux）
+    QString nativeProfile;      // 原生后端调优方式：latency / throughput
+
+    SerialPortConfig() {
+        portName = "";
+        baudRate = 9600;
+        dataBits = 8;
+        stopBits = 1;
+        parity = "NoParity";
+        flowControl = "none";
+        timestampDisplay = true;
+        timestampMode = "absolute";
+        hexDisplay = false;
+        hexSend = false;
+        autoSendEnter = true;
+        enterChars = "0D0A";
+        encoding = "UTF-8";
+        renderFps = 30;
+        logMaxLines = 100000;
+        logMaxMegabytes = 32;
+        captureDirectory = "";
+        captureRotateMegabytes = 256;
+        captureRotateMinutes = 0;
+        captureFsync = "interval";
+        captureFormat = "binary";
+        sendQueueKilobytes = 64;
+        sendQueuePolicy = "block";
+        metricsDumpSeconds = 0;
+        frameMode = "none";
+        frameDelimiter = "0A";
+        frameLength = 8;
+        frameLengthOffset = 0;
+        frameLengthBytes = 1;
+        frameLengthBigEndian = true;
+        frameLengthAdjust = 0;
+        frameIdleMicroseconds = 0;
+        frameTimeoutMs = 200;
+        serialBackend = "qt";
+        nativeProfile = "latency";
+    }
+};
+
+// 配置文件中保存的全部内容
+struct ConfigData {
+    SerialPortConfig serialConfig;
+    int tableRows;
+    int tableCols;
+    ButtonGrid buttons;
+
+    ConfigData() : tableRows(6), tableCols(8) {}
+};
+
+// 命名配置：一种设备对应的按键、串口配置和表格大小
+struct ConfigProfile {
+    QString name;
+    ConfigData data;
+};
+
+// 配置文件中保存的全部命名配置，至少有一个
+struct ConfigSet {
+    QVector<ConfigProfile> profiles;
+    int activeProfile;
+
+    ConfigSet();
+    // 按名称查找，没有返回-1
+    int indexOf(const QString &name) const;
+};
+
+// 配置文件读写
+// YAML 文件供人阅读：字符串一律加双引号并按 YAML 规则转义（\" \\ \n \xHH 等），
+// 备注和指令中的冒号、引号、反斜杠、换行都能原样保存和读回。没有 FormatVersion 的旧文件按原来的方式读取。
+// 多个命名配置保存在 Profiles 节下；没有 Profiles 节的旧文件读作一个默认配置。
+// 缓存文件为二进制，记录对应 YAML 文件的大小和修改时间并带校验和，一致时启动只需读取并解析一次缓存。
+class ConfigFile
+{
+public:
+    enum { FormatVersion = 3 };
+
+    static QByteArray toYaml(const ConfigSet &set);
+    // 无法识别的行跳过，返回false表示没有读到任何配置节，set 不变
+    static bool fromYaml(const QByteArray &yaml, ConfigSet *set);
+
+    static QByteArray toCache(const ConfigSet &set, qint64 sourceSize, qint64 sourceModifiedMs);
+    // 缓存损坏或与 YAML 文件不一致时返回false，set 不变
+    static bool fromCache(const QByteArray &cache, qint64 sourceSize, qint64 sourceModifiedMs, ConfigSet *set);
+
+    // 转义为带双引号的 YAML 字符串
+    static QString quote(const QString &text);
+};
+
+#endif // CONFIGFILE_H
@@ -0,0 +1,74 @@
+#include "deadlinesleeper.h"
+#include <chrono>
+#include <thread>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif defined(Q_OS_UNIX)
+#include <time.h>
+#include <errno.h>
+#endif
+
+DeadlineSleeper::DeadlineSleeper()
+    : timer(nullptr)
+{
+#if defined(Q_OS_WIN)
+    timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer) {
+        // 旧系统不支持高精度定时器
+        timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+#endif
+}
+
+DeadlineSleeper::~DeadlineSleeper()
+{
+#if defined(Q_OS_WIN)
+    if (timer) {
+        CloseHandle(timer);
+    }
+#endif
+}
+
+qint64 DeadlineSleeper::nowNs()
+{
+#if defined(Q_OS_UNIX)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void DeadlineSleeper::sleepUntil(qint64 deadlineNs)
+{
+#if defined(Q_OS_UNIX) && defined(TIMER_ABSTIME) && !defined(Q_OS_DARWIN)
+    timespec ts;
+    ts.tv_sec = deadlineNs / 1000000000;
+    ts.tv_nsec = deadlineNs % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#else
+    const qint64 remaining = deadlineNs - nowNs();
+    if (remaining <= 0) {
+        return;
+    }
+#if defined(Q_OS_WIN)
+    if (timer) {
+        // 可等待定时器只支持相对时间（100ns单位，负值），每次按剩余时间重新设置
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -(remaining / 100);
+        if (SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::nanoseconds(remaining));
+#endif
+}
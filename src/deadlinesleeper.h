@@ -0,0 +1,24 @@
+#ifndef DEADLINESLEEPER_H
+#define DEADLINESLEEPER_H
+
+#include <QtGlobal>
+
+// 按绝对截止时间休眠，各平台使用可用的最高精度机制
+// （Linux 使用 clock_nanosleep + TIMER_ABSTIME，Windows 使用高精度可等待定时器）。
+// 截止时间以 nowNs() 的单调时钟为准；需要微秒级精度时调用方在最后一小段自行忙等。
+class DeadlineSleeper
+{
+public:
+    DeadlineSleeper();
+    ~DeadlineSleeper();
+
+    static qint64 nowNs();
+    void sleepUntil(qint64 deadlineNs);
+
+private:
+    Q_DISABLE_COPY(DeadlineSleeper)
+
+    void *timer;    // Windows 可等待定时器句柄，其他平台不用
+};
+
+#endif // DEADLINESLEEPER_H
@@ -0,0 +1,354 @@
+#include "frameassembler.h"
+#include <string.h>
+
+FrameOptions::Mode FrameOptions::modeFromString(const QString &mode)
+{
+    if (mode == "delimiter") {
+        return Delimiter;
+    } else if (mode == "fixed") {
+        return FixedLength;
+    } else if (mode == "length") {
+        return LengthPrefix;
+    } else if (mode == "idle") {
+        return IdleGap;
+    }
+    return None;
+}
+
+QString FrameOptions::modeToString(Mode mode)
+{
+    switch (mode) {
+    case Delimiter:
+        return "delimiter";
+    case FixedLength:
+        return "fixed";
+    case LengthPrefix:
+        return "length";
+    case IdleGap:
+        return "idle";
+    default:
+        return "none";
+    }
+}
+
+qint64 FrameOptions::modbusIdleGapNs(int baudRate)
+{
+    if (baudRate <= 0 || baudRate > 19200) {
+        return 1750000;
+    }
+    return qint64(3.5 * 11 * 1e9 / baudRate);
+}
+
+// 在 data 中查找分隔符，返回起始位置，未找到返回-1
+static qsizetype findDelimiter(const char *data, qsizetype len, const QByteArray &delimiter)
+{
+    const qsizetype delimiterSize = delimiter.size();
+    const char first = delimiter.at(0);
+    const char *p = data;
+    const char *end = data + len;
+    while (end - p >= delimiterSize) {
+        p = static_cast<const char *>(memchr(p, first, size_t(end - p)));
+        if (!p || end - p < delimiterSize) {
+            return -1;
+        }
+        if (memcmp(p, delimiter.constData(), size_t(delimiterSize)) == 0) {
+            return p - data;
+        }
+        ++p;
+    }
+    return -1;
+}
+
+FrameAssembler::FrameAssembler(const FrameOptions &options)
+    : pendingTimestampNs(0)
+    , lastArrivalNs(0)
+{
+    setOptions(options);
+}
+
+void FrameAssembler::setOptions(const FrameOptions &options)
+{
+    opts = options;
+    if (opts.delimiter.isEmpty() && opts.mode == FrameOptions::Delimiter) {
+        opts.mode = FrameOptions::None;
+    }
+    opts.fixedLength = qMax(1, opts.fixedLength);
+    if (opts.lengthBytes != 1 && opts.lengthBytes != 2 && opts.lengthBytes != 4) {
+        opts.lengthBytes = 1;
+    }
+    opts.lengthOffset = qMax(0, opts.lengthOffset);
+    opts.maxFrameBytes = qMax(1, opts.maxFrameBytes);
+    if (opts.mode == FrameOptions::FixedLength) {
+        opts.maxFrameBytes = qMax(opts.maxFrameBytes, opts.fixedLength);
+    }
+    reset();
+}
+
+const FrameOptions &FrameAssembler::options() const
+{
+    return opts;
+}
+
+bool FrameAssembler::hasPending() const
+{
+    return !pending.isEmpty();
+}
+
+qsizetype FrameAssembler::pendingSize() const
+{
+    return pending.size();
+}
+
+void FrameAssembler::reset()
+{
+    pending.clear();
+    pendingTimestampNs = 0;
+    lastArrivalNs = 0;
+}
+
+qsizetype FrameAssembler::headerSize() const
+{
+    return qsizetype(opts.lengthOffset) + opts.lengthBytes;
+}
+
+qsizetype FrameAssembler::lengthFromHeader(const char *header) const
+{
+    const uchar *field = reinterpret_cast<const uchar *>(header + opts.lengthOffset);
+    quint64 value = 0;
+    for (int i = 0; i < opts.lengthBytes; ++i) {
+        const int index = opts.lengthBigEndian ? i : opts.lengthBytes - 1 - i;
+        value = (value << 8) | field[index];
+    }
+
+    const qint64 total = qint64(headerSize()) + qint64(value) + opts.lengthAdjust;
+    if (total < 1 || total > opts.maxFrameBytes) {
+        return -1;
+    }
+    return qsizetype(total);
+}
+
+qsizetype FrameAssembler::frameLength(const char *data, qsizetype len, bool *complete) const
+{
+    *complete = true;
+
+    switch (opts.mode) {
+    case FrameOptions::Delimiter: {
+        const qsizetype index = findDelimiter(data, len, opts.delimiter);
+        if (index >= 0) {
+            const qsizetype total = index + opts.delimiter.size();
+            if (total > opts.maxFrameBytes) {
+                *complete = false;
+                return opts.maxFrameBytes;
+            }
+            return total;
+        }
+        if (len >= opts.maxFrameBytes) {
+            *complete = false;
+            return opts.maxFrameBytes;
+        }
+        return -1;
+    }
+    case FrameOptions::FixedLength:
+        return len >= opts.fixedLength ? opts.fixedLength : -1;
+    case FrameOptions::LengthPrefix: {
+        if (len < headerSize()) {
+            return -1;
+        }
+        const qsizetype total = lengthFromHeader(data);
+        if (total < 0) {
+            // 长度字段非法，丢弃一个字节后重新同步
+            *complete = false;
+            return 1;
+        }
+        return len >= total ? total : -1;
+    }
+    default:
+        return -1;
+    }
+}
+
+qsizetype FrameAssembler::continuePending(const char *data, qsizetype len, bool *done, bool *complete) const
+{
+    *done = false;
+    *complete = true;
+
+    switch (opts.mode) {
+    case FrameOptions::Delimiter: {
+        const QByteArray &delimiter = opts.delimiter;
+        const qsizetype delimiterSize = delimiter.size();
+        qsizetype take = -1;
+
+        // 分隔符跨在两块之间：pending 结尾是分隔符的前k个字节，data 开头是其余部分
+        for (qsizetype k = qMin(delimiterSize - 1, pending.size()); k >= 1 && take < 0; --k) {
+            if (len >= delimiterSize - k
+                && memcmp(pending.constData() + pending.size() - k, delimiter.constData(), size_t(k)) == 0
+                && memcmp(data, delimiter.constData() + k, size_t(delimiterSize - k)) == 0) {
+                take = delimiterSize - k;
+            }
+        }
+        if (take < 0) {
+            const qsizetype index = findDelimiter(data, len, delimiter);
+            take = index >= 0 ? index + delimiterSize : -1;
+        }
+
+        if (take >= 0) {
+            *done = true;
+        } else {
+            take = len;
+        }
+        if (pending.size() + take > opts.maxFrameBytes || (!*done && pending.size() + take == opts.maxFrameBytes)) {
+            take = opts.maxFrameBytes - pending.size();
+            *done = true;
+            *complete = false;
+        }
+        return take;
+    }
+    case FrameOptions::FixedLength: {
+        const qsizetype need = opts.fixedLength - pending.size();
+        const qsizetype take = qMin(need, len);
+        *done = take == need;
+        return take;
+    }
+    case FrameOptions::LengthPrefix: {
+        if (pending.size() < headerSize()) {
+            return qMin(headerSize() - pending.size(), len);
+        }
+        const qsizetype total = lengthFromHeader(pending.constData());
+        if (total < 0) {
+            *done = true;
+            *complete = false;
+            return 0;
+        }
+        const qsizetype need = total - pending.size();
+        const qsizetype take = qMin(need, len);
+        *done = take == need;
+        return take;
+    }
+    default:
+        return len;
+    }
+}
+
+void FrameAssembler::emitPending(bool complete, const FrameHandler &handler)
+{
+    handler(QByteArrayView(pending), pendingTimestampNs, complete);
+    // 保留容量，下一个跨块帧不再分配
+    pending.truncate(0);
+}
+
+void FrameAssembler::feed(const char *data, qsizetype len, qint64 arrivalNs, const FrameHandler &handler)
+{
+    if (len <= 0) {
+        return;
+    }
+
+    if (opts.mode == FrameOptions::None) {
+        handler(QByteArrayView(data, len), arrivalNs, true);
+        return;
+    }
+
+    if (opts.mode == FrameOptions::IdleGap) {
+        // 与上一块之间的空闲超过间隔，上一帧结束
+        if (!pending.isEmpty() && arrivalNs - lastArrivalNs > opts.idleGapNs) {
+            emitPending(true, handler);
+        }
+        lastArrivalNs = arrivalNs;
+        qsizetype pos = 0;
+        while (pos < len) {
+            if (pending.isEmpty()) {
+                pendingTimestampNs = arrivalNs;
+            }
+            const qsizetype take = qMin<qsizetype>(opts.maxFrameBytes - pending.size(), len - pos);
+            pending.append(data + pos, take);
+            pos += take;
+            if (pending.size() >= opts.maxFrameBytes) {
+                emitPending(false, handler);
+            }
+        }
+        return;
+    }
+
+    lastArrivalNs = arrivalNs;
+    qsizetype pos = 0;
+
+    // 先补全上一块留下的帧
+    qsizetype takenFromBlock = 0;   // pending 中来自本块的字节数
+    while (!pending.isEmpty()) {
+        bool done = false;
+        bool complete = true;
+        const qsizetype take = continuePending(data + pos, len - pos, &done, &complete);
+        pending.append(data + pos, take);
+        pos += take;
+        takenFromBlock += take;
+        if (done && !complete && opts.mode == FrameOptions::LengthPrefix && pending.size() <= headerSize()) {
+            // 跨块帧头的长度字段非法：与块内一样只丢弃一个字节，
+            // 本块的字节退回输入重新扫描，上一块剩下的字节留在 pending 里重新拼帧头
+            handler(QByteArrayView(pending.constData(), 1), pendingTimestampNs, false);
+            pending.chop(takenFromBlock);
+            pending.remove(0, 1);
+            pos -= takenFromBlock;
+            takenFromBlock = 0;
+        } else if (done) {
+            emitPending(complete, handler);
+            takenFromBlock = 0;
+        } else if (take == 0) {
+            return;
+        }
+    }
+
+    // 完全落在本块内的帧直接引用输入数据
+    while (pos < len) {
+        bool complete = true;
+        qsizetype length = frameLength(data + pos, len - pos, &complete);
+        if (length < 0) {
+            break;
+        }
+        if (!complete && opts.mode == FrameOptions::LengthPrefix) {
+            // 连续的非法字节合并为一帧输出
+            while (pos + length < len) {
+                bool next = true;
+                const qsizetype skip = frameLength(data + pos + length, len - pos - length, &next);
+                if (skip < 0 || next) {
+                    break;
+                }
+                length += skip;
+            }
+        }
+        handler(QByteArrayView(data + pos, length), arrivalNs, complete);
+        pos += length;
+    }
+
+    if (pos < len) {
+        pendingTimestampNs = arrivalNs;
+        pending.append(data + pos, len - pos);
+    }
+}
+
+bool FrameAssembler::flushIfIdle(qint64 nowNs, const FrameHandler &handler)
+{
+    const qint64 deadline = idleDeadlineNs();
+    if (deadline < 0 || nowNs < deadline) {
+        return false;
+    }
+    emitPending(opts.mode == FrameOptions::IdleGap, handler);
+    return true;
+}
+
+void FrameAssembler::flush(const FrameHandler &handler)
+{
+    if (!pending.isEmpty()) {
+        emitPending(opts.mode == FrameOptions::IdleGap, handler);
+    }
+}
+
+qint64 FrameAssembler::idleDeadlineNs() const
+{
+    if (pending.isEmpty()) {
+        return -1;
+    }
+    const qint64 limit = opts.mode == FrameOptions::IdleGap ? opts.idleGapNs : opts.timeoutNs;
+    if (limit <= 0) {
+        return -1;
+    }
+    return lastArrivalNs + limit;
+}
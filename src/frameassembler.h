@@ -0,0 +1,95 @@
+#ifndef FRAMEASSEMBLER_H
+#define FRAMEASSEMBLER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <functional>
+
+// 分帧选项
+struct FrameOptions {
+    enum Mode {
+        None,           // 不分帧，按读取到的数据块显示
+        Delimiter,      // 以分隔符结尾（分隔符包含在帧内）
+        FixedLength,    // 固定长度
+        LengthPrefix,   // 帧头中的长度字段决定帧长
+        IdleGap         // 字节间空闲超过间隔即为一帧（如 Modbus RTU 的3.5字符时间）
+    };
+
+    Mode mode;
+    QByteArray delimiter;
+    int fixedLength;
+    int lengthOffset;       // 长度字段在帧内的偏移
+    int lengthBytes;        // 长度字段字节数：1 / 2 / 4
+    bool lengthBigEndian;
+    int lengthAdjust;       // 帧总长 = lengthOffset + lengthBytes + 长度字段值 + lengthAdjust
+    qint64 idleGapNs;       // IdleGap 模式的空闲间隔
+    qint64 timeoutNs;       // 其他模式下未完成的帧超过该时间仍未收齐则照常输出，0为一直等待
+    int maxFrameBytes;      // 超过该长度仍未结束的帧强制截断输出
+
+    FrameOptions() {
+        mode = None;
+        delimiter = "\n";
+        fixedLength = 8;
+        lengthOffset = 0;
+        lengthBytes = 1;
+        lengthBigEndian = true;
+        lengthAdjust = 0;
+        idleGapNs = 1750000;
+        timeoutNs = 200000000;
+        maxFrameBytes = 64 * 1024;
+    }
+
+    // 由配置字符串得到模式：none / delimiter / fixed / length / idle
+    static Mode modeFromString(const QString &mode);
+    static QString modeToString(Mode mode);
+    // Modbus RTU 帧间隔：3.5个字符时间（每字符11位），波特率高于19200时固定为1750us
+    static qint64 modbusIdleGapNs(int baudRate);
+};
+
+// 接收分帧
+// 位于读取和显示之间：按分隔符、固定长度、长度前缀或字节间空闲把字节流切成帧，
+// 每帧只带一个时间戳（帧首字节所在数据块的到达时刻）。
+// 完全落在一个输入块内的帧直接引用输入数据，不拷贝；只有跨块的帧才拼接到内部缓冲。
+class FrameAssembler
+{
+public:
+    // frame 只在回调期间有效；complete 为 false 表示超时、超长截断或长度字段非法
+    using FrameHandler = std::function<void(QByteArrayView frame, qint64 timestampNs, bool complete)>;
+
+    explicit FrameAssembler(const FrameOptions &options = FrameOptions());
+
+    void setOptions(const FrameOptions &options);
+    const FrameOptions &options() const;
+
+    // 输入一块数据，arrivalNs 为这块数据的到达时刻（单调时钟），完整的帧依次交给 handler
+    void feed(const char *data, qsizetype len, qint64 arrivalNs, const FrameHandler &handler);
+
+    // 距最后一次输入超过空闲间隔（IdleGap）或超时时间（其他模式）时输出未完成的帧
+    bool flushIfIdle(qint64 nowNs, const FrameHandler &handler);
+    // 下一次需要调用 flushIfIdle 的时刻，无未完成的帧时返回-1
+    qint64 idleDeadlineNs() const;
+    // 立即输出未完成的帧（切换分帧方式前调用）
+    void flush(const FrameHandler &handler);
+
+    bool hasPending() const;
+    qsizetype pendingSize() const;
+    void reset();
+
+private:
+    FrameOptions opts;
+    QByteArray pending;         // 跨块的未完成帧
+    qint64 pendingTimestampNs;
+    qint64 lastArrivalNs;
+
+    qsizetype headerSize() const;
+    // 解析长度字段，得到帧总长；非法时返回-1
+    qsizetype lengthFromHeader(const char *header) const;
+    // 从 data 开头的一帧的长度；数据不足返回-1；*complete 为 false 表示截断或非法
+    qsizetype frameLength(const char *data, qsizetype len, bool *complete) const;
+    // 跨块帧：从 data 中取入 pending 的字节数，*done 表示取入后 pending 成为一帧
+    qsizetype continuePending(const char *data, qsizetype len, bool *done, bool *complete) const;
+    void emitPending(bool complete, const FrameHandler &handler);
+};
+
+#endif // FRAMEASSEMBLER_H
@@ -0,0 +1,345 @@
+#include "hexcodec.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HEXCODEC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define HEXCODEC_TARGET_AVX2
+#else
+#define HEXCODEC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// 解码查表：0-15为数字值，WS为空白，BAD为非法字符
+static const quint8 WS = 0xFE;
+static const quint8 BAD = 0xFF;
+
+struct DecodeTable {
+    quint8 value[256];
+
+    DecodeTable()
+    {
+        std::memset(value, BAD, sizeof(value));
+        for (int i = 0; i < 10; ++i) {
+            value['0' + i] = quint8(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            value['A' + i] = quint8(10 + i);
+            value['a' + i] = quint8(10 + i);
+        }
+        value[' '] = WS;
+        value['\t'] = WS;
+        value['\r'] = WS;
+        value['\n'] = WS;
+    }
+};
+
+static const DecodeTable decodeTable;
+
+// ==================== 编码内核 ====================
+// 各内核只处理整块数据，剩余部分（含最后一个不带尾随空格的字节）由查表实现收尾。
+// 返回已处理的输入字节数，输出写到 out + 3 * 返回值。
+
+static qsizetype encodeScalar(const quint8 *in, qsizetype len, char *out)
+{
+    for (qsizetype i = 0; i < len; ++i) {
+        out[0] = HEX_DIGITS[in[i] >> 4];
+        out[1] = HEX_DIGITS[in[i] & 0x0F];
+        out[2] = ' ';
+        out += 3;
+    }
+    return len;
+}
+
+#ifdef HEXCODEC_X86
+
+// SSE2：每次16字节。半字节转ASCII后与空格交错成 "H L ' ' 0" 的32位单元，
+// 以3字节步长重叠写出，第4字节会被下一个单元覆盖，因此要求后面至少还有一个字节。
+static qsizetype encodeSse2(const quint8 *in, qsizetype len, char *out)
+{
+    const __m128i lowMask = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i letterGap = _mm_set1_epi8('A' - '0' - 10);
+    const __m128i space = _mm_set1_epi16(' ');
+    alignas(16) quint32 units[16];
+
+    qsizetype done = 0;
+    while (len - done > 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), lowMask);
+        const __m128i lo = _mm_and_si128(v, lowMask);
+        const __m128i hiAscii = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letterGap));
+        const __m128i loAscii = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letterGap));
+
+        const __m128i pairs0 = _mm_unpacklo_epi8(hiAscii, loAscii);
+        const __m128i pairs1 = _mm_unpackhi_epi8(hiAscii, loAscii);
+        _mm_store_si128(reinterpret_cast<__m128i *>(units), _mm_unpacklo_epi16(pairs0, space));
+        _mm_store_si128(reinterpret_cast<__m128i *>(units + 4), _mm_unpackhi_epi16(pairs0, space));
+        _mm_store_si128(reinterpret_cast<__m128i *>(units + 8), _mm_unpacklo_epi16(pairs1, space));
+        _mm_store_si128(reinterpret_cast<__m128i *>(units + 12), _mm_unpackhi_epi16(pairs1, space));
+
+        char *dst = out + done * 3;
+        for (int i = 0; i < 16; ++i) {
+            std::memcpy(dst + i * 3, units + i, 4);
+        }
+        done += 16;
+    }
+    return done;
+}
+
+// AVX2：每次32字节，每个128位通道独立处理16字节。
+// 查表得到32个十六进制字符后，用三次字节重排在每三个字符处插入空格，得到48字节输出。
+HEXCODEC_TARGET_AVX2
+static qsizetype encodeAvx2(const quint8 *in, qsizetype len, char *out)
+{
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    const __m256i digits = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(HEX_DIGITS)));
+    const __m256i shuffle0 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 1, -128, 2, 3, -128, 4, 5, -128, 6, 7, -128, 8, 9, -128, 10));
+    const __m256i shuffle1 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(3, -128, 4, 5, -128, 6, 7, -128, 8, 9, -128, 10, 11, -128, 12, 13));
+    const __m256i shuffle2 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-128, 6, 7, -128, 8, 9, -128, 10, 11, -128, 12, 13, -128, 14, 15, -128));
+    const __m256i spaceChar = _mm256_set1_epi8(' ');
+    const __m256i zeroVec = _mm256_setzero_si256();
+    const __m256i spaces0 = _mm256_and_si256(_mm256_cmpgt_epi8(zeroVec, shuffle0), spaceChar);
+    const __m256i spaces1 = _mm256_and_si256(_mm256_cmpgt_epi8(zeroVec, shuffle1), spaceChar);
+    const __m256i spaces2 = _mm256_and_si256(_mm256_cmpgt_epi8(zeroVec, shuffle2), spaceChar);
+
+    qsizetype done = 0;
+    while (len - done > 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done));
+        const __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+        const __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, lowMask));
+
+        // 每个通道：chars0 为前8字节的16个字符，chars1 为后8字节
+        const __m256i chars0 = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i chars1 = _mm256_unpackhi_epi8(hi, lo);
+        const __m256i middle = _mm256_alignr_epi8(chars1, chars0, 8);
+
+        const __m256i out0 = _mm256_or_si256(_mm256_shuffle_epi8(chars0, shuffle0), spaces0);
+        const __m256i out1 = _mm256_or_si256(_mm256_shuffle_epi8(middle, shuffle1), spaces1);
+        const __m256i out2 = _mm256_or_si256(_mm256_shuffle_epi8(chars1, shuffle2), spaces2);
+
+        __m128i *dst = reinterpret_cast<__m128i *>(out + done * 3);
+        _mm_storeu_si128(dst, _mm256_castsi256_si128(out0));
+        _mm_storeu_si128(dst + 1, _mm256_castsi256_si128(out1));
+        _mm_storeu_si128(dst + 2, _mm256_castsi256_si128(out2));
+        _mm_storeu_si128(dst + 3, _mm256_extracti128_si256(out0, 1));
+        _mm_storeu_si128(dst + 4, _mm256_extracti128_si256(out1, 1));
+        _mm_storeu_si128(dst + 5, _mm256_extracti128_si256(out2, 1));
+        done += 32;
+    }
+    return done;
+}
+
+static bool cpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // HEXCODEC_X86
+
+typedef qsizetype (*EncodeKernel)(const quint8 *, qsizetype, char *);
+
+struct KernelChoice {
+    EncodeKernel kernel;
+    const char *name;
+
+    KernelChoice()
+    {
+#ifdef HEXCODEC_X86
+        if (cpuHasAvx2()) {
+            kernel = encodeAvx2;
+            name = "AVX2";
+        } else {
+            kernel = encodeSse2;
+            name = "SSE2";
+        }
+#else
+        kernel = encodeScalar;
+        name = "scalar";
+#endif
+    }
+};
+
+static const KernelChoice &detectedKernel()
+{
+    static const KernelChoice choice;
+    return choice;
+}
+
+static std::atomic<bool> forceScalar(false);
+
+// 单遍解码，Char 为 quint8（字节输入）或 char16_t（界面输入）
+template <typename Char>
+static qsizetype decodeImpl(const Char *in, qsizetype len, char *out, qsizetype *errorOffset)
+{
+    const quint8 *table = decodeTable.value;
+    qsizetype written = 0;
+    qsizetype highOffset = -1;   // 落单高半字节的位置
+    quint8 high = 0;
+
+    for (qsizetype i = 0; i < len; ++i) {
+        const unsigned code = in[i];
+        const quint8 value = code < 256 ? table[code] : BAD;
+        if (value < 16) {
+            if (highOffset < 0) {
+                high = value;
+                highOffset = i;
+            } else {
+                if (out) {
+                    out[written] = char((high << 4) | value);
+                }
+                ++written;
+                highOffset = -1;
+            }
+        } else if (value != WS) {
+            if (errorOffset) *errorOffset = i;
+            return -1;
+        }
+    }
+
+    if (highOffset >= 0) {
+        if (errorOffset) *errorOffset = highOffset;
+        return -1;
+    }
+    return written;
+}
+
+// ==================== 公共接口 ====================
+
+qsizetype HexCodec::encode(const char *data, qsizetype len, char *out)
+{
+    if (len <= 0) {
+        return 0;
+    }
+
+    const quint8 *in = reinterpret_cast<const quint8 *>(data);
+    qsizetype done = 0;
+    if (!forceScalar.load(std::memory_order_relaxed)) {
+        done = detectedKernel().kernel(in, len, out);
+    }
+
+    // 收尾：最后一个字节后面不带空格
+    done += encodeScalar(in + done, len - 1 - done, out + done * 3);
+    char *last = out + done * 3;
+    last[0] = HEX_DIGITS[in[done] >> 4];
+    last[1] = HEX_DIGITS[in[done] & 0x0F];
+    return encodedSize(len);
+}
+
+void HexCodec::appendHex(QByteArray &out, const char *data, qsizetype len)
+{
+    const qsizetype offset = out.size();
+    out.resize(offset + encodedSize(len));
+    encode(data, len, out.data() + offset);
+}
+
+QString HexCodec::toHexString(const char *data, qsizetype len)
+{
+    // 按块编码到栈上缓冲再展宽为UTF-16，全程只分配结果字符串一次
+    static const qsizetype CHUNK = 1024;
+    char buffer[CHUNK * 3];
+
+    QString result(encodedSize(len), Qt::Uninitialized);
+    char16_t *dst = reinterpret_cast<char16_t *>(result.data());
+    for (qsizetype pos = 0; pos < len; pos += CHUNK) {
+        const qsizetype n = qMin(CHUNK, len - pos);
+        const qsizetype written = encode(data + pos, n, buffer);
+        for (qsizetype i = 0; i < written; ++i) {
+            *dst++ = char16_t(quint8(buffer[i]));
+        }
+        if (pos + n < len) {
+            *dst++ = u' ';
+        }
+    }
+    return result;
+}
+
+QString HexCodec::toHexString(const QByteArray &data)
+{
+    return toHexString(data.constData(), data.size());
+}
+
+qsizetype HexCodec::decode(const char *text, qsizetype len, char *out, qsizetype *errorOffset)
+{
+    return decodeImpl(reinterpret_cast<const quint8 *>(text), len, out, errorOffset);
+}
+
+bool HexCodec::decode(const QByteArray &text, QByteArray *out, qsizetype *errorOffset)
+{
+    out->resize(text.size() / 2);
+    const qsizetype written = decode(text.constData(), text.size(), out->data(), errorOffset);
+    if (written < 0) {
+        out->clear();
+        return false;
+    }
+    out->resize(written);
+    return true;
+}
+
+qsizetype HexCodec::decode(QStringView text, char *out, qsizetype *errorOffset)
+{
+    return decodeImpl(text.utf16(), text.size(), out, errorOffset);
+}
+
+bool HexCodec::appendDecoded(QStringView text, QByteArray &out, qsizetype *errorOffset)
+{
+    const qsizetype offset = out.size();
+    out.resize(offset + text.size() / 2);
+    const qsizetype written = decode(text, out.data() + offset, errorOffset);
+    if (written < 0) {
+        out.resize(offset);
+        return false;
+    }
+    out.resize(offset + written);
+    return true;
+}
+
+QString HexCodec::errorDetail(QStringView text, qsizetype errorOffset)
+{
+    if (errorOffset < 0 || errorOffset >= text.size()) {
+        return "内容为空";
+    }
+    const QChar ch = text.at(errorOffset);
+    const unsigned code = ch.unicode();
+    if (code < 256 && decodeTable.value[code] < 16) {
+        return QString("第 %1 个字符 '%2' 缺少配对（十六进制位数为奇数）").arg(errorOffset + 1).arg(ch);
+    }
+    return QString("第 %1 个字符 '%2' 不是十六进制字符").arg(errorOffset + 1).arg(ch);
+}
+
+const char *HexCodec::kernelName()
+{
+    return forceScalar.load(std::memory_order_relaxed) ? "scalar" : detectedKernel().name;
+}
+
+void HexCodec::setScalarOnly(bool scalarOnly)
+{
+    forceScalar.store(scalarOnly, std::memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+#ifndef HEXCODEC_H
+#define HEXCODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+
+// 十六进制编解码
+// 编码输出以空格分隔的大写十六进制（"01 AB FF"），与 toHex(' ').toUpper() 结果相同，
+// 但直接写入调用方提供的缓冲区，不产生中间副本。
+// x86-64 上按CPU能力在运行时选择 AVX2 / SSE2 内核，其他平台使用查表实现。
+namespace HexCodec
+{
+    // n 字节编码后的长度：3n-1（n为0时为0）
+    inline qsizetype encodedSize(qsizetype len)
+    {
+        return len > 0 ? len * 3 - 1 : 0;
+    }
+
+    // 把 len 字节编码写入 out（至少 encodedSize(len) 字节），返回写入的字节数
+    qsizetype encode(const char *data, qsizetype len, char *out);
+
+    // 追加到已有缓冲区末尾，只扩容一次
+    void appendHex(QByteArray &out, const char *data, qsizetype len);
+
+    // 编码为QString，只分配一次
+    QString toHexString(const char *data, qsizetype len);
+    QString toHexString(const QByteArray &data);
+
+    // 单遍解码：跳过空白（空格、制表、回车、换行）并校验字符，
+    // out 至少 len/2 字节。成功返回解码字节数；失败返回-1，
+    // errorOffset 为第一个非法字符的位置，十六进制位数为奇数时为最后一个落单数字的位置
+    // out 为nullptr时只校验不输出
+    qsizetype decode(const char *text, qsizetype len, char *out, qsizetype *errorOffset = nullptr);
+    bool decode(const QByteArray &text, QByteArray *out, qsizetype *errorOffset = nullptr);
+
+    // 直接解码界面输入（UTF-16），不做 trimmed/remove/toLatin1 等中间转换
+    qsizetype decode(QStringView text, char *out, qsizetype *errorOffset = nullptr);
+
+    // 解码结果追加到 out 末尾；失败时 out 保持不变
+    bool appendDecoded(QStringView text, QByteArray &out, qsizetype *errorOffset = nullptr);
+
+    // 解码失败时给界面的说明，errorOffset 为 decode 返回的出错位置
+    QString errorDetail(QStringView text, qsizetype errorOffset);
+
+    // 当前使用的编码内核："AVX2" / "SSE2" / "scalar"
+    const char *kernelName();
+
+    // 强制使用查表实现（基准测试对比用）
+    void setScalarOnly(bool scalarOnly);
+}
+
+#endif // HEXCODEC_H
@@ -1,4 +1,5 @@
 #include "logmanager.h"
+#include "hexcodec.h"
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QStandardPaths>
@@ -14,12 +15,12 @@ LogManager::LogManager(QObject *parent)
 {
 }
 
-void LogManager::setSendLogWidget(QTextBrowser *widget)
+void LogManager::setSendLogWidget(LogView *widget)
 {
     sendLogWidget = widget;
 }
 
-void LogManager::setReceiveLogWidget(QTextBrowser *widget)
+void LogManager::setReceiveLogWidget(LogView *widget)
 {
     receiveLogWidget = widget;
 }
@@ -29,7 +30,7 @@ void LogManager::addSendLog(const QString &data, bool isHex)
     if (sendLogPaused || !sendLogWidget) return;
     
     QString logEntry = formatLogEntry(data, Send, isHex);
-    sendLogWidget->insertPlainText(logEntry);
+    sendLogWidget->appendText(logEntry);
 }
 
 void LogManager::addReceiveLog(const QString &data, bool isHex)
@@ -37,7 +38,7 @@ void LogManager::addReceiveLog(const QString &data, bool isHex)
     if (receiveLogPaused || !receiveLogWidget) return;
     
     QString logEntry = formatLogEntry(data, Receive, isHex);
-    receiveLogWidget->insertPlainText(logEntry);
+    receiveLogWidget->appendText(logEntry);
 }
 
 void LogManager::addSendLog(const QByteArray &data, bool isHex)
@@ -187,7 +188,7 @@ QString LogManager::formatData(const QString &data, bool isHex)
     } else {
         // 如果需要转换为十六进制
         if (hexDisplayEnabled) {
-            return data.toUtf8().toHex(' ').toUpper();
+            return HexCodec::toHexString(data.toUtf8());
         } else {
             return data;
         }
@@ -197,7 +198,7 @@ QString LogManager::formatData(const QString &data, bool isHex)
 QString LogManager::formatData(const QByteArray &data, bool isHex)
 {
     if (isHex || hexDisplayEnabled) {
-        return data.toHex(' ').toUpper();
+        return HexCodec::toHexString(data);
     } else {
         return QString::fromUtf8(data);
     }
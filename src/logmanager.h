@@ -2,7 +2,7 @@
 #define LOGMANAGER_H
 
 #include <QObject>
-#include <QTextBrowser>
+#include "logview.h"
 #include <QString>
 #include <QDateTime>
 #include <QFile>
@@ -21,8 +21,8 @@ public:
     explicit LogManager(QObject *parent = nullptr);
 
     // 设置日志显示控件
-    void setSendLogWidget(QTextBrowser *widget);
-    void setReceiveLogWidget(QTextBrowser *widget);
+    void setSendLogWidget(LogView *widget);
+    void setReceiveLogWidget(LogView *widget);
 
     // 日志记录
     void addSendLog(const QString &data, bool isHex = false);
@@ -55,8 +55,8 @@ public:
     QString getReceiveLogContent() const;
 
 private:
-    QTextBrowser *sendLogWidget;
-    QTextBrowser *receiveLogWidget;
+    LogView *sendLogWidget;
+    LogView *receiveLogWidget;
 
     bool timestampEnabled;
     bool hexDisplayEnabled;
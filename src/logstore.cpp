@@ -0,0 +1,338 @@
+#include "logstore.h"
+#include <QStringView>
+#include <algorithm>
+#include <cstring>
+
+// 每页的目标大小
+static const qsizetype PAGE_SIZE = 64 * 1024;
+// 单行最大字节数，超出后强制换行；没有换行符的输入（二进制数据等）也不会让一行无限增长，
+// 一行总能放进一页
+static const qsizetype MAX_LINE_BYTES = PAGE_SIZE;
+
+// 不超过 len 的最大UTF-8字符边界，不把一个多字节字符拆到两行
+static qsizetype utf8Boundary(const char *data, qsizetype len)
+{
+    qsizetype end = len;
+    while (end > 0 && (uchar(data[end]) & 0xC0) == 0x80) {
+        end--;
+    }
+    return end;
+}
+
+LogStore::LogStore(qint64 maxLines, qint64 maxBytes)
+    : totalLines(0)
+    , totalBytes(0)
+    , lineLimit(maxLines)
+    , byteLimit(maxBytes)
+    , lastLineOpen(false)
+{
+}
+
+void LogStore::append(const QString &text, qint64 timestampNs)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    appendUtf8(text.toUtf8(), timestampNs);
+    evict();
+}
+
+void LogStore::append(const QString &text, const QVector<LogTimestamp> &stamps)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    // 第一个标记之前的部分没有时间戳
+    qsizetype pos = 0;
+    qint64 timestampNs = -1;
+    for (const LogTimestamp &stamp : stamps) {
+        const qsizetype end = qBound(pos, stamp.position, text.size());
+        if (end > pos) {
+            appendUtf8(QStringView(text).mid(pos, end - pos).toUtf8(), timestampNs);
+        }
+        pos = end;
+        timestampNs = stamp.timestampNs;
+    }
+    if (pos < text.size()) {
+        appendUtf8(QStringView(text).mid(pos).toUtf8(), timestampNs);
+    }
+
+    evict();
+}
+
+void LogStore::appendUtf8(const QByteArray &utf8, qint64 timestampNs)
+{
+    const char *data = utf8.constData();
+    const qsizetype size = utf8.size();
+
+    // 按'\n'切分，每段为一整行或一行的一部分
+    qsizetype pos = 0;
+    while (pos < size) {
+        const char *newline = static_cast<const char *>(std::memchr(data + pos, '\n', size_t(size - pos)));
+        const qsizetype end = newline ? qsizetype(newline - data) + 1 : size;
+        appendSegment(data + pos, end - pos, newline != nullptr, timestampNs);
+        pos = end;
+    }
+}
+
+void LogStore::clear()
+{
+    // 全局行号继续递增，避免视图把旧位置误认为新内容
+    const qint64 nextLine = firstLineNumber() + totalLines;
+    pages.clear();
+    totalLines = 0;
+    totalBytes = 0;
+    lastLineOpen = false;
+
+    Page page;
+    page.firstLine = nextLine;
+    page.data.reserve(PAGE_SIZE);
+    pages.append(page);
+}
+
+void LogStore::setLimits(qint64 maxLines, qint64 maxBytes)
+{
+    lineLimit = maxLines;
+    byteLimit = maxBytes;
+    evict();
+}
+
+qint64 LogStore::maxLines() const
+{
+    return lineLimit;
+}
+
+qint64 LogStore::maxBytes() const
+{
+    return byteLimit;
+}
+
+qint64 LogStore::lineCount() const
+{
+    return totalLines;
+}
+
+qint64 LogStore::byteSize() const
+{
+    return totalBytes;
+}
+
+qint64 LogStore::firstLineNumber() const
+{
+    return pages.isEmpty() ? 0 : pages.first().firstLine;
+}
+
+QString LogStore::line(qint64 index) const
+{
+    if (index < 0 || index >= totalLines) {
+        return QString();
+    }
+
+    const qint64 globalLine = firstLineNumber() + index;
+    const int pageIndex = findPage(globalLine);
+    if (pageIndex < 0) {
+        return QString();
+    }
+
+    const Page &page = pages.at(pageIndex);
+    const int local = int(globalLine - page.firstLine);
+    const qsizetype start = page.lineStarts.at(local);
+    qsizetype end = (local + 1 < page.lineStarts.size()) ? page.lineStarts.at(local + 1) : page.data.size();
+    if (end > start && page.data.at(end - 1) == '\n') {
+        end--;
+    }
+    return QString::fromUtf8(page.data.constData() + start, end - start);
+}
+
+qint64 LogStore::lineTimestamp(qint64 index) const
+{
+    if (index < 0 || index >= totalLines) {
+        return -1;
+    }
+
+    const qint64 globalLine = firstLineNumber() + index;
+    const int pageIndex = findPage(globalLine);
+    if (pageIndex < 0) {
+        return -1;
+    }
+    const Page &page = pages.at(pageIndex);
+    return page.lineTimestamps.at(int(globalLine - page.firstLine));
+}
+
+qint64 LogStore::timestampAtOrBefore(qint64 timestampNs) const
+{
+    // 先按各页首行的时间戳二分找到页，再在页内二分
+    int lo = 0;
+    int hi = int(pages.size()) - 1;
+    int found = -1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        const Page &page = pages.at(mid);
+        if (!page.lineTimestamps.isEmpty() && page.lineTimestamps.first() <= timestampNs) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (found < 0) {
+        return -1;
+    }
+
+    const QVector<qint64> &stamps = pages.at(found).lineTimestamps;
+    const auto it = std::upper_bound(stamps.begin(), stamps.end(), timestampNs);
+    return it == stamps.begin() ? -1 : *(it - 1);
+}
+
+QString LogStore::toPlainText() const
+{
+    QByteArray all;
+    all.reserve(totalBytes);
+    for (const Page &page : pages) {
+        all.append(page.data);
+    }
+    return QString::fromUtf8(all);
+}
+
+void LogStore::appendSegment(const char *data, qsizetype len, bool complete, qint64 timestampNs)
+{
+    while (len > 0) {
+        qsizetype used = 0;
+        if (lastLineOpen) {
+            const Page &last = pages.last();
+            used = last.data.size() - last.lineStarts.last();
+        }
+
+        // 超过单行上限的部分接到新的一行，新行沿用本段的时间戳
+        qsizetype take = len;
+        bool lineDone = complete;
+        if (used + len > MAX_LINE_BYTES) {
+            take = utf8Boundary(data, MAX_LINE_BYTES - used);
+            if (take == 0 && used == 0) {
+                take = MAX_LINE_BYTES;
+            }
+            lineDone = true;
+        }
+        if (take == 0) {
+            lastLineOpen = false;
+            continue;
+        }
+
+        Page &page = pageForNewData(take);
+        if (!lastLineOpen) {
+            page.lineStarts.append(quint32(page.data.size()));
+            page.lineTimestamps.append(timestampNs);
+            totalLines++;
+        }
+        page.data.append(data, take);
+        totalBytes += take;
+        lastLineOpen = !lineDone;
+        data += take;
+        len -= take;
+    }
+}
+
+LogStore::Page &LogStore::pageForNewData(qsizetype len)
+{
+    if (pages.isEmpty()) {
+        Page page;
+        page.firstLine = 0;
+        page.data.reserve(PAGE_SIZE);
+        pages.append(page);
+    }
+
+    Page &last = pages.last();
+    if (last.data.size() + len <= PAGE_SIZE || last.lineStarts.isEmpty()) {
+        return last;
+    }
+
+    Page page;
+    page.firstLine = last.firstLine + last.lineStarts.size();
+    page.data.reserve(qMax(PAGE_SIZE, len));
+
+    if (lastLineOpen) {
+        // 把未结束的半行整体搬到新页，保证一行不跨页；
+        // 单行不超过 MAX_LINE_BYTES，独占一页的半行总能放下，不会走到这里
+        const qsizetype start = last.lineStarts.last();
+        page.data.append(last.data.constData() + start, last.data.size() - start);
+        page.lineStarts.append(0);
+        page.lineTimestamps.append(last.lineTimestamps.last());
+        page.firstLine--;
+        last.data.truncate(start);
+        last.lineStarts.removeLast();
+        last.lineTimestamps.removeLast();
+    }
+
+    pages.append(page);
+    return pages.last();
+}
+
+void LogStore::evict()
+{
+    auto overLimit = [this]() {
+        return (lineLimit > 0 && totalLines > lineLimit) || (byteLimit > 0 && totalBytes > byteLimit);
+    };
+
+    // 整页淘汰，至少保留最后一页
+    while (pages.size() > 1 && overLimit()) {
+        const Page &front = pages.first();
+        totalLines -= front.lineStarts.size();
+        totalBytes -= front.data.size();
+        pages.removeFirst();
+    }
+    if (pages.isEmpty() || !overLimit()) {
+        return;
+    }
+
+    // 上限小于一页时在最后一页内按行淘汰，至少保留最后一行
+    Page &page = pages.first();
+    int dropLines = 0;
+    while (dropLines + 1 < page.lineStarts.size() && overLimit()) {
+        totalBytes -= page.lineStarts.at(dropLines + 1) - page.lineStarts.at(dropLines);
+        totalLines--;
+        dropLines++;
+    }
+    qsizetype cut = dropLines > 0 ? qsizetype(page.lineStarts.at(dropLines)) : 0;
+
+    // 只剩一行仍超过字节上限时丢弃它开头的部分
+    if (byteLimit > 0 && totalBytes > byteLimit) {
+        const qsizetype excess = qsizetype(totalBytes - byteLimit);
+        qsizetype headEnd = cut + excess;
+        while (headEnd < page.data.size() && (uchar(page.data.at(headEnd)) & 0xC0) == 0x80) {
+            headEnd++;
+        }
+        totalBytes -= headEnd - cut;
+        cut = headEnd;
+    }
+    if (cut == 0) {
+        return;
+    }
+
+    page.data.remove(0, cut);
+    page.lineStarts.remove(0, dropLines);
+    page.lineTimestamps.remove(0, dropLines);
+    for (quint32 &start : page.lineStarts) {
+        start = quint32(qMax<qsizetype>(0, qsizetype(start) - cut));
+    }
+    page.firstLine += dropLines;
+}
+
+int LogStore::findPage(qint64 globalLine) const
+{
+    // 各页的首行号单调递增，二分查找
+    int lo = 0;
+    int hi = int(pages.size()) - 1;
+    int found = -1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        if (pages.at(mid).firstLine <= globalLine) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,75 @@
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// 行时间戳标记：文本中从 position（QChar 下标）开始的各行使用该时间戳，直到下一个标记
+struct LogTimestamp {
+    qsizetype position;
+    qint64 timestampNs;     // 单调时钟（纳秒）
+};
+
+// 分块追加式日志存储
+// 文本以UTF-8存放在固定大小的字节页中，每页记录本页各行的起始偏移（行偏移索引）。
+// 只支持在末尾追加，最后一行可以是尚未结束的半行，后续追加会接在其后；单行超过64KB时强制换行。
+// 超过最大行数或最大字节数时按页从头部淘汰（环形淘汰），上限小于一页时在页内按行淘汰，内存占用保持恒定。
+// 每行可带一个到达时刻（单调时钟），只保存数值，显示时再格式化；行的时间戳取其首个字节所在的追加。
+class LogStore
+{
+public:
+    explicit LogStore(qint64 maxLines = 100000, qint64 maxBytes = 32 * 1024 * 1024);
+
+    // 追加文本，'\n' 为行分隔符；本次开始的新行使用 timestampNs，-1表示无时间戳
+    void append(const QString &text, qint64 timestampNs = -1);
+    // 追加文本，各段的时间戳由 stamps 给出（position 递增）
+    void append(const QString &text, const QVector<LogTimestamp> &stamps);
+    void clear();
+
+    // 保留上限，小于等于0表示不限制
+    void setLimits(qint64 maxLines, qint64 maxBytes);
+    qint64 maxLines() const;
+    qint64 maxBytes() const;
+
+    // 当前保留的行数（包括未结束的最后一行）和字节数
+    qint64 lineCount() const;
+    qint64 byteSize() const;
+
+    // 第一条保留行的全局行号，随淘汰单调增加，视图据此保持滚动位置稳定
+    qint64 firstLineNumber() const;
+
+    // 按保留区内的下标取一行（不含换行符）
+    QString line(qint64 index) const;
+    // 该行的时间戳，无时间戳返回-1
+    qint64 lineTimestamp(qint64 index) const;
+    // 不晚于 timestampNs 的最后一行的时间戳，没有返回-1（要求时间戳按追加顺序不减）
+    qint64 timestampAtOrBefore(qint64 timestampNs) const;
+
+    // 导出全部保留内容
+    QString toPlainText() const;
+
+private:
+    struct Page {
+        QByteArray data;              // 本页的UTF-8字节，各行带结尾的'\n'
+        QVector<quint32> lineStarts;  // 本页每一行的起始偏移
+        QVector<qint64> lineTimestamps; // 本页每一行的时间戳
+        qint64 firstLine;             // 本页第一行的全局行号
+    };
+
+    QList<Page> pages;
+    qint64 totalLines;
+    qint64 totalBytes;
+    qint64 lineLimit;
+    qint64 byteLimit;
+    bool lastLineOpen;  // 最后一行尚未收到换行符
+
+    void appendUtf8(const QByteArray &utf8, qint64 timestampNs);
+    void appendSegment(const char *data, qsizetype len, bool complete, qint64 timestampNs);
+    Page &pageForNewData(qsizetype len);
+    void evict();
+    int findPage(qint64 globalLine) const;
+};
+
+#endif // LOGSTORE_H
@@ -0,0 +1,376 @@
+#include "logview.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QApplication>
+#include <QClipboard>
+#include <QStringList>
+#include <QDateTime>
+#include <climits>
+#include "perfmetrics.h"
+
+// 文本左侧留白
+static const int TEXT_MARGIN = 4;
+
+LogView::LogView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , topLine(0)
+    , selectionAnchor(-1)
+    , selectionEnd(-1)
+    , maxLineWidth(0)
+    , stampMode(NoTimestamp)
+    , transmitReference(nullptr)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+    updateScrollBars();
+}
+
+void LogView::appendText(const QString &text, qint64 timestampNs)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    const bool follow = isAtBottom();
+    const qint64 oldTop = topLine;
+    logStore.append(text, timestampNs);
+    finishAppend(follow, oldTop);
+}
+
+void LogView::appendText(const QString &text, const QVector<LogTimestamp> &stamps)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    const bool follow = isAtBottom();
+    const qint64 oldTop = topLine;
+    logStore.append(text, stamps);
+    finishAppend(follow, oldTop);
+}
+
+void LogView::finishAppend(bool follow, qint64 oldTop)
+{
+    updateScrollBars();
+
+    if (follow) {
+        scrollToBottom();
+    } else {
+        // 保持当前看到的内容不动；若已被淘汰则停在最早的保留行
+        verticalScrollBar()->setValue(int(qBound<qint64>(0, oldTop - logStore.firstLineNumber(), INT_MAX)));
+        topLine = logStore.firstLineNumber() + verticalScrollBar()->value();
+    }
+    viewport()->update();
+}
+
+void LogView::clear()
+{
+    logStore.clear();
+    selectionAnchor = -1;
+    selectionEnd = -1;
+    maxLineWidth = 0;
+    topLine = logStore.firstLineNumber();
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+QString LogView::toPlainText() const
+{
+    if (stampMode == NoTimestamp) {
+        return logStore.toPlainText();
+    }
+
+    // 导出内容与显示一致，带时间戳前缀
+    QString text;
+    for (qint64 i = 0; i < logStore.lineCount(); ++i) {
+        text += displayLine(i);
+        text += QChar('\n');
+    }
+    return text;
+}
+
+void LogView::setRetentionLimits(qint64 maxLines, qint64 maxBytes)
+{
+    logStore.setLimits(maxLines, maxBytes);
+    updateScrollBars();
+    viewport()->update();
+}
+
+qint64 LogView::lineCount() const
+{
+    return logStore.lineCount();
+}
+
+const LogStore &LogView::store() const
+{
+    return logStore;
+}
+
+void LogView::setTimestampMode(TimestampMode mode)
+{
+    if (stampMode == mode) {
+        return;
+    }
+    stampMode = mode;
+    maxLineWidth = 0;
+    updateScrollBars();
+    viewport()->update();
+}
+
+LogView::TimestampMode LogView::timestampMode() const
+{
+    return stampMode;
+}
+
+void LogView::setTransmitReference(const LogView *view)
+{
+    transmitReference = view;
+    if (stampMode == DeltaTransmit) {
+        viewport()->update();
+    }
+}
+
+QString LogView::displayLine(qint64 index) const
+{
+    return timestampPrefix(index) + logStore.line(index);
+}
+
+QString LogView::timestampPrefix(qint64 index) const
+{
+    const qint64 timestampNs = stampMode == NoTimestamp ? -1 : logStore.lineTimestamp(index);
+    if (timestampNs < 0) {
+        return QString();
+    }
+
+    // 间隔以秒为单位，保留到微秒
+    const auto formatDelta = [](const QString &prefix, qint64 deltaNs) {
+        const qint64 us = qMax<qint64>(0, deltaNs) / 1000;
+        return QString("%1+%2.%3 ").arg(prefix).arg(us / 1000000).arg(us % 1000000, 6, 10, QChar('0'));
+    };
+
+    switch (stampMode) {
+    case AbsoluteTime: {
+        const qint64 wallNs = PerfMetrics::toWallClockNs(timestampNs);
+        return QDateTime::fromMSecsSinceEpoch(wallNs / 1000000).toString("yyyy-MM-dd hh:mm:ss.zzz")
+               + QString("%1 ").arg((wallNs / 1000) % 1000, 3, 10, QChar('0'));
+    }
+    case DeltaTransmit:
+        if (transmitReference && transmitReference != this) {
+            const qint64 transmitNs = transmitReference->store().timestampAtOrBefore(timestampNs);
+            return transmitNs < 0 ? QString("TX+- ") : formatDelta("TX", timestampNs - transmitNs);
+        }
+        Q_FALLTHROUGH();
+    case DeltaPrevious: {
+        const qint64 previousNs = logStore.lineTimestamp(index - 1);
+        return formatDelta(QString(), previousNs < 0 ? 0 : timestampNs - previousNs);
+    }
+    default:
+        return QString();
+    }
+}
+
+void LogView::copySelection()
+{
+    if (selectionAnchor < 0) {
+        return;
+    }
+
+    const qint64 first = logStore.firstLineNumber();
+    const qint64 from = qMax(qMin(selectionAnchor, selectionEnd), first);
+    const qint64 to = qMin(qMax(selectionAnchor, selectionEnd), first + logStore.lineCount() - 1);
+
+    QStringList lines;
+    for (qint64 line = from; line <= to; ++line) {
+        lines << displayLine(line - first);
+    }
+    QApplication::clipboard()->setText(lines.join('\n'));
+}
+
+void LogView::selectAll()
+{
+    if (logStore.lineCount() == 0) {
+        return;
+    }
+    selectionAnchor = logStore.firstLineNumber();
+    selectionEnd = selectionAnchor + logStore.lineCount() - 1;
+    viewport()->update();
+}
+
+void LogView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().base());
+
+    const QFontMetrics metrics = fontMetrics();
+    const int height = lineHeight();
+    const qint64 first = logStore.firstLineNumber();
+    const qint64 firstIndex = verticalScrollBar()->value();
+    const int x = TEXT_MARGIN - horizontalScrollBar()->value();
+    const qint64 selFrom = qMin(selectionAnchor, selectionEnd);
+    const qint64 selTo = qMax(selectionAnchor, selectionEnd);
+
+    // 只排版可见范围内的行
+    int widest = maxLineWidth;
+    const int count = visibleLineCount() + 1;
+    for (int i = 0; i < count && firstIndex + i < logStore.lineCount(); ++i) {
+        const qint64 globalLine = first + firstIndex + i;
+        const QString text = displayLine(firstIndex + i);
+        const int y = i * height;
+
+        if (selectionAnchor >= 0 && globalLine >= selFrom && globalLine <= selTo) {
+            painter.fillRect(0, y, viewport()->width(), height, palette().highlight());
+            painter.setPen(palette().highlightedText().color());
+        } else {
+            painter.setPen(palette().text().color());
+        }
+        painter.drawText(x, y + metrics.ascent(), text);
+        widest = qMax(widest, metrics.horizontalAdvance(text));
+    }
+
+    if (widest != maxLineWidth) {
+        // 水平滚动范围只随已显示过的最宽行增长，不必测量全部日志
+        maxLineWidth = widest;
+        QMetaObject::invokeMethod(this, [this]() { updateScrollBars(); }, Qt::QueuedConnection);
+    }
+}
+
+void LogView::resizeEvent(QResizeEvent *event)
+{
+    const bool follow = isAtBottom();
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+    if (follow) {
+        scrollToBottom();
+    }
+}
+
+void LogView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && logStore.lineCount() > 0) {
+        const qint64 line = lineAt(event->position().toPoint().y());
+        if ((event->modifiers() & Qt::ShiftModifier) && selectionAnchor >= 0) {
+            selectionEnd = line;
+        } else {
+            selectionAnchor = line;
+            selectionEnd = line;
+        }
+        viewport()->update();
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void LogView::mouseMoveEvent(QMouseEvent *event)
+{
+    if ((event->buttons() & Qt::LeftButton) && selectionAnchor >= 0) {
+        const int y = event->position().toPoint().y();
+        // 拖出视图上下边缘时自动滚动
+        if (y < 0) {
+            verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        } else if (y > viewport()->height()) {
+            verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        }
+        selectionEnd = lineAt(y);
+        viewport()->update();
+    }
+    QAbstractScrollArea::mouseMoveEvent(event);
+}
+
+void LogView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    if (event->matches(QKeySequence::SelectAll)) {
+        selectAll();
+        return;
+    }
+    if (event->key() == Qt::Key_Home && (event->modifiers() & Qt::ControlModifier)) {
+        verticalScrollBar()->setValue(0);
+        return;
+    }
+    if (event->key() == Qt::Key_End && (event->modifiers() & Qt::ControlModifier)) {
+        scrollToBottom();
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void LogView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *copyAction = menu.addAction("复制");
+    QAction *selectAllAction = menu.addAction("全选");
+    copyAction->setEnabled(selectionAnchor >= 0);
+    connect(copyAction, &QAction::triggered, this, &LogView::copySelection);
+    connect(selectAllAction, &QAction::triggered, this, &LogView::selectAll);
+    menu.exec(event->globalPos());
+}
+
+void LogView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        maxLineWidth = 0;
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+void LogView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    topLine = logStore.firstLineNumber() + verticalScrollBar()->value();
+    viewport()->update();
+}
+
+int LogView::lineHeight() const
+{
+    return qMax(1, fontMetrics().lineSpacing());
+}
+
+int LogView::visibleLineCount() const
+{
+    return qMax(1, viewport()->height() / lineHeight());
+}
+
+qint64 LogView::lineAt(int y) const
+{
+    const qint64 first = logStore.firstLineNumber();
+    const qint64 index = verticalScrollBar()->value() + qMax(0, y) / lineHeight();
+    return first + qBound<qint64>(0, index, qMax<qint64>(0, logStore.lineCount() - 1));
+}
+
+void LogView::updateScrollBars()
+{
+    const int visible = visibleLineCount();
+    const qint64 maximum = qMax<qint64>(0, logStore.lineCount() - visible);
+    verticalScrollBar()->setSingleStep(1);
+    verticalScrollBar()->setPageStep(visible);
+    verticalScrollBar()->setRange(0, int(qMin<qint64>(maximum, INT_MAX)));
+
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth() * 4);
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, maxLineWidth + 2 * TEXT_MARGIN - viewport()->width()));
+}
+
+void LogView::scrollToBottom()
+{
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    topLine = logStore.firstLineNumber() + verticalScrollBar()->value();
+}
+
+bool LogView::isAtBottom() const
+{
+    return verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
@@ -0,0 +1,81 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QString>
+#include "logstore.h"
+
+// 虚拟化日志视图，替代QTextBrowser显示收发日志
+// 数据保存在LogStore中，绘制时只取出并排版当前可见的若干行，
+// 日志总量再大，滚动和追加的开销都只与窗口高度有关。
+// 支持按行选择（鼠标拖动、Shift+点击、Ctrl+A）并用Ctrl+C复制。
+// 行时间戳只保存到达时刻的数值，绘制可见行时才按显示方式格式化，切换显示方式对已有日志立即生效。
+class LogView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    // 时间戳显示方式
+    enum TimestampMode {
+        NoTimestamp,
+        AbsoluteTime,   // 墙上时间，精确到微秒
+        DeltaPrevious,  // 与上一行的间隔
+        DeltaTransmit   // 与此前最近一次发送的间隔，未设置发送日志时同 DeltaPrevious
+    };
+
+    explicit LogView(QWidget *parent = nullptr);
+
+    // 追加文本，视图位于底部时自动滚动跟随；timestampNs 为新行的到达时刻（单调时钟），-1表示无时间戳
+    void appendText(const QString &text, qint64 timestampNs = -1);
+    void appendText(const QString &text, const QVector<LogTimestamp> &stamps);
+    void clear();
+    QString toPlainText() const;
+
+    // 保留上限，超出部分从最早的日志开始淘汰
+    void setRetentionLimits(qint64 maxLines, qint64 maxBytes);
+
+    qint64 lineCount() const;
+    const LogStore &store() const;
+
+    void setTimestampMode(TimestampMode mode);
+    TimestampMode timestampMode() const;
+    // DeltaTransmit 方式下作为发送时刻来源的日志视图
+    void setTransmitReference(const LogView *view);
+
+    // 按保留区内的下标取一行，带时间戳前缀
+    QString displayLine(qint64 index) const;
+
+public slots:
+    void copySelection();
+    void selectAll();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    LogStore logStore;
+    qint64 topLine;          // 视图顶部行的全局行号
+    qint64 selectionAnchor;  // 选择起止行的全局行号，-1表示无选择
+    qint64 selectionEnd;
+    int maxLineWidth;        // 已绘制过的最宽行，用于水平滚动范围
+    TimestampMode stampMode;
+    const LogView *transmitReference;
+
+    QString timestampPrefix(qint64 index) const;
+    void finishAppend(bool follow, qint64 oldTop);
+    int lineHeight() const;
+    int visibleLineCount() const;
+    qint64 lineAt(int y) const;
+    void updateScrollBars();
+    void scrollToBottom();
+    bool isAtBottom() const;
+};
+
+#endif // LOGVIEW_H
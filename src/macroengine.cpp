@@ -0,0 +1,531 @@
+#include "macroengine.h"
+#include "deadlinesleeper.h"
+#include "hexcodec.h"
+#include "perfmetrics.h"
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QStringList>
+#include <thread>
+
+static const qint64 SPIN_WINDOW_NS = 50 * 1000;             // 延时截止前最后50µs忙等
+static const qint64 MAX_SLEEP_SLICE_NS = 50 * 1000 * 1000;  // 单次休眠/等待上限，保证stop()及时返回
+static const qint64 MAX_DURATION_NS = 24LL * 3600 * 1000 * 1000 * 1000;  // 单步时间上限1天
+static const qsizetype MAX_CARRY_BYTES = 64 * 1024;        // 匹配后替下一个 wait 保留的数据上限
+
+// 数字加单位 us / ms / s，省略单位为 ms
+static bool parseDuration(const QString &token, qint64 *ns)
+{
+    int unitPos = 0;
+    while (unitPos < token.size() && (token.at(unitPos).isDigit() || token.at(unitPos) == '.')) {
+        ++unitPos;
+    }
+    bool ok = false;
+    const double value = token.left(unitPos).toDouble(&ok);
+    if (!ok) {
+        return false;
+    }
+
+    const QString unit = token.mid(unitPos).toLower();
+    double scale = 0;
+    if (unit.isEmpty() || unit == "ms") {
+        scale = 1e6;
+    } else if (unit == "us") {
+        scale = 1e3;
+    } else if (unit == "s") {
+        scale = 1e9;
+    } else {
+        return false;
+    }
+
+    const double result = value * scale;
+    if (result > double(MAX_DURATION_NS)) {
+        return false;
+    }
+    *ns = qint64(result + 0.5);
+    return true;
+}
+
+// 转义序列之外的文本按 UTF-8 编码
+static bool unescapeText(const QString &text, QByteArray *out, QString *errorString)
+{
+    QByteArray bytes;
+    QString plain;
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        if (c != '\\') {
+            plain += c;
+            continue;
+        }
+        if (i + 1 >= text.size()) {
+            *errorString = "末尾的 \\ 后缺少转义字符";
+            return false;
+        }
+
+        bytes += plain.toUtf8();
+        plain.clear();
+        const QChar escaped = text.at(++i);
+        switch (escaped.unicode()) {
+        case 'r': bytes += '\r'; break;
+        case 'n': bytes += '\n'; break;
+        case 't': bytes += '\t'; break;
+        case '\\': bytes += '\\'; break;
+        case ';': bytes += ';'; break;
+        case 'x': {
+            bool ok = false;
+            const QString digits = text.mid(i + 1, 2);
+            const int value = digits.toInt(&ok, 16);
+            if (digits.size() != 2 || !ok) {
+                *errorString = "\\x 后需要两位十六进制数";
+                return false;
+            }
+            bytes += char(value);
+            i += 2;
+            break;
+        }
+        default:
+            *errorString = QString("不支持的转义 \\%1").arg(escaped);
+            return false;
+        }
+    }
+    bytes += plain.toUtf8();
+    *out = bytes;
+    return true;
+}
+
+static bool decodeHex(const QString &text, QByteArray *out, QString *errorString)
+{
+    QByteArray bytes;
+    qsizetype errorOffset = 0;
+    if (!HexCodec::appendDecoded(text, bytes, &errorOffset)) {
+        *errorString = HexCodec::errorDetail(text, errorOffset);
+        return false;
+    }
+    *out = bytes;
+    return true;
+}
+
+// 分号和换行分隔步骤，反斜杠转义的字符原样留给步骤自己解析
+static QStringList splitStatements(const QString &source)
+{
+    QStringList statements;
+    QString current;
+    for (int i = 0; i < source.size(); ++i) {
+        const QChar c = source.at(i);
+        if (c == '\\' && i + 1 < source.size()) {
+            current += c;
+            current += source.at(++i);
+        } else if (c == ';' || c == '\n') {
+            statements << current;
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    statements << current;
+    return statements;
+}
+
+// 取出第一个空白前的部分，rest 为其后去掉首尾空白的部分
+static QString takeWord(const QString &text, QString *rest)
+{
+    int end = 0;
+    while (end < text.size() && !text.at(end).isSpace()) {
+        ++end;
+    }
+    *rest = text.mid(end).trimmed();
+    return text.left(end);
+}
+
+bool MacroProgram::compile(const QString &source, MacroProgram *program, QString *errorString)
+{
+    QVector<MacroStep> steps;
+    QVector<int> openLoops;
+    QString error;
+
+    const QStringList statements = splitStatements(source);
+    for (const QString &statement : statements) {
+        const QString text = statement.trimmed();
+        if (text.isEmpty() || text.startsWith('#')) {
+            continue;
+        }
+
+        MacroStep step;
+        step.text = text;
+        QString rest;
+        const QString keyword = takeWord(text, &rest).toLower();
+
+        if (keyword == "send" || keyword == "hex") {
+            step.type = MacroStep::Send;
+            if (rest.isEmpty()) {
+                error = "缺少发送内容";
+            } else if (keyword == "send") {
+                unescapeText(rest, &step.data, &error);
+            } else {
+                decodeHex(rest, &step.data, &error);
+            }
+        } else if (keyword == "wait" || keyword == "waithex") {
+            step.type = MacroStep::WaitFor;
+            QString pattern;
+            const QString duration = takeWord(rest, &pattern);
+            if (!parseDuration(duration, &step.durationNs)) {
+                error = "超时时间无效";
+            } else if (pattern.isEmpty()) {
+                error = "缺少等待的内容";
+            } else if (keyword == "wait") {
+                unescapeText(pattern, &step.data, &error);
+            } else {
+                decodeHex(pattern, &step.data, &error);
+            }
+        } else if (keyword == "delay") {
+            step.type = MacroStep::Delay;
+            if (!parseDuration(rest, &step.durationNs)) {
+                error = "延时时间无效";
+            }
+        } else if (keyword == "repeat") {
+            step.type = MacroStep::LoopBegin;
+            bool ok = true;
+            step.count = rest.isEmpty() ? 0 : rest.toInt(&ok);
+            if (!ok || step.count < 0 || (!rest.isEmpty() && step.count == 0)) {
+                error = "循环次数无效";
+            }
+            openLoops.append(int(steps.size()));
+        } else if (keyword == "end") {
+            step.type = MacroStep::LoopEnd;
+            if (openLoops.isEmpty()) {
+                error = "没有对应的 repeat";
+            } else {
+                step.jump = openLoops.takeLast();
+                steps[step.jump].jump = int(steps.size());
+            }
+        } else {
+            error = QString("未知的步骤 %1").arg(keyword);
+        }
+
+        if (error.isEmpty() && step.type == MacroStep::WaitFor && step.data.isEmpty()) {
+            error = "缺少等待的内容";
+        }
+        if (!error.isEmpty()) {
+            if (errorString) {
+                *errorString = QString("第%1步“%2”：%3").arg(steps.size() + 1).arg(text, error);
+            }
+            return false;
+        }
+        steps.append(step);
+    }
+
+    if (!openLoops.isEmpty()) {
+        if (errorString) {
+            *errorString = QString("第%1步“%2”：缺少对应的 end").arg(openLoops.last() + 1).arg(steps.at(openLoops.last()).text);
+        }
+        return false;
+    }
+    if (steps.isEmpty()) {
+        if (errorString) {
+            *errorString = "宏中没有任何步骤";
+        }
+        return false;
+    }
+
+    program->steps = steps;
+    return true;
+}
+
+void MacroStepStats::add(qint64 ns)
+{
+    minNs = runs == 0 ? ns : qMin(minNs, ns);
+    maxNs = qMax(maxNs, ns);
+    totalNs += ns;
+    ++runs;
+}
+
+MacroEngine::MacroEngine(QObject *parent)
+    : QObject(parent)
+    , engineThread(nullptr)
+    , stopRequested(false)
+    , serialManager(nullptr)
+    , currentRunId(0)
+    , matchArmed(false)
+    , carryAfterMatch(false)
+    , matchedAtNs(-1)
+    , lastReceivedNs(-1)
+{
+    PerfMetrics &metrics = PerfMetrics::instance();
+    waitLatencyHistogram = metrics.histogram("macro.wait_latency", "us", "宏 wait 步骤的应答延迟");
+    waitTimeoutCounter = metrics.counter("macro.wait_timeout", "次", "宏 wait 步骤超时次数");
+}
+
+MacroEngine::~MacroEngine()
+{
+    stop();
+}
+
+bool MacroEngine::start(SerialPortManager *manager, const MacroProgram &program)
+{
+    stop();
+    if (!manager || program.steps.isEmpty()) {
+        return false;
+    }
+
+    serialManager = manager;
+    currentProgram = program;
+    ++currentRunId;
+    stopRequested = false;
+    {
+        QMutexLocker locker(&statsMutex);
+        currentStats = MacroStats();
+        currentStats.steps.resize(program.steps.size());
+    }
+
+    serialManager->setReceiveObserver(this);
+    engineThread = QThread::create([this]() { run(); });
+    engineThread->start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void MacroEngine::stop()
+{
+    if (!engineThread) {
+        return;
+    }
+    stopRequested = true;
+    {
+        QMutexLocker locker(&matchMutex);
+        matchCondition.wakeAll();
+    }
+    serialManager->wakeBlockedSenders();
+    engineThread->wait();
+    delete engineThread;
+    engineThread = nullptr;
+    serialManager->setReceiveObserver(nullptr);
+}
+
+bool MacroEngine::isRunning() const
+{
+    return engineThread && engineThread->isRunning();
+}
+
+MacroStats MacroEngine::stats() const
+{
+    QMutexLocker locker(&statsMutex);
+    return currentStats;
+}
+
+void MacroEngine::received(const char *data, qint64 n)
+{
+    if (!matchArmed.load(std::memory_order_acquire)) {
+        return;
+    }
+    // 先取时刻，不把加锁的耗时算进应答延迟
+    const qint64 now = DeadlineSleeper::nowNs();
+
+    QMutexLocker locker(&matchMutex);
+    if (!matchArmed) {
+        return;
+    }
+    matchWindow.append(data, n);
+    lastReceivedNs = now;
+    if (matchedAtNs >= 0) {
+        // 已经匹配，替紧接着的下一个 wait 继续收集
+        if (matchWindow.size() > MAX_CARRY_BYTES) {
+            matchWindow.remove(0, matchWindow.size() - MAX_CARRY_BYTES);
+        }
+        return;
+    }
+    findMatch(now);
+}
+
+bool MacroEngine::findMatch(qint64 atNs)
+{
+    const qsizetype index = matchWindow.indexOf(matchPattern);
+    if (index >= 0) {
+        matchedAtNs = atNs;
+        if (carryAfterMatch) {
+            // 下一步也是 wait：匹配之后的数据留给它，同一段数据里连续的应答不会丢
+            matchWindow.remove(0, index + matchPattern.size());
+        } else {
+            matchArmed = false;
+            matchWindow.clear();
+        }
+        matchCondition.wakeAll();
+        return true;
+    }
+    // 只保留可能与下一段数据拼成匹配的末尾部分
+    const qsizetype keep = matchPattern.size() - 1;
+    if (matchWindow.size() > keep) {
+        matchWindow.remove(0, matchWindow.size() - keep);
+    }
+    return false;
+}
+
+void MacroEngine::armMatch(const QByteArray &pattern, bool carry)
+{
+    QMutexLocker locker(&matchMutex);
+    matchPattern = pattern;
+    matchWindow.clear();
+    matchedAtNs = -1;
+    carryAfterMatch = carry;
+    matchArmed = true;
+}
+
+void MacroEngine::continueMatch(const QByteArray &pattern, bool carry)
+{
+    QMutexLocker locker(&matchMutex);
+    if (!matchArmed) {
+        matchWindow.clear();
+    }
+    matchPattern = pattern;
+    matchedAtNs = -1;
+    carryAfterMatch = carry;
+    matchArmed = true;
+    // 上一个 wait 匹配之后已经收到的数据先查一遍，应答已经到了就不用再等
+    if (!matchWindow.isEmpty()) {
+        findMatch(lastReceivedNs);
+    }
+}
+
+qint64 MacroEngine::waitMatch(qint64 deadlineNs)
+{
+    QMutexLocker locker(&matchMutex);
+    while (matchedAtNs < 0 && !stopRequested) {
+        const qint64 remaining = deadlineNs - DeadlineSleeper::nowNs();
+        if (remaining <= 0) {
+            break;
+        }
+        QDeadlineTimer timer(Qt::PreciseTimer);
+        timer.setPreciseRemainingTime(0, qMin(remaining, MAX_SLEEP_SLICE_NS), Qt::PreciseTimer);
+        matchCondition.wait(&matchMutex, timer);
+    }
+    if (matchedAtNs < 0 || !carryAfterMatch) {
+        matchArmed = false;
+        matchWindow.clear();
+    }
+    return matchedAtNs;
+}
+
+bool MacroEngine::delayUntil(DeadlineSleeper &sleeper, qint64 deadlineNs)
+{
+    // 分片休眠以便及时响应停止请求，最后一段忙等
+    const qint64 sleepTarget = deadlineNs - SPIN_WINDOW_NS;
+    qint64 now = DeadlineSleeper::nowNs();
+    while (!stopRequested && now < sleepTarget) {
+        sleeper.sleepUntil(qMin(sleepTarget, now + MAX_SLEEP_SLICE_NS));
+        now = DeadlineSleeper::nowNs();
+    }
+    while (!stopRequested && now < deadlineNs) {
+        std::this_thread::yield();
+        now = DeadlineSleeper::nowNs();
+    }
+    return !stopRequested;
+}
+
+void MacroEngine::recordStep(int index, qint64 ns, bool timedOut)
+{
+    QMutexLocker locker(&statsMutex);
+    MacroStepStats &s = currentStats.steps[index];
+    if (timedOut) {
+        ++s.timeouts;
+    } else {
+        s.add(ns);
+    }
+}
+
+void MacroEngine::run()
+{
+    DeadlineSleeper sleeper;
+    const QVector<MacroStep> &steps = currentProgram.steps;
+    QVector<int> remaining(steps.size(), 0);   // 每个 repeat 剩余的循环次数
+    const qint64 startNs = DeadlineSleeper::nowNs();
+    int armedStep = -1;         // 已经开始收集数据的 wait 步骤
+    auto isWait = [&steps](int index) {
+        return index < steps.size() && steps.at(index).type == MacroStep::WaitFor;
+    };
+    int previousStep = -1;
+    qint64 previousStartNs = 0;
+    QString failure;
+
+    int pc = 0;
+    while (pc < steps.size() && !stopRequested) {
+        const MacroStep &step = steps.at(pc);
+        const qint64 stepStartNs = DeadlineSleeper::nowNs();
+
+        // 下一步是 wait 时在本步之前开始收集数据；本步也是 wait 时由它在匹配后接着收集
+        if (step.type != MacroStep::LoopEnd && step.type != MacroStep::WaitFor && isWait(pc + 1)) {
+            armMatch(steps.at(pc + 1).data, isWait(pc + 2));
+            armedStep = pc + 1;
+        }
+
+        int next = pc + 1;
+        switch (step.type) {
+        case MacroStep::Send: {
+            const qint64 bytesWritten = serialManager->sendData(step.data, &stopRequested);
+            if (bytesWritten == 0 && stopRequested) {
+                break;
+            }
+            // 返回0为发送队列已满、数据被丢弃，同样算失败
+            if (bytesWritten <= 0) {
+                failure = QString("第%1步“%2”发送失败：%3").arg(pc + 1).arg(step.text, serialManager->getErrorString());
+                break;
+            }
+            recordStep(pc, DeadlineSleeper::nowNs() - stepStartNs);
+            break;
+        }
+        case MacroStep::WaitFor: {
+            if (armedStep != pc) {
+                continueMatch(step.data, isWait(pc + 1));
+            }
+            armedStep = -1;
+            const qint64 matchedNs = waitMatch(stepStartNs + step.durationNs);
+            if (stopRequested) {
+                break;
+            }
+            if (matchedNs < 0) {
+                recordStep(pc, step.durationNs, true);
+                waitTimeoutCounter->add();
+                failure = QString("第%1步“%2”等待超时").arg(pc + 1).arg(step.text);
+                break;
+            }
+            const bool afterSend = previousStep == pc - 1 && pc > 0 && steps.at(pc - 1).type == MacroStep::Send;
+            const qint64 latency = qMax<qint64>(0, matchedNs - (afterSend ? previousStartNs : stepStartNs));
+            recordStep(pc, latency);
+            waitLatencyHistogram->record(quint64(latency / 1000));
+            break;
+        }
+        case MacroStep::Delay:
+            if (delayUntil(sleeper, stepStartNs + step.durationNs)) {
+                recordStep(pc, DeadlineSleeper::nowNs() - stepStartNs);
+            }
+            break;
+        case MacroStep::LoopBegin:
+            remaining[pc] = step.count;
+            break;
+        case MacroStep::LoopEnd: {
+            const int begin = step.jump;
+            if (steps.at(begin).count == 0 || --remaining[begin] > 0) {
+                next = begin + 1;
+            }
+            break;
+        }
+        }
+
+        if (!failure.isEmpty()) {
+            break;
+        }
+        previousStep = pc;
+        previousStartNs = stepStartNs;
+        pc = next;
+    }
+    matchArmed = false;
+
+    {
+        QMutexLocker locker(&statsMutex);
+        currentStats.elapsedNs = DeadlineSleeper::nowNs() - startNs;
+    }
+
+    if (!failure.isEmpty()) {
+        emit finished(currentRunId, false, failure);
+    } else if (stopRequested) {
+        emit finished(currentRunId, false, "宏已停止");
+    } else {
+        emit finished(currentRunId, true, "宏执行完成");
+    }
+}
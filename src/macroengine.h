@@ -0,0 +1,139 @@
+#ifndef MACROENGINE_H
+#define MACROENGINE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include "serialportmanager.h"
+
+class PerfHistogram;
+class PerfCounter;
+class DeadlineSleeper;
+
+// 宏的一步
+struct MacroStep {
+    enum Type { Send, WaitFor, Delay, LoopBegin, LoopEnd };
+
+    Type type;
+    QByteArray data;    // Send：发送的字节；WaitFor：等待出现的字节序列
+    qint64 durationNs;  // WaitFor：超时；Delay：延时
+    int count;          // LoopBegin：循环次数，0为一直循环
+    int jump;           // LoopBegin：对应 end 的下标；LoopEnd：对应 repeat 的下标
+    QString text;       // 源文本，报告中显示
+
+    MacroStep() : type(Send), durationNs(0), count(0), jump(-1) {}
+};
+
+// 编译后的宏
+// 源文本每行或每个分号一步（\; 表示分号本身），# 开头为注释：
+//   send <文本>          发送文本（UTF-8），支持 \r \n \t \\ \; \xHH 转义，不自动加结束符
+//   hex <十六进制>       发送十六进制字节
+//   wait <时间> <文本>    等待接收到文本，超时则宏失败
+//   waithex <时间> <十六进制>
+//   delay <时间>         延时
+//   repeat [次数] ... end 循环，省略次数为一直循环直到停止
+// 时间为数字加单位 us / ms / s，省略单位为 ms，如 500us、1.5ms、2s。
+struct MacroProgram {
+    QVector<MacroStep> steps;
+
+    // 失败时 errorString 说明出错的步骤，program 不变
+    static bool compile(const QString &source, MacroProgram *program, QString *errorString = nullptr);
+};
+
+// 每一步的耗时统计：send 为提交发送的耗时；wait 为应答延迟，紧跟在 send 之后时从提交发送算起，
+// 否则从开始等待算起；delay 为实际延时。repeat / end 不统计
+struct MacroStepStats {
+    quint64 runs;
+    quint64 timeouts;
+    qint64 minNs;
+    qint64 maxNs;
+    qint64 totalNs;
+
+    MacroStepStats() : runs(0), timeouts(0), minNs(0), maxNs(0), totalNs(0) {}
+    void add(qint64 ns);
+    double averageNs() const { return runs > 0 ? double(totalNs) / double(runs) : 0; }
+};
+
+struct MacroStats {
+    QVector<MacroStepStats> steps;  // 与 MacroProgram::steps 一一对应
+    qint64 elapsedNs;               // 宏开始到结束的总时间
+
+    MacroStats() : elapsedNs(0) {}
+};
+
+// 宏执行引擎
+// 与 SendScheduler 相同，在独立的最高优先级线程中按步骤执行：发送直接交给串口管理器的发送队列，
+// 延时按绝对截止时间休眠、最后一小段忙等，达到微秒级精度。
+// 等待应答通过 ReceiveObserver 挂在串口I/O线程的接收路径上，收到数据时立即匹配并记下时刻，
+// 不经过GUI线程和接收日志，应答延迟不受界面刷新影响。
+// wait 的前一步开始前就开始收集数据，发送后应答来得再快也不会错过；
+// 连续的 wait 之间数据不断开，前一个匹配之后收到的数据留给下一个 wait。
+// 运行期间占用串口管理器的接收旁路，stop() 时取消。同一时刻只运行一个宏，start() 会先停止正在运行的宏。
+class MacroEngine : public QObject, public ReceiveObserver
+{
+    Q_OBJECT
+
+public:
+    explicit MacroEngine(QObject *parent = nullptr);
+    ~MacroEngine();
+
+    bool start(SerialPortManager *manager, const MacroProgram &program);
+    void stop();
+    bool isRunning() const;
+    // 每次 start() 加1，用于区分 finished 信号来自哪一次运行
+    quint64 runId() const { return currentRunId; }
+
+    // 运行中也可调用，返回到目前为止的统计
+    MacroStats stats() const;
+    const MacroProgram &program() const { return currentProgram; }
+
+    // 在串口I/O线程中调用
+    void received(const char *data, qint64 n) override;
+
+signals:
+    // 在执行线程中发出；ok为false时 message 说明失败原因。
+    // 排队送达时可能已经开始了下一次运行，接收方应比较 runId 忽略过期的信号
+    void finished(quint64 runId, bool ok, const QString &message);
+
+private:
+    QThread *engineThread;
+    std::atomic<bool> stopRequested;
+    SerialPortManager *serialManager;
+    quint64 currentRunId;           // 只在 start() 中修改，执行线程运行期间不变
+    MacroProgram currentProgram;    // 运行期间不变
+
+    mutable QMutex statsMutex;
+    MacroStats currentStats;
+
+    // 应答匹配状态，由 matchMutex 保护；matchArmed 供I/O线程在未等待时快速跳过
+    QMutex matchMutex;
+    QWaitCondition matchCondition;
+    std::atomic<bool> matchArmed;
+    bool carryAfterMatch;           // 下一步也是 wait，匹配后继续收集数据
+    QByteArray matchPattern;
+    QByteArray matchWindow;         // 未匹配时为末尾 pattern.size()-1 字节，匹配后为之后收到的数据
+    qint64 matchedAtNs;             // 匹配时刻，-1为尚未匹配
+    qint64 lastReceivedNs;          // matchWindow 最后一次追加数据的时刻
+
+    PerfHistogram *waitLatencyHistogram;
+    PerfCounter *waitTimeoutCounter;
+
+    void run();
+    // 清空已收集的数据，开始等待 pattern；carry 为 true 时匹配后继续替下一个 wait 收集
+    void armMatch(const QByteArray &pattern, bool carry);
+    // 紧接在上一个 wait 之后：保留上一个匹配之后收到的数据并先在其中查找
+    void continueMatch(const QByteArray &pattern, bool carry);
+    // 在 matchWindow 中查找 matchPattern，调用时持有 matchMutex
+    bool findMatch(qint64 atNs);
+    // 返回匹配时刻，超时或停止返回-1
+    qint64 waitMatch(qint64 deadlineNs);
+    bool delayUntil(DeadlineSleeper &sleeper, qint64 deadlineNs);
+    void recordStep(int index, qint64 ns, bool timedOut = false);
+};
+
+#endif // MACROENGINE_H
@@ -15,26 +15,82 @@
 #include <QEvent>
 #include <QMouseEvent>
 #include <QResizeEvent>
+#include <QFileInfo>
+#include <QComboBox>
+#include <QProgressBar>
+#include <QProgressDialog>
+#include "captureview.h"
+#include "multiportwindow.h"
+#include "perfpanel.h"
+#include "hexcodec.h"
 #include <QRegularExpression>
+#include <memory>
+
+// 时间戳显示方式在配置文件中的名称，顺序与 comboBox_timestampMode 一致
+static const char *const TIMESTAMP_MODES[] = {"absolute", "delta", "tx"};
+// 流控方式在配置文件中的名称，顺序与 flowControl 下拉框一致
+static const char *const FLOW_CONTROLS[] = {"none", "rtscts", "xonxoff"};
 
 MainWindow::MainWindow(QWidget *parent): QMainWindow(parent), ui(new Ui::MainWindow){
     ui->setupUi(this);
-    this->serialPort = new QSerialPort;
+
+    // 串口收发放在独立的I/O线程中，GUI卡顿不影响驱动缓冲区的读取
+    this->ioThread = new QThread(this);
+    this->serialManager = new SerialPortManager;
+    this->serialManager->moveToThread(ioThread);
+    connect(ioThread, &QThread::finished, serialManager, &QObject::deleteLater);
+    ioThread->start(QThread::TimeCriticalPriority);
+
     this->configManager = new ConfigManager(this);
     this->buttonDatabase = new ButtonDatabase(this);
-    this->autoSendTimer = new QTimer(this);
+    this->buttonModel = new ButtonModel(buttonDatabase, this);
+    this->payloadCache = &profilePayloads[buttonDatabase->getActiveProfileName()];
+    this->sendScheduler = new SendScheduler(this);
+    this->macroEngine = new MacroEngine(this);
+    this->autoSendStatsTimer = new QTimer(this);
+    this->autoSendStatsTimer->setInterval(200);
+    this->autoSendStatsLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(autoSendStatsLabel);
+    this->txStatusTimer = new QTimer(this);
+    this->txStatusTimer->setInterval(500);
+    this->txStatusLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(txStatusLabel);
+    this->receiveCoalescer = new RenderCoalescer(30, this);
+    this->receiveDecoder = QStringDecoder(QStringDecoder::Utf8);
+    this->captureWriter = new CaptureWriter(this);
+    this->conversionThread = nullptr;
+    this->conversionCanceled = false;
+    this->sessionManager = new SessionManager(this);
+    this->multiPortWindow = nullptr;
+    this->virtualPorts = new VirtualPortProvider(this);
+    this->perfDumper = new PerfMetricsDumper(this);
+    this->chunkProcessHistogram = PerfMetrics::instance().chunkProcessHistogram();
+    this->renderFlushHistogram = PerfMetrics::instance().renderFlushHistogram();
+    this->frameCounter = PerfMetrics::instance().counter("rx.frames", "帧", "接收分帧输出的帧数");
+    this->frameIdleTimer = new QTimer(this);
+    this->frameIdleTimer->setSingleShot(true);
+    this->frameIdleTimer->setTimerType(Qt::PreciseTimer);
+
+    // 性能统计面板，默认隐藏，可停靠在主窗口两侧
+    this->perfDock = new QDockWidget("性能统计", this);
+    this->perfDock->setObjectName("perfDock");
+    this->perfDock->setWidget(new PerfPanel(perfDock));
+    addDockWidget(Qt::RightDockWidgetArea, perfDock);
+    this->perfDock->hide();
 
     // 初始化变量
-    sendCount = 0;
+    sentBytesBase = 0;
+    txRateLastBytes = 0;
     receiveCount = 0;
     isPauseSendLog = false;
     isPauseReceiveLog = false;
     isHexDisplay = false;
     isTimestampDisplay = true;
+    receiveLogAtLineStart = true;
 
     findFreePorts();
     loadAllConfigs();
-    setupTableWidget();
+    setupButtonTable();
 
     // 串口连接信号槽
     connect(ui->btnOpenPort, &QPushButton::clicked, this, &MainWindow::onOpenSerialPort);
@@ -43,18 +99,35 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent), ui(new Ui::MainWin
     // 为端口下拉框安装事件过滤器，实现点击时自动刷新
     ui->portName->installEventFilter(this);
 
-    connect(this->serialPort, SIGNAL(readyRead()), this, SLOT(recvMsg()));
-    connect(this->serialPort, SIGNAL(errorOccurred(QSerialPort::SerialPortError)),
-            this, SLOT(onSerialError(QSerialPort::SerialPortError)));
+    // 端口下拉框右键创建/移除虚拟串口
+    ui->portName->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->portName, &QComboBox::customContextMenuRequested, this, &MainWindow::onPortContextMenu);
+    connect(virtualPorts, &VirtualPortProvider::portsChanged, this, &MainWindow::refreshPorts);
+
+    connect(serialManager, &SerialPortManager::dataAvailable, this, &MainWindow::recvMsg);
+    connect(serialManager, &SerialPortManager::errorOccurred, this, &MainWindow::onSerialError);
+    connect(receiveCoalescer, &RenderCoalescer::flushed, this, &MainWindow::onReceiveLogFlushed);
+    // 接收日志"相对发送"的时间戳以发送日志中的发送时刻为准
+    ui->comLog_2->setTransmitReference(ui->comLog_1);
     connect(ui->btnSend, &QPushButton::clicked, [=](){
-        sendMsg(ui->message->toPlainText());
+        sendMsg(SendPayloadCache::InputMessage, ui->message->toPlainText());
     });
 
-    // TableWidget信号连接
-    connect(ui->tableWidget, SIGNAL(cellClicked(int,int)), this, SLOT(onTableCellClicked(int,int)));
+    // 按键表格信号连接
+    connect(ui->tableView, &QTableView::clicked, this, [this](const QModelIndex &index){
+        onTableCellClicked(index.row(), index.column());
+    });
     connect(ui->pushButton, SIGNAL(clicked()), this, SLOT(onRemoveRowClicked()));
     connect(ui->pushButton_7, SIGNAL(clicked()), this, SLOT(onAddRowClicked()));
 
+    // 命名配置：下拉框切换，右键新建/重命名/删除
+    refreshProfileList();
+    connect(ui->comboBox_profile, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onProfileSelected);
+    ui->comboBox_profile->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->comboBox_profile, &QComboBox::customContextMenuRequested, this, &MainWindow::onProfileContextMenu);
+    connect(buttonDatabase, &ButtonDatabase::profilesChanged, this, &MainWindow::refreshProfileList);
+    connect(buttonDatabase, &ButtonDatabase::activeProfileChanged, this, &MainWindow::refreshProfileList);
+
     // 日志管理按钮连接
     connect(ui->pushButton_1, SIGNAL(clicked()), this, SLOT(onClearSendLogClicked()));
     connect(ui->pushButton_2, SIGNAL(clicked()), this, SLOT(onSaveSendLogClicked()));
@@ -62,63 +135,138 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent), ui(new Ui::MainWin
     connect(ui->pushButton_4, SIGNAL(clicked()), this, SLOT(onClearReceiveLogClicked()));
     connect(ui->pushButton_5, SIGNAL(clicked()), this, SLOT(onSaveReceiveLogClicked()));
     connect(ui->pushButton_6, SIGNAL(clicked()), this, SLOT(onPauseReceiveLogClicked()));
+    connect(ui->pushButton_record, SIGNAL(clicked()), this, SLOT(onRecordClicked()));
+    connect(ui->pushButton_record, &QPushButton::customContextMenuRequested, this, &MainWindow::onRecordContextMenu);
+    connect(ui->pushButton_multiPort, SIGNAL(clicked()), this, SLOT(onMultiPortClicked()));
+    connect(ui->pushButton_perf, SIGNAL(clicked()), this, SLOT(onPerfPanelClicked()));
+    connect(perfDumper, &PerfMetricsDumper::errorOccurred, this, [this](const QString &errorString){
+        showStatusMessage(errorString, 10000);
+    });
+
+    // 录制状态提示
+    connect(captureWriter, &CaptureWriter::fileRotated, this, [this](const QString &filePath){
+        showStatusMessage(QString("录制文件：%1").arg(filePath), 5000);
+    });
+    connect(captureWriter, &CaptureWriter::errorOccurred, this, [this](const QString &errorString){
+        showStatusMessage(QString("录制错误：%1").arg(errorString), 10000);
+    });
 
     // 显示选项连接
     connect(ui->checkBox_1, &QCheckBox::toggled, [=](bool checked){
         isTimestampDisplay = checked;
+        updateTimestampMode();
+    });
+    connect(ui->comboBox_timestampMode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int){
+        updateTimestampMode();
     });
     connect(ui->checkBox_2, &QCheckBox::toggled, [=](bool checked){
         isHexDisplay = checked;
     });
+    connect(ui->comboBox_frameMode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int){
+        updateFrameOptions();
+    });
+    connect(frameIdleTimer, &QTimer::timeout, this, &MainWindow::onFrameIdleTimeout);
 
     // 自动发送功能连接
     connect(ui->checkBox_autoSend, &QCheckBox::toggled, [=](bool checked){
-        if(checked && serialPort->isOpen()){
+        if(checked && serialManager->isPortOpen()){
             autoSendData = ui->message->toPlainText();
-            if(!autoSendData.isEmpty()){
-                autoSendTimer->start(ui->spinBox_interval->value());
-            }
+            payloadCache->invalidateMessage(SendPayloadCache::AutoSendMessage);
+            startAutoSend();
         } else {
-            autoSendTimer->stop();
+            stopAutoSend();
         }
     });
 
-    connect(ui->spinBox_interval, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value){
-        if(autoSendTimer->isActive()){
-            autoSendTimer->setInterval(value);
+    // 周期或单位变化时按新周期重新开始
+    connect(ui->spinBox_interval, QOverload<int>::of(&QSpinBox::valueChanged), [=](int){
+        if(sendScheduler->isRunning()){
+            startAutoSend();
+        }
+    });
+    connect(ui->comboBox_intervalUnit, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int){
+        if(sendScheduler->isRunning()){
+            startAutoSend();
         }
     });
 
-    connect(autoSendTimer, &QTimer::timeout, this, &MainWindow::onAutoSendTimeout);
+    connect(sendScheduler, &SendScheduler::tickSent, this, &MainWindow::onAutoSendTick);
+    connect(sendScheduler, &SendScheduler::sendFailed, this, [this](const QString &errorString){
+        ui->checkBox_autoSend->setChecked(false);
+        showStatusMessage(QString("自动发送已停止：%1").arg(errorString), 10000);
+    });
+    connect(autoSendStatsTimer, &QTimer::timeout, this, &MainWindow::updateAutoSendStats);
+    connect(macroEngine, &MacroEngine::finished, this, &MainWindow::onMacroFinished);
+
+    // 发送数按实际写到驱动的字节统计，异步到达，定时刷新
+    connect(txStatusTimer, &QTimer::timeout, this, &MainWindow::updateTxStatus);
+    txRateClock.start();
+    txStatusTimer->start();
+
+    // 发送内容、16进制模式或结束符变化时，已编译的发送内容失效
+    connect(ui->message, &QTextEdit::textChanged, this, [this](){
+        payloadCache->invalidateMessage(SendPayloadCache::InputMessage);
+    });
+    // 自动发送运行中时重新编译并重启
+    connect(ui->checkBox_5, &QCheckBox::toggled, this, [this](bool checked){
+        payloadCache->setHexSend(checked);
+        if(sendScheduler->isRunning()){
+            startAutoSend();
+        }
+    });
+    connect(ui->checkBox_4, &QCheckBox::toggled, this, [this](bool checked){
+        payloadCache->setTerminator(checked, ui->lineEdit->text());
+        if(sendScheduler->isRunning()){
+            startAutoSend();
+        }
+    });
+    connect(ui->lineEdit, &QLineEdit::textChanged, this, [this](const QString &text){
+        payloadCache->setTerminator(ui->checkBox_4->isChecked(), text);
+        if(sendScheduler->isRunning()){
+            startAutoSend();
+        }
+    });
+    payloadCache->setHexSend(ui->checkBox_5->isChecked());
+    payloadCache->setTerminator(ui->checkBox_4->isChecked(), ui->lineEdit->text());
 
     // 为发送输入框安装事件过滤器，实现回车发送功能
     ui->message->installEventFilter(this);
 
     // 为快速配置输入框安装事件过滤器，实现回车配置功能
     ui->lineEdit_cig->installEventFilter(this);
-
-    // 延迟调整表格列宽，确保UI完全初始化后再调整
-    QTimer::singleShot(100, this, [this](){
-        adjustTableColumnWidths();
-    });
 }
 
 MainWindow::~MainWindow()
 {
     saveAllConfigs();
-
-    // 停止自动发送定时器
-    if(autoSendTimer && autoSendTimer->isActive()){
-        autoSendTimer->stop();
-    }
-
-    // 关闭串口
-    if(serialPort && serialPort->isOpen()){
-        serialPort->close();
+    // 延迟保存的配置立即写入磁盘
+    buttonDatabase->flush();
+
+    // 先停止自动发送线程和宏，再关闭串口
+    sendScheduler->stop();
+    macroEngine->stop();
+
+    // 多串口窗口引用各会话，先于会话释放
+    delete multiPortWindow;
+    delete sessionManager;
+
+    // 关闭串口并停止I/O线程，serialManager在线程结束后自动释放
+    serialManager->setCaptureWriter(nullptr);
+    serialManager->closePort();
+    ioThread->quit();
+    ioThread->wait();
+
+    // 写完剩余的录制数据
+    captureWriter->stop();
+
+    // 取消正在进行的录制文件转换
+    if(conversionThread){
+        conversionCanceled = true;
+        conversionThread->wait();
+        delete conversionThread;
     }
 
     // 清理资源（Qt的父子关系会自动清理，但显式清理更安全）
-    delete serialPort;
     delete configManager;
     delete buttonDatabase;
     delete ui;
@@ -135,7 +283,15 @@ void MainWindow::findFreePorts(){
         ui->portName->addItem(portInfo.portName());
     }
 
-    if (ports.isEmpty()){
+    // 虚拟串口以设备路径列出，QSerialPort可直接打开
+    const QStringList virtualNames = virtualPorts->portNames();
+    for (const QString &name : virtualNames){
+        ui->portName->addItem(name);
+        ui->portName->setItemData(ui->portName->count() - 1, "虚拟串口", Qt::ToolTipRole);
+    }
+    const int portCount = ports.size() + virtualNames.size();
+
+    if (portCount == 0){
         // 不显示警告弹窗，而是在端口列表中显示友好提示
         ui->portName->addItem("无可用端口");
         ui->portName->setEnabled(false);
@@ -143,7 +299,7 @@ void MainWindow::findFreePorts(){
         return;
     } else {
         ui->portName->setEnabled(true);
-        showStatusMessage(QString("检测到 %1 个可用串口").arg(ports.size()));
+        showStatusMessage(QString("检测到 %1 个可用串口").arg(portCount));
     }
 }
 
@@ -181,8 +337,8 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event){
                 return false; // 让默认处理继续，插入换行符
             } else {
                 // 检查是否启用了回车自动发送功能
-                if (ui->checkBox_3->isChecked() && serialPort->isOpen()) {
-                    sendMsg(ui->message->toPlainText());
+                if (ui->checkBox_3->isChecked() && serialManager->isPortOpen()) {
+                    sendMsg(SendPayloadCache::InputMessage, ui->message->toPlainText());
                     return true; // 阻止默认处理
                 }
                 // 如果没有启用回车自动发送，让默认处理继续（插入换行符）
@@ -222,7 +378,7 @@ void MainWindow::parseAndApplyQuickConfig(const QString &configText){
 
     if(parts.size() < 4){
         QMessageBox::warning(this, "配置错误",
-            "配置格式错误！\n正确格式：波特率,校验,数据位,停止位\n例如：9600,N,8,1");
+            "配置格式错误！\n正确格式：波特率,校验,数据位,停止位[,流控]\n例如：9600,N,8,1 或 115200,N,8,1,XON");
         return;
     }
 
@@ -246,9 +402,9 @@ void MainWindow::parseAndApplyQuickConfig(const QString &configText){
     if(parityStr == "N" || parityStr == "NONE"){
         parityText = "N(无)";
     } else if(parityStr == "E" || parityStr == "EVEN"){
-        parityText = "E(奇校验)";
+        parityText = "E(偶校验)";
     } else if(parityStr == "O" || parityStr == "ODD"){
-        parityText = "O(偶校验)";
+        parityText = "O(奇校验)";
     } else {
         QMessageBox::warning(this, "配置错误",
             "校验位格式错误！\n支持：N/NONE(无), E/EVEN(偶校验), O/ODD(奇校验)");
@@ -269,6 +425,23 @@ void MainWindow::parseAndApplyQuickConfig(const QString &configText){
         return;
     }
 
+    // 验证并设置流控（可省略，省略时不改变当前选择）
+    int flowIndex = ui->flowControl->currentIndex();
+    if(parts.size() >= 5){
+        QString flowStr = parts[4].trimmed().toUpper();
+        if(flowStr == "N" || flowStr == "NONE"){
+            flowIndex = 0;
+        } else if(flowStr == "RTS" || flowStr == "RTSCTS" || flowStr == "RTS/CTS" || flowStr == "HW"){
+            flowIndex = 1;
+        } else if(flowStr == "XON" || flowStr == "XONXOFF" || flowStr == "XON/XOFF" || flowStr == "SW"){
+            flowIndex = 2;
+        } else {
+            QMessageBox::warning(this, "配置错误",
+                "流控格式错误！\n支持：N/NONE(无), RTS/RTSCTS(硬件流控), XON/XONXOFF(软件流控)");
+            return;
+        }
+    }
+
     // 应用配置到界面
     // 设置波特率
     ui->baudRate->setCurrentText(QString::number(baudRate));
@@ -285,12 +458,15 @@ void MainWindow::parseAndApplyQuickConfig(const QString &configText){
     // 设置停止位
     ui->stopBits->setCurrentText(QString::number(stopBits));
 
-    showStatusMessage(QString("配置已应用：%1,%2,%3,%4")
-                     .arg(baudRate).arg(parityStr).arg(dataBits).arg(stopBits));
+    // 设置流控
+    ui->flowControl->setCurrentIndex(flowIndex);
+
+    showStatusMessage(QString("配置已应用：%1,%2,%3,%4,%5")
+                     .arg(baudRate).arg(parityStr).arg(dataBits).arg(stopBits).arg(ui->flowControl->currentText()));
 }
 
 void MainWindow::sendHexCommand(const QString &hexCommand){
-    if(!this->serialPort->isOpen()){
+    if(!serialManager->isPortOpen()){
         QMessageBox::warning(this, "警告", "串口未打开！");
         showStatusMessage("串口未打开");
         return;
@@ -301,17 +477,18 @@ void MainWindow::sendHexCommand(const QString &hexCommand){
         return;
     }
 
-    if(!validateHexInput(QString(cleanHex).remove(' '))){
-        QMessageBox::warning(this, "错误", "十六进制格式错误！");
+    QByteArray data;
+    qsizetype errorOffset = 0;
+    if(!decodeHexInput(cleanHex, &data, &errorOffset)){
+        QMessageBox::warning(this, "错误", QString("十六进制格式错误！\n%1").arg(HexCodec::errorDetail(cleanHex, errorOffset)));
         return;
     }
 
-    QByteArray data = QByteArray::fromHex(cleanHex.toLatin1());
     sendDataToPort(data, cleanHex, true);
 }
 
 void MainWindow::sendTextCommand(const QString &textCommand){
-    if(!this->serialPort->isOpen()){
+    if(!serialManager->isPortOpen()){
         QMessageBox::warning(this, "警告", "串口未打开！");
         showStatusMessage("串口未打开");
         return;
@@ -328,34 +505,28 @@ void MainWindow::sendTextCommand(const QString &textCommand){
 }
 
 void MainWindow::sendDataToPort(const QByteArray &data, const QString &displayText, bool isHex){
-    if(!this->serialPort->isOpen()){
+    if(!serialManager->isPortOpen()){
         return;
     }
 
-    qint64 bytesWritten = this->serialPort->write(data);
+    qint64 bytesWritten = serialManager->sendData(data);
     if(bytesWritten > 0){
-        sendCount += bytesWritten;
         updateStatistics();
-        showStatusMessage(QString("发送成功：%1 字节").arg(bytesWritten));
+        showStatusMessage(QString("已提交发送：%1 字节").arg(bytesWritten));
 
         if(!isPauseSendLog){
             QString displayMsg;
             if(isHex){
-                displayMsg = data.toHex(' ').toUpper();
+                displayMsg = HexCodec::toHexString(data);
             } else {
                 displayMsg = displayText;
             }
 
-            QString logEntry;
-            if(isTimestampDisplay){
-                logEntry = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") + " " + displayMsg + "\n";
-            } else {
-                logEntry = displayMsg + "\n";
-            }
-            ui->comLog_1->insertPlainText(logEntry);
+            // 时间戳只记录数值，由日志视图按显示方式格式化
+            ui->comLog_1->appendText(displayMsg + "\n", PerfMetrics::nowNs());
         }
     } else {
-        QString errorMsg = QString("数据发送失败！\n错误信息：%1").arg(this->serialPort->errorString());
+        QString errorMsg = QString("数据发送失败！\n错误信息：%1").arg(serialManager->getErrorString());
         QMessageBox::warning(this, "错误", errorMsg);
         showStatusMessage("发送失败");
     }
@@ -369,256 +540,301 @@ bool MainWindow::initSerialPort(){
         return false;
     }
 
-    // 如果串口已经打开，先关闭
-    if(this->serialPort->isOpen()){
-        this->serialPort->close();
-    }
-
-    // 设置串口参数
-    this->serialPort->setPortName(portName);
+    // 读取串口参数
+    int baudRate = ui->baudRate->currentText().toInt();
+    int dataBits = ui->dataBits->currentText().toInt();
+    int stopBits = ui->stopBits->currentText().toInt();
+    QString parity = ui->parity->currentText();
+    QString flowControl = FLOW_CONTROLS[qBound(0, ui->flowControl->currentIndex(), 2)];
 
-    // 尝试打开串口
-    if (!this->serialPort->open(QIODevice::ReadWrite)){
+    // 在I/O线程中打开串口（同步等待结果），已打开的串口会先关闭
+    if(!serialManager->openPort(portName, baudRate, dataBits, stopBits, parity, flowControl)){
         QString errorMsg = QString("串口 %1 打开失败！\n错误信息：%2")
                           .arg(portName)
-                          .arg(this->serialPort->errorString());
+                          .arg(serialManager->getErrorString());
         QMessageBox::warning(this, "错误", errorMsg);
         return false;
     }
 
-    // 设置波特率
-    int baudRate = ui->baudRate->currentText().toInt();
-    if(!this->serialPort->setBaudRate(baudRate)){
-        QMessageBox::warning(this, "错误", "设置波特率失败！");
-        this->serialPort->close();
-        return false;
-    }
-
-    // 设置数据位
-    int dataBits = ui->dataBits->currentText().toInt();
-    QSerialPort::DataBits dataBitsEnum;
-    switch(dataBits){
-        case 5: dataBitsEnum = QSerialPort::Data5; break;
-        case 6: dataBitsEnum = QSerialPort::Data6; break;
-        case 7: dataBitsEnum = QSerialPort::Data7; break;
-        case 8: dataBitsEnum = QSerialPort::Data8; break;
-        default: dataBitsEnum = QSerialPort::Data8; break;
-    }
-    this->serialPort->setDataBits(dataBitsEnum);
-
-    // 设置停止位
-    int stopBits = ui->stopBits->currentText().toInt();
-    QSerialPort::StopBits stopBitsEnum = (stopBits == 2) ? QSerialPort::TwoStop : QSerialPort::OneStop;
-    this->serialPort->setStopBits(stopBitsEnum);
-
-    // 设置校验位
-    QString parity = ui->parity->currentText();
-    QSerialPort::Parity parityEnum;
-    if(parity == "EvenParity"){
-        parityEnum = QSerialPort::EvenParity;
-    }else if(parity == "OddParity"){
-        parityEnum = QSerialPort::OddParity;
-    }else{
-        parityEnum = QSerialPort::NoParity;
-    }
-    this->serialPort->setParity(parityEnum);
-
-    // 设置流控制
-    this->serialPort->setFlowControl(QSerialPort::NoFlowControl);
-
-    // 清空缓冲区
-    this->serialPort->clear();
-
+    // 空闲分帧的默认间隔随波特率变化，重新打开时从新的帧开始
+    updateFrameOptions();
     return true;
 }
 //向串口发送信息
-void MainWindow::sendMsg(const QString &msg){
-    if(!this->serialPort->isOpen()){
+void MainWindow::sendMsg(SendPayloadCache::MessageSlot slot, const QString &msg){
+    if(!serialManager->isPortOpen()){
         QMessageBox::warning(this, "警告", "串口未打开！");
         showStatusMessage("串口未打开");
         return;
     }
 
-    QString cleanMsg = msg.trimmed();
-    if(cleanMsg.isEmpty()){
+    // 内容未变化时直接使用上次编译的结果（负载 + 回车换行）
+    const SendPayload &payload = payloadCache->message(slot, msg);
+    switch(payload.status){
+    case SendPayload::Empty:
         QMessageBox::information(this, "提示", "发送内容不能为空！");
         return;
+    case SendPayload::InvalidHex:
+        QMessageBox::warning(this, "错误", QString("十六进制格式错误！\n%1\n请输入有效的十六进制字符（0-9, A-F），且长度为偶数。")
+                             .arg(payload.errorString));
+        return;
+    case SendPayload::InvalidTerminator:
+        QMessageBox::warning(this, "错误", QString("回车字符格式错误！\n%1\n请输入有效的十六进制字符。")
+                             .arg(payload.errorString));
+        return;
+    case SendPayload::Ok:
+        break;
     }
 
-    QByteArray data;
-
-    if(ui->checkBox_5->isChecked()){ // 16进制发送
-        if(!validateHexInput(cleanMsg)){
-            QMessageBox::warning(this, "错误", "十六进制格式错误！\n请输入有效的十六进制字符（0-9, A-F），且长度为偶数。");
-            return;
-        }
-        data = QByteArray::fromHex(cleanMsg.toLatin1());
-    } else {
-        // 简化：直接使用UTF-8编码
-        data = cleanMsg.toUtf8();
-    }
-
-    // 添加回车换行
-    if(ui->checkBox_4->isChecked()){
-        QString endChars = ui->lineEdit->text().trimmed();
-        if(!endChars.isEmpty()){
-            if(!validateHexInput(endChars)){
-                QMessageBox::warning(this, "错误", "回车字符格式错误！\n请输入有效的十六进制字符。");
-                return;
-            }
-            data.append(QByteArray::fromHex(endChars.toLatin1()));
-        } else {
-            // 如果没有设置自定义回车字符，使用默认的回车换行
-            data.append(QByteArray::fromHex("0D0A")); // CR LF
-        }
-    }
-
-    qint64 bytesWritten = this->serialPort->write(data);
+    qint64 bytesWritten = serialManager->sendData(payload.bytes);
     if(bytesWritten > 0){
-        sendCount += bytesWritten;
         updateStatistics();
-        showStatusMessage(QString("发送成功：%1 字节").arg(bytesWritten));
-
-        if(!isPauseSendLog){
-            QString displayMsg;
-            if(isHexDisplay){
-                displayMsg = data.toHex(' ').toUpper();
-            } else {
-                displayMsg = cleanMsg;
-            }
-
-            QString logEntry;
-            if(isTimestampDisplay){
-                logEntry = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") + " " + displayMsg + "\n";
-            } else {
-                logEntry = displayMsg + "\n";
-            }
-            ui->comLog_1->insertPlainText(logEntry);
-        }
+        showStatusMessage(QString("已提交发送：%1 字节").arg(bytesWritten));
+        appendSendLog(payload);
     } else {
-        QString errorMsg = QString("数据发送失败！\n错误信息：%1").arg(this->serialPort->errorString());
+        QString errorMsg = QString("数据发送失败！\n错误信息：%1").arg(serialManager->getErrorString());
         QMessageBox::warning(this, "错误", errorMsg);
         showStatusMessage("发送失败");
     }
 }
 //接受来自串口的信息
 void MainWindow::recvMsg(){
-    QByteArray newData = this->serialPort->readAll();
+    const qint64 start = PerfMetrics::nowNs();
+
+    // 从I/O线程的环形缓冲区中取出当前积累的全部数据，连同每段的到达时刻
+    receiveChunks.clear();
+    QByteArray newData = serialManager->readAll(&receiveChunks);
     if(newData.isEmpty()) return;
 
     receiveCount += newData.size();
     updateStatistics();
     showStatusMessage(QString("接收：%1 字节").arg(newData.size()));
 
-    if (!isPauseReceiveLog) {
-        // 实时显示模式：立即显示接收到的数据，不使用缓存
-        displayCompleteMessage(newData);
+    if (isPauseReceiveLog) {
+        // 暂停期间的数据不显示，恢复后从新的帧开始
+        frameAssembler.reset();
+        receiveDecoder.resetState();
+    } else if (frameAssembler.options().mode == FrameOptions::None) {
+        // 格式化后交给渲染合并器，按帧率批量刷新到界面
+        displayCompleteMessage(newData, receiveChunks);
+    } else {
+        displayFrames(newData, receiveChunks);
     }
+    chunkProcessHistogram->record(quint64(PerfMetrics::nowNs() - start) / 1000);
 }
 
-void MainWindow::displayCompleteMessage(const QByteArray &message){
-    // 使用UTF-8解码消息
-    QString displayMsg = QString::fromUtf8(message);
+void MainWindow::displayCompleteMessage(const QByteArray &data, const QVector<SerialPortManager::ReceiveChunk> &chunks){
+    // 按I/O线程的读取边界逐块显示，每块开始的行带该块的到达时刻
+    qsizetype offset = 0;
+    for(const SerialPortManager::ReceiveChunk &chunk : chunks){
+        // 使用UTF-8解码，被读取边界拆开的多字节字符留到下一块
+        QString logEntry = receiveDecoder.decode(QByteArrayView(data.constData() + offset, chunk.size));
+        offset += chunk.size;
+
+        // 移除回车符，避免显示问题，但保留换行符
+        logEntry.remove(QChar('\r'));
+        if(logEntry.isEmpty()){
+            continue;
+        }
 
-    // 移除回车符，避免显示问题，但保留换行符
-    displayMsg.remove(QChar('\r'));
+        // 显示时间戳时每块另起一行，保证每块都有自己的时间戳
+        if(isTimestampDisplay && !receiveLogAtLineStart){
+            logEntry.prepend(QChar('\n'));
+        }
+        receiveLogAtLineStart = logEntry.endsWith('\n');
+        receiveCoalescer->append(logEntry, chunk.arrivalNs);
+    }
+}
 
-    // 实时显示：保持原始格式
-    QString logEntry;
-    if (isTimestampDisplay) {
-        // 每次接收都立即添加时间戳
-        QDateTime currentTime = QDateTime::currentDateTime();
-        QString timestamp = currentTime.toString("yyyy-MM-dd hh:mm:ss");
+void MainWindow::displayFrames(const QByteArray &data, const QVector<SerialPortManager::ReceiveChunk> &chunks){
+    // 按I/O线程的读取边界逐段送入分帧，完整的帧格式化后连同时间戳交给渲染合并器
+    const FrameAssembler::FrameHandler handler = [this](QByteArrayView frame, qint64 timestampNs, bool complete){
+        appendFrameEntry(frame, timestampNs, complete);
+    };
 
-        // 如果接收窗口不为空且不以换行符结尾，先添加换行符
-        if (!ui->comLog_2->toPlainText().isEmpty() && !ui->comLog_2->toPlainText().endsWith('\n')) {
-            logEntry = "\n" + timestamp + " " + displayMsg;
-        } else {
-            logEntry = timestamp + " " + displayMsg;
-        }
+    qsizetype offset = 0;
+    for(const SerialPortManager::ReceiveChunk &chunk : chunks){
+        frameAssembler.feed(data.constData() + offset, chunk.size, chunk.arrivalNs, handler);
+        offset += chunk.size;
+    }
+    scheduleFrameFlush();
+}
+
+void MainWindow::appendFrameEntry(QByteArrayView frame, qint64 timestampNs, bool complete){
+    frameCounter->add();
+
+    // 每帧独占一行，时间戳为帧首字节的到达时刻
+    QString entry;
+    if(!receiveLogAtLineStart){
+        entry += QChar('\n');
+        receiveLogAtLineStart = true;
+    }
+
+    if(isHexDisplay){
+        entry += HexCodec::toHexString(frame.data(), frame.size());
     } else {
-        logEntry = displayMsg;
+        QString text = QString::fromUtf8(frame);
+        text.remove(QChar('\r'));
+        while(text.endsWith(QChar('\n'))){
+            text.chop(1);
+        }
+        entry += text;
     }
+    if(!complete){
+        // 超时、超长截断或长度字段非法
+        entry += " [未完整]";
+    }
+    entry += QChar('\n');
+    receiveCoalescer->append(entry, timestampNs);
+}
 
-    ui->comLog_2->insertPlainText(logEntry);
+void MainWindow::scheduleFrameFlush(){
+    const qint64 deadline = frameAssembler.idleDeadlineNs();
+    if(deadline < 0){
+        frameIdleTimer->stop();
+        return;
+    }
+    const qint64 remainingNs = deadline - PerfMetrics::nowNs();
+    frameIdleTimer->start(int(qMax<qint64>(0, (remainingNs + 999999) / 1000000)));
+}
 
-    // 自动滚动到底部
-    ui->comLog_2->moveCursor(QTextCursor::End);
+void MainWindow::onFrameIdleTimeout(){
+    frameAssembler.flushIfIdle(PerfMetrics::nowNs(), [this](QByteArrayView frame, qint64 timestampNs, bool complete){
+        appendFrameEntry(frame, timestampNs, complete);
+    });
+    scheduleFrameFlush();
 }
 
-// 缓存处理函数已移除，改为实时显示
+void MainWindow::updateFrameOptions(){
+    const SerialPortConfig config = buttonDatabase->getSerialConfig();
 
-void MainWindow::onSerialError(QSerialPort::SerialPortError error){
-    if(error == QSerialPort::NoError){
-        return;
+    FrameOptions options;
+    options.mode = FrameOptions::Mode(qMax(0, ui->comboBox_frameMode->currentIndex()));
+    if(!HexCodec::decode(config.frameDelimiter.toLatin1(), &options.delimiter) || options.delimiter.isEmpty()){
+        options.delimiter = "\n";
     }
+    options.fixedLength = config.frameLength;
+    options.lengthOffset = config.frameLengthOffset;
+    options.lengthBytes = config.frameLengthBytes;
+    options.lengthBigEndian = config.frameLengthBigEndian;
+    options.lengthAdjust = config.frameLengthAdjust;
+    options.idleGapNs = config.frameIdleMicroseconds > 0 ?
+        qint64(config.frameIdleMicroseconds) * 1000 :
+        FrameOptions::modbusIdleGapNs(ui->baudRate->currentText().toInt());
+    options.timeoutNs = qint64(config.frameTimeoutMs) * 1000000;
+
+    // 切换前先输出已收到的部分
+    frameAssembler.flush([this](QByteArrayView frame, qint64 timestampNs, bool complete){
+        appendFrameEntry(frame, timestampNs, complete);
+    });
+    frameAssembler.setOptions(options);
+    frameIdleTimer->stop();
+}
 
-    QString errorMsg;
-    switch(error){
-        case QSerialPort::DeviceNotFoundError:
-            errorMsg = "设备未找到";
-            break;
-        case QSerialPort::PermissionError:
-            errorMsg = "权限错误，设备可能被其他程序占用";
-            break;
-        case QSerialPort::OpenError:
-            errorMsg = "设备打开失败";
-            break;
-        case QSerialPort::WriteError:
-            errorMsg = "数据写入失败";
-            break;
-        case QSerialPort::ReadError:
-            errorMsg = "数据读取失败";
-            break;
-        case QSerialPort::ResourceError:
-            errorMsg = "设备资源不可用，设备可能被意外移除";
-            break;
-        case QSerialPort::UnsupportedOperationError:
-            errorMsg = "不支持的操作";
-            break;
-        case QSerialPort::TimeoutError:
-            errorMsg = "操作超时";
-            break;
-        default:
-            errorMsg = QString("未知错误 (错误代码: %1)").arg(error);
-            break;
+void MainWindow::updateTimestampMode(){
+    // 时间戳在读取时已记录，切换显示方式对已有日志同样生效
+    LogView::TimestampMode mode = LogView::NoTimestamp;
+    if(ui->checkBox_1->isChecked()){
+        mode = LogView::TimestampMode(LogView::AbsoluteTime + qMax(0, ui->comboBox_timestampMode->currentIndex()));
     }
+    ui->comLog_1->setTimestampMode(mode);
+    ui->comLog_2->setTimestampMode(mode);
+}
+
+void MainWindow::onReceiveLogFlushed(const QString &text, const QVector<LogTimestamp> &stamps){
+    // 一帧只做一次追加，视图位于底部时自动跟随滚动
+    const qint64 start = PerfMetrics::nowNs();
+    ui->comLog_2->appendText(text, stamps);
+    renderFlushHistogram->record(quint64(PerfMetrics::nowNs() - start) / 1000);
+}
+
+// 缓存处理函数已移除，改为实时显示
+
+void MainWindow::onSerialError(const QString &errorString){
+    // 错误码到提示文字的转换由SerialPortManager完成
+    // 先关闭串口再弹窗，避免模态对话框期间继续触发错误
+    serialManager->closePort();
 
     QMessageBox::critical(this, "串口错误",
-                         QString("串口通信发生错误：\n%1\n\n串口将被关闭。").arg(errorMsg));
+                         QString("串口通信发生错误：\n%1\n\n串口将被关闭。").arg(errorString));
 
-    // 关闭串口并更新UI状态
-    if(serialPort->isOpen()){
-        serialPort->close();
-    }
     ui->btnOpenPort->setEnabled(true);
     ui->btnClosePort->setEnabled(false);
     ui->btnSend->setEnabled(false);
 }
 
-void MainWindow::onAutoSendTimeout(){
-    if(!autoSendData.isEmpty() && serialPort && serialPort->isOpen()){
-        sendMsg(autoSendData);
-    } else if(autoSendData.isEmpty()){
-        // 如果数据为空，停止自动发送
-        autoSendTimer->stop();
+void MainWindow::appendSendLog(const SendPayload &payload){
+    if(isPauseSendLog) return;
+
+    const QString &displayMsg = isHexDisplay ? payload.hexText : payload.text;
+
+    ui->comLog_1->appendText(displayMsg + "\n", PerfMetrics::nowNs());
+}
+
+void MainWindow::startAutoSend(){
+    sendScheduler->stop();
+    updateAutoSendStats();
+
+    const SendPayload &payload = payloadCache->message(SendPayloadCache::AutoSendMessage, autoSendData);
+    if(!payload.isValid()){
+        const QString reason = payload.status == SendPayload::Empty ? QString("发送数据为空") : payload.errorString;
         ui->checkBox_autoSend->setChecked(false);
-        showStatusMessage("自动发送已停止：发送数据为空");
+        showStatusMessage(QString("自动发送已停止：%1").arg(reason));
+        return;
+    }
+
+    // 单位：0 = ms，1 = µs
+    const qint64 unitNs = ui->comboBox_intervalUnit->currentIndex() == 0 ? 1000000 : 1000;
+    const qint64 periodNs = qint64(ui->spinBox_interval->value()) * unitNs;
+    sendScheduler->start(serialManager, payload.bytes, periodNs);
+    autoSendStatsTimer->start();
+}
+
+void MainWindow::stopAutoSend(){
+    sendScheduler->stop();
+    updateAutoSendStats();
+    autoSendStatsTimer->stop();
+}
+
+void MainWindow::onAutoSendTick(qint64 bytes){
+    // 周期不小于 SendScheduler::NotifyThresholdNs 时逐次记录，与手动发送一致
+    updateStatistics();
+    showStatusMessage(QString("已提交发送：%1 字节").arg(bytes));
+    appendSendLog(payloadCache->message(SendPayloadCache::AutoSendMessage, autoSendData));
+}
+
+static QString formatDurationNs(double ns){
+    if(ns < 1000000.0){
+        return QString("%1µs").arg(ns / 1000.0, 0, 'f', 1);
     }
+    return QString("%1ms").arg(ns / 1000000.0, 0, 'f', 3);
+}
+
+void MainWindow::updateAutoSendStats(){
+    const SchedulerStats stats = sendScheduler->stats();
+    if(stats.ticks == 0){
+        autoSendStatsLabel->clear();
+        return;
+    }
+
+    autoSendStatsLabel->setText(QString("自动发送 周期：%1 (目标 %2)  抖动P99：%3  错过：%4")
+                                .arg(formatDurationNs(stats.averagePeriodNs))
+                                .arg(formatDurationNs(stats.periodNs))
+                                .arg(formatDurationNs(stats.jitterPercentileNs(99)))
+                                .arg(stats.missedDeadlines));
 }
 
 // =====================================================================================
-// TableWidget右键菜单功能实现
+// 按键表格右键菜单功能实现
 void MainWindow::onTableContextMenu(const QPoint &pos){
-    // 获取点击位置的行列
-    int row = ui->tableWidget->rowAt(pos.y());
-    int col = ui->tableWidget->columnAt(pos.x());
+    // 获取点击位置的格子
+    QModelIndex index = ui->tableView->indexAt(pos);
 
     // 如果点击在有效区域外，不显示菜单
-    if(row < 0 || col < 0) return;
+    if(!index.isValid()) return;
 
     // 设置当前选中的单元格
-    ui->tableWidget->setCurrentCell(row, col);
+    ui->tableView->setCurrentIndex(index);
 
     QMenu contextMenu(this);
 
@@ -628,12 +844,12 @@ void MainWindow::onTableContextMenu(const QPoint &pos){
     connect(editAction, &QAction::triggered, this, &MainWindow::onEditButtonData);
     connect(deleteAction, &QAction::triggered, this, &MainWindow::onDeleteButtonData);
 
-    contextMenu.exec(ui->tableWidget->mapToGlobal(pos));
+    contextMenu.exec(ui->tableView->viewport()->mapToGlobal(pos));
 }
 
 void MainWindow::onEditButtonData(){
-    int row = ui->tableWidget->currentRow();
-    int col = ui->tableWidget->currentColumn();
+    int row = ui->tableView->currentIndex().row();
+    int col = ui->tableView->currentIndex().column();
 
     if(row < 0 || col < 0) return;
 
@@ -654,6 +870,15 @@ void MainWindow::onEditButtonData(){
     layout->addWidget(remarkLabel);
     layout->addWidget(remarkEdit);
 
+    // 按键类型：发送指令或运行宏
+    QLabel *buttonTypeLabel = new QLabel("按键类型:");
+    QComboBox *buttonTypeCombo = new QComboBox();
+    buttonTypeCombo->addItem("指令", ButtonData::CommandButton);
+    buttonTypeCombo->addItem("宏", ButtonData::MacroButton);
+    buttonTypeCombo->setCurrentIndex(currentData.type == ButtonData::MacroButton ? 1 : 0);
+    layout->addWidget(buttonTypeLabel);
+    layout->addWidget(buttonTypeCombo);
+
     // 数据类型选择
     QLabel *typeLabel = new QLabel("指令类型:");
     QCheckBox *hexCheckBox = new QCheckBox("16进制指令");
@@ -667,9 +892,13 @@ void MainWindow::onEditButtonData(){
     layout->addWidget(commandLabel);
     layout->addWidget(commandEdit);
 
-    // 根据类型更新标签文本
-    auto updateCommandLabel = [commandLabel, hexCheckBox]() {
-        if (hexCheckBox->isChecked()) {
+    // 根据类型更新标签文本，宏自己用 send / hex 区分字符和16进制
+    auto updateCommandLabel = [commandLabel, hexCheckBox, buttonTypeCombo]() {
+        const bool isMacro = buttonTypeCombo->currentData().toInt() == ButtonData::MacroButton;
+        hexCheckBox->setEnabled(!isMacro);
+        if (isMacro) {
+            commandLabel->setText("宏 (如 repeat 10; send AT\\r\\n; wait 200ms OK; delay 5ms; end):");
+        } else if (hexCheckBox->isChecked()) {
             commandLabel->setText("按键指令 (16进制):");
         } else {
             commandLabel->setText("按键指令 (字符):");
@@ -677,6 +906,7 @@ void MainWindow::onEditButtonData(){
     };
 
     connect(hexCheckBox, &QCheckBox::toggled, updateCommandLabel);
+    connect(buttonTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), updateCommandLabel);
     updateCommandLabel(); // 初始化标签
 
     // 按钮
@@ -691,6 +921,7 @@ void MainWindow::onEditButtonData(){
         QString remark = remarkEdit->text().trimmed();
         QString command = commandEdit->text().trimmed();
         bool isHexCommand = hexCheckBox->isChecked();
+        bool isMacro = buttonTypeCombo->currentData().toInt() == ButtonData::MacroButton;
 
         // 验证是否至少填写了备注或指令
         if(remark.isEmpty() && command.isEmpty()){
@@ -698,9 +929,18 @@ void MainWindow::onEditButtonData(){
             return;
         }
 
+        // 宏编译一遍检查语法
+        QString macroError;
+        MacroProgram program;
+        if(!command.isEmpty() && isMacro && !MacroProgram::compile(command, &program, &macroError)){
+            QMessageBox::warning(&dialog, "格式错误", QString("宏无法编译！\n%1").arg(macroError));
+            return;
+        }
+
         // 验证指令格式
-        if(!command.isEmpty() && isHexCommand && !validateHexInput(QString(command).remove(' '))){
-            QMessageBox::warning(&dialog, "格式错误", "请输入有效的十六进制指令！");
+        qsizetype errorOffset = 0;
+        if(!command.isEmpty() && !isMacro && isHexCommand && !decodeHexInput(command, nullptr, &errorOffset)){
+            QMessageBox::warning(&dialog, "格式错误", QString("请输入有效的十六进制指令！\n%1").arg(HexCodec::errorDetail(command, errorOffset)));
             return;
         }
 
@@ -712,40 +952,19 @@ void MainWindow::onEditButtonData(){
         QString remark = remarkEdit->text().trimmed();
         QString command = commandEdit->text().trimmed();
         bool isHexCommand = hexCheckBox->isChecked();
+        ButtonData::Type type = ButtonData::Type(buttonTypeCombo->currentData().toInt());
 
-        // 保存到数据库
-        buttonDatabase->setButtonData(row, col, remark, command, isHexCommand);
+        // 保存到数据库，表格模型只刷新这一个格子
+        buttonDatabase->setButtonData(row, col, remark, command, isHexCommand, type);
 
         // 更新统计
         updateStatistics();
-
-        // 更新界面显示
-        QTableWidgetItem *item = ui->tableWidget->item(row, col);
-        if(!item){
-            item = new QTableWidgetItem();
-            ui->tableWidget->setItem(row, col, item);
-        }
-
-        // 显示备注在单元格中
-        item->setText(remark);
-        item->setTextAlignment(Qt::AlignCenter);
-
-        // 根据是否有指令设置背景色（适配黑色主题）
-        if(!command.isEmpty()){
-            // 有指令的按键使用浅蓝色背景
-            item->setBackground(QBrush(QColor(173, 216, 230))); // 浅蓝色
-            item->setForeground(QBrush(QColor(0, 0, 0))); // 黑色文字
-        } else {
-            // 无指令的按键使用浅绿色背景
-            item->setBackground(QBrush(QColor(144, 238, 144))); // 浅绿色
-            item->setForeground(QBrush(QColor(0, 0, 0))); // 黑色文字
-        }
     }
 }
 
 void MainWindow::onDeleteButtonData(){
-    int row = ui->tableWidget->currentRow();
-    int col = ui->tableWidget->currentColumn();
+    int row = ui->tableView->currentIndex().row();
+    int col = ui->tableView->currentIndex().column();
 
     if(row < 0 || col < 0) return;
 
@@ -753,20 +972,11 @@ void MainWindow::onDeleteButtonData(){
                                    "确定要删除这个按键的数据吗?",
                                    QMessageBox::Yes | QMessageBox::No);
     if(ret == QMessageBox::Yes){
-        // 从数据库删除
+        // 从数据库删除，表格模型只刷新这一个格子
         buttonDatabase->removeButtonData(row, col);
 
         // 更新统计
         updateStatistics();
-
-        // 更新界面
-        QTableWidgetItem *item = ui->tableWidget->item(row, col);
-        if(item){
-            item->setText("");
-            // 重置为默认样式
-            item->setBackground(QBrush());
-            item->setForeground(QBrush());
-        }
     }
 }
 
@@ -780,9 +990,7 @@ void MainWindow::onOpenSerialPort(){
 }
 
 void MainWindow::onCloseSerialPort(){
-    if(serialPort->isOpen()){
-        serialPort->close();
-    }
+    serialManager->closePort();
     ui->btnOpenPort->setEnabled(true);
     ui->btnClosePort->setEnabled(false);
     ui->btnSend->setEnabled(false);
@@ -790,104 +998,28 @@ void MainWindow::onCloseSerialPort(){
 }
 
 // =====================================================================================
-// TableWidget相关功能实现
-void MainWindow::setupTableWidget(){
-    // 从数据库获取表格大小
-    QPair<int, int> tableSize = buttonDatabase->getTableSize();
-    ui->tableWidget->setRowCount(tableSize.first);
-    ui->tableWidget->setColumnCount(tableSize.second);
+// 按键表格相关功能实现
+void MainWindow::setupButtonTable(){
+    // 表格直接显示数据库中的按键，行列数取自数据库保存的表格大小
+    ui->tableView->setModel(buttonModel);
 
     // 禁用双击编辑
-    ui->tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
     // 设置右键菜单
-    ui->tableWidget->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(ui->tableWidget, &QTableWidget::customContextMenuRequested,
+    ui->tableView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->tableView, &QTableView::customContextMenuRequested,
             this, &MainWindow::onTableContextMenu);
 
-    // 设置表头
-    QStringList headers;
-    for(int i = 0; i < ui->tableWidget->columnCount(); i++){
-        headers << QString("按键%1").arg(i+1);
-    }
-    ui->tableWidget->setHorizontalHeaderLabels(headers);
-    ui->tableWidget->horizontalHeader()->setVisible(true);
+    // 表头显示"按键N"
+    ui->tableView->horizontalHeader()->setVisible(true);
 
     // 隐藏水平滚动条
-    ui->tableWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-
-    // 设置自适应列宽
-    adjustTableColumnWidths();
-
-    // 加载保存的按键数据
-    loadButtonsFromDatabase();
-}
-
-void MainWindow::adjustTableColumnWidths(){
-    if(!ui->tableWidget){
-        return;
-    }
-
-    int columnCount = ui->tableWidget->columnCount();
-    if(columnCount == 0){
-        return;
-    }
-
-    // 获取表格的总宽度
-    int totalWidth = ui->tableWidget->width();
+    ui->tableView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 
-    // 减去边距和滚动条等占用的空间
-    // 垂直滚动条宽度约20px，边距约10px，表格边框约2px
-    int reservedWidth = 32;
-
-    // 计算可用宽度
-    int availableWidth = totalWidth - reservedWidth;
-
-    // 计算平均列宽
-    int columnWidth = availableWidth / columnCount;
-
-    // 确保列宽不会太小
-    if(columnWidth < 80){
-        columnWidth = 80;
-    }
-
-    // 设置每列宽度
-    for(int i = 0; i < columnCount; i++){
-        ui->tableWidget->setColumnWidth(i, columnWidth);
-    }
-}
-
-void MainWindow::loadButtonsFromDatabase(){
-    QMap<QString, ButtonData> allButtons = buttonDatabase->getAllButtons();
-
-    for(auto it = allButtons.begin(); it != allButtons.end(); ++it){
-        const ButtonData &data = it.value();
-
-        if(data.isValid && data.row >= 0 && data.col >= 0 &&
-           data.row < ui->tableWidget->rowCount() && data.col < ui->tableWidget->columnCount()){
-
-            QTableWidgetItem *item = ui->tableWidget->item(data.row, data.col);
-            if(!item){
-                item = new QTableWidgetItem();
-                ui->tableWidget->setItem(data.row, data.col, item);
-            }
-
-            // 显示备注
-            item->setText(data.remark);
-            item->setTextAlignment(Qt::AlignCenter);
-
-            // 根据是否有指令设置背景色（适配黑色主题）
-            if(!data.command.isEmpty()){
-                // 有指令的按键使用浅蓝色背景
-                item->setBackground(QBrush(QColor(173, 216, 230))); // 浅蓝色
-                item->setForeground(QBrush(QColor(0, 0, 0))); // 黑色文字
-            } else {
-                // 无指令的按键使用浅绿色背景
-                item->setBackground(QBrush(QColor(144, 238, 144))); // 浅绿色
-                item->setForeground(QBrush(QColor(0, 0, 0))); // 黑色文字
-            }
-        }
-    }
+    // 各列平分表格宽度（最小80px），由表头在布局时统一计算，窗口缩放时无需逐列设置
+    ui->tableView->horizontalHeader()->setMinimumSectionSize(80);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
 
     // 更新按键数统计
     updateStatistics();
@@ -900,66 +1032,170 @@ void MainWindow::onTableCellClicked(int row, int column){
     // 如果有关联的指令，立即发送
     if(data.isValid && !data.command.isEmpty()){
         // 检查串口状态
-        if(!this->serialPort->isOpen()){
+        if(!serialManager->isPortOpen()){
             QMessageBox::warning(this, "警告", "串口未打开！");
             showStatusMessage("串口未打开");
             return;
         }
 
-        // 直接发送，绕过所有中间函数
-        QByteArray sendData;
-        QString displayCommand;
-
-        if(data.isHexCommand) {
-            // 十六进制命令
-            QString cleanHex = data.command.trimmed();
-            if(!cleanHex.isEmpty() && validateHexInput(QString(cleanHex).remove(' '))) {
-                sendData = QByteArray::fromHex(cleanHex.toLatin1());
-                displayCommand = cleanHex;
+        // 宏按键：运行中再点击任意宏按键停止，否则编译后交给宏引擎执行
+        if(data.type == ButtonData::MacroButton){
+            if(macroEngine->isRunning()){
+                macroEngine->stop();
+                return;
             }
-        } else {
-            // 文本命令
-            QString cleanText = data.command.trimmed();
-            if(!cleanText.isEmpty()) {
-                sendData = cleanText.toUtf8();
-                displayCommand = cleanText;
+            MacroProgram program;
+            QString errorString;
+            if(!MacroProgram::compile(data.command, &program, &errorString)){
+                QMessageBox::warning(this, "错误", QString("宏无法编译！\n%1").arg(errorString));
+                return;
             }
+            macroName = data.remark.isEmpty() ? QString("%1,%2").arg(row).arg(column) : data.remark;
+            macroEngine->start(serialManager, program);
+            showStatusMessage(QString("宏 [%1] 开始运行，再次点击停止").arg(macroName), 5000);
+            return;
         }
 
-        // 添加回车换行（如果启用）
-        if(ui->checkBox_4->isChecked() && !sendData.isEmpty()){
-            QString endChars = ui->lineEdit->text().trimmed();
-            if(!endChars.isEmpty()){
-                if(validateHexInput(endChars)){
-                    sendData.append(QByteArray::fromHex(endChars.toLatin1()));
-                }
-            }
-        }
+        // 按键内容编译一次后缓存，之后每次点击直接发送
+        const SendPayload &payload = payloadCache->button(row, column, data.command, data.isHexCommand);
+        const QByteArray &sendData = payload.bytes;
+        const QString &displayCommand = payload.text;
 
         // 立即写入串口
         if(!sendData.isEmpty()) {
-            qint64 bytesWritten = this->serialPort->write(sendData);
+            qint64 bytesWritten = serialManager->sendData(sendData);
             if(bytesWritten > 0) {
-                sendCount += bytesWritten;
                 updateStatistics();
-                showStatusMessage(QString("按键发送成功：%1 字节 [%2]").arg(bytesWritten).arg(displayCommand));
+                showStatusMessage(QString("按键已提交发送：%1 字节 [%2]").arg(bytesWritten).arg(displayCommand));
 
                 // 记录发送日志
                 if(!isPauseSendLog) {
-                    QString logMsg = data.isHexCommand ? sendData.toHex(' ').toUpper() : displayCommand;
-                    QString logEntry = isTimestampDisplay ?
-                        QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") + " " + logMsg + "\n" :
-                        logMsg + "\n";
-                    ui->comLog_1->insertPlainText(logEntry);
+                    const QString &logMsg = data.isHexCommand ? payload.hexText : displayCommand;
+                    ui->comLog_1->appendText(logMsg + "\n", PerfMetrics::nowNs());
                 }
             } else {
                 showStatusMessage("按键发送失败");
-                QMessageBox::warning(this, "错误", QString("按键发送失败！\n错误：%1").arg(this->serialPort->errorString()));
+                QMessageBox::warning(this, "错误", QString("按键发送失败！\n错误：%1").arg(serialManager->getErrorString()));
             }
         }
     }
 }
 
+void MainWindow::onMacroFinished(quint64 runId, bool ok, const QString &message){
+    // 停止后又立即开始了下一个宏时，上一个宏排队的信号不能停止新的宏
+    if(runId != macroEngine->runId()){
+        return;
+    }
+    // 执行线程发出信号后即结束，这里等待线程退出
+    macroEngine->stop();
+    updateStatistics();
+
+    // 每一步的执行次数和耗时写入发送日志
+    const MacroStats stats = macroEngine->stats();
+    const QVector<MacroStep> &steps = macroEngine->program().steps;
+    QString report = QString("宏 [%1] %2，用时 %3\n").arg(macroName, message, formatDurationNs(stats.elapsedNs));
+    for(int i = 0; i < steps.size() && i < stats.steps.size(); ++i){
+        const MacroStepStats &step = stats.steps.at(i);
+        if(step.runs == 0 && step.timeouts == 0){
+            continue;
+        }
+        report += QString("  %1. %2：%3 次，平均 %4，最小 %5，最大 %6")
+                      .arg(i + 1).arg(steps.at(i).text).arg(step.runs)
+                      .arg(formatDurationNs(step.averageNs()))
+                      .arg(formatDurationNs(step.minNs))
+                      .arg(formatDurationNs(step.maxNs));
+        if(step.timeouts > 0){
+            report += QString("，超时 %1 次").arg(step.timeouts);
+        }
+        report += "\n";
+    }
+    if(!isPauseSendLog){
+        ui->comLog_1->appendText(report, PerfMetrics::nowNs());
+    }
+    showStatusMessage(QString("宏 [%1] %2").arg(macroName, message), ok ? 5000 : 10000);
+}
+
+void MainWindow::refreshProfileList(){
+    QSignalBlocker blocker(ui->comboBox_profile);
+    ui->comboBox_profile->clear();
+    ui->comboBox_profile->addItems(buttonDatabase->getProfileNames());
+    ui->comboBox_profile->setCurrentIndex(buttonDatabase->getActiveProfile());
+}
+
+void MainWindow::onProfileSelected(int index){
+    if(index < 0 || index == buttonDatabase->getActiveProfile()){
+        return;
+    }
+
+    // 界面上的串口设置先存入原来的配置
+    saveAllConfigs();
+    // 只切换当前配置，表格模型重置后视图只重绘可见格子
+    buttonDatabase->setActiveProfile(index);
+    applyActiveProfile();
+}
+
+void MainWindow::applyActiveProfile(){
+    // 换成该配置的发送内容缓存，按键的编译结果保留；输入框和自动发送的内容可能在其他配置下改过，重新编译
+    payloadCache = &profilePayloads[buttonDatabase->getActiveProfileName()];
+    payloadCache->invalidateMessage(SendPayloadCache::InputMessage);
+    payloadCache->invalidateMessage(SendPayloadCache::AutoSendMessage);
+
+    // 串口参数下次打开串口时生效，显示和发送选项立即生效
+    loadAllConfigs();
+    payloadCache->setHexSend(ui->checkBox_5->isChecked());
+    payloadCache->setTerminator(ui->checkBox_4->isChecked(), ui->lineEdit->text());
+
+    updateStatistics();
+    showStatusMessage(QString("已切换到配置：%1").arg(buttonDatabase->getActiveProfileName()));
+}
+
+void MainWindow::onProfileContextMenu(const QPoint &pos){
+    QMenu menu(this);
+    QAction *addAction = menu.addAction("新建配置...");
+    QAction *copyAction = menu.addAction("复制当前配置...");
+    QAction *renameAction = menu.addAction("重命名...");
+    menu.addSeparator();
+    QAction *removeAction = menu.addAction("删除当前配置");
+    removeAction->setEnabled(buttonDatabase->getProfileNames().size() > 1);
+
+    QAction *selected = menu.exec(ui->comboBox_profile->mapToGlobal(pos));
+    if(!selected) return;
+
+    const QString currentName = buttonDatabase->getActiveProfileName();
+    if(selected == removeAction){
+        if(QMessageBox::question(this, "删除配置", QString("确定删除配置\"%1\"及其全部按键？").arg(currentName)) != QMessageBox::Yes){
+            return;
+        }
+        buttonDatabase->removeProfile(buttonDatabase->getActiveProfile());
+        profilePayloads.remove(currentName);
+        applyActiveProfile();
+        return;
+    }
+
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, selected->text().remove("..."), "配置名称:", QLineEdit::Normal,
+                                               selected == renameAction ? currentName : QString(), &ok).trimmed();
+    if(!ok || name.isEmpty() || name == currentName){
+        return;
+    }
+    if(buttonDatabase->getProfileNames().contains(name)){
+        QMessageBox::warning(this, "提示", QString("配置\"%1\"已存在！").arg(name));
+        return;
+    }
+
+    if(selected == renameAction){
+        buttonDatabase->renameProfile(buttonDatabase->getActiveProfile(), name);
+        profilePayloads.insert(name, profilePayloads.take(currentName));
+        payloadCache = &profilePayloads[name];
+        return;
+    }
+
+    // 新配置复制当前配置时，界面上的设置先存入当前配置
+    saveAllConfigs();
+    buttonDatabase->addProfile(name, selected == copyAction);
+    applyActiveProfile();
+}
+
 void MainWindow::onAddRowClicked(){
     addTableRow();
     saveAllConfigs();
@@ -976,28 +1212,24 @@ void MainWindow::onRemoveRowClicked(){
 }
 
 void MainWindow::addTableRow(){
-    int currentRows = ui->tableWidget->rowCount();
-    ui->tableWidget->setRowCount(currentRows + 1);
+    if(!buttonModel->insertRow(buttonModel->rowCount())){
+        QMessageBox::information(this, "提示", QString("按键表格最多 %1 行！").arg(ButtonGrid::MaxDimension));
+    }
 }
 
 void MainWindow::addTableColumn(){
-    int currentCols = ui->tableWidget->columnCount();
-    ui->tableWidget->setColumnCount(currentCols + 1);
-
-    // 设置新列的表头
-    QString headerText = QString("按键%1").arg(currentCols + 1);
-    ui->tableWidget->setHorizontalHeaderItem(currentCols, new QTableWidgetItem(headerText));
-
-    // 重新调整所有列的宽度
-    adjustTableColumnWidths();
+    // 新列的表头和列宽由模型和表头自动处理
+    if(!buttonModel->insertColumn(buttonModel->columnCount())){
+        QMessageBox::information(this, "提示", QString("按键表格最多 %1 列！").arg(ButtonGrid::MaxDimension));
+    }
 }
 
 void MainWindow::removeTableRow(){
-    if(!ui->tableWidget || !buttonDatabase){
+    if(!buttonModel){
         return;
     }
 
-    int currentRows = ui->tableWidget->rowCount();
+    int currentRows = buttonModel->rowCount();
     if(currentRows <= 2){
         // QMessageBox::information(this, "提示", "至少需要保留2行！");
         return;
@@ -1006,17 +1238,8 @@ void MainWindow::removeTableRow(){
     // 从最后一行开始检查，如果有使用的按键则停止删除
     bool deletedAnyRow = false;
     for(int row = currentRows - 1; row >= 0; row--){
-        bool hasUsedButton = false;
-
         // 检查这一行是否有使用的按键
-        int colCount = ui->tableWidget->columnCount();
-        for(int col = 0; col < colCount; col++){
-            ButtonData data = buttonDatabase->getButtonData(row, col);
-            if(data.isValid && (!data.remark.isEmpty() || !data.command.isEmpty())){
-                hasUsedButton = true;
-                break;
-            }
-        }
+        bool hasUsedButton = buttonDatabase->getButtons().isRowUsed(row);
 
         if(hasUsedButton){
             if(row == currentRows - 1 && !deletedAnyRow){
@@ -1028,13 +1251,8 @@ void MainWindow::removeTableRow(){
             break;
         } else {
             // 这一行没有使用的按键，可以删除
-            // 先删除数据库中这一行的所有按键数据
-            for(int col = 0; col < colCount; col++){
-                buttonDatabase->removeButtonData(row, col);
-            }
-
-            // 删除表格行
-            ui->tableWidget->removeRow(row);
+            // 模型同时删除数据库中这一行的按键数据和表格行
+            buttonModel->removeRow(row);
             currentRows--;
             deletedAnyRow = true;
 
@@ -1050,24 +1268,27 @@ void MainWindow::removeTableRow(){
 }
 
 void MainWindow::saveAllConfigs(){
-    // 保存串口配置
-    SerialPortConfig config;
+    // 保存串口配置（以当前配置为基础，保留界面上没有对应控件的选项）
+    SerialPortConfig config = buttonDatabase->getSerialConfig();
     config.portName = ui->portName->currentText();
     config.baudRate = ui->baudRate->currentText().toInt();
     config.dataBits = ui->dataBits->currentText().toInt();
     config.stopBits = ui->stopBits->currentText().toInt();
     config.parity = ui->parity->currentText();
+    config.flowControl = FLOW_CONTROLS[qBound(0, ui->flowControl->currentIndex(), 2)];
     config.timestampDisplay = ui->checkBox_1->isChecked();
+    config.timestampMode = TIMESTAMP_MODES[qBound(0, ui->comboBox_timestampMode->currentIndex(), 2)];
     config.hexDisplay = ui->checkBox_2->isChecked();
     config.hexSend = ui->checkBox_5->isChecked();
     config.autoSendEnter = ui->checkBox_4->isChecked();
     config.enterChars = ui->lineEdit->text();
+    config.frameMode = FrameOptions::modeToString(FrameOptions::Mode(qMax(0, ui->comboBox_frameMode->currentIndex())));
     // 移除编码配置，固定使用UTF-8
 
     buttonDatabase->setSerialConfig(config);
 
     // 保存表格大小
-    buttonDatabase->setTableSize(ui->tableWidget->rowCount(), ui->tableWidget->columnCount());
+    buttonDatabase->setTableSize(buttonModel->rowCount(), buttonModel->columnCount());
 
     // 窗口几何信息保存已移除
 }
@@ -1092,51 +1313,124 @@ void MainWindow::applySerialPortConfig(const SerialPortConfig &config){
     ui->baudRate->setCurrentText(QString::number(config.baudRate));
     ui->dataBits->setCurrentText(QString::number(config.dataBits));
     ui->stopBits->setCurrentText(QString::number(config.stopBits));
-    ui->parity->setCurrentText(config.parity);
+    // 按首字母匹配，兼容旧版本保存的校验位文字
+    int parityIndex = ui->parity->findText(config.parity.left(1), Qt::MatchStartsWith);
+    if (parityIndex >= 0) {
+        ui->parity->setCurrentIndex(parityIndex);
+    }
+    {
+        int index = 0;
+        for(int i = 0; i < 3; i++){
+            if(config.flowControl == FLOW_CONTROLS[i]) index = i;
+        }
+        ui->flowControl->setCurrentIndex(index);
+    }
 
     // 应用显示选项
     ui->checkBox_1->setChecked(config.timestampDisplay);
+    {
+        QSignalBlocker blocker(ui->comboBox_timestampMode);
+        int index = 0;
+        for(int i = 0; i < 3; i++){
+            if(config.timestampMode == TIMESTAMP_MODES[i]) index = i;
+        }
+        ui->comboBox_timestampMode->setCurrentIndex(index);
+    }
     ui->checkBox_2->setChecked(config.hexDisplay);
     ui->checkBox_5->setChecked(config.hexSend);
     ui->checkBox_4->setChecked(config.autoSendEnter);
     ui->lineEdit->setText(config.enterChars);
+    {
+        QSignalBlocker blocker(ui->comboBox_frameMode);
+        ui->comboBox_frameMode->setCurrentIndex(FrameOptions::modeFromString(config.frameMode));
+    }
 
     // 移除编码选择设置，固定使用UTF-8
 
     // 更新内部状态
     isTimestampDisplay = config.timestampDisplay;
     isHexDisplay = config.hexDisplay;
+    updateTimestampMode();
+    receiveCoalescer->setMaxFps(config.renderFps);
+
+    // 发送队列高水位和满时策略
+    SerialPortManager::SendQueuePolicy sendPolicy = SerialPortManager::Block;
+    if(config.sendQueuePolicy == "drop"){
+        sendPolicy = SerialPortManager::DropNew;
+    } else if(config.sendQueuePolicy == "coalesce"){
+        sendPolicy = SerialPortManager::Coalesce;
+    }
+    serialManager->setSendQueueLimit(qint64(config.sendQueueKilobytes) * 1024, sendPolicy);
+
+    // 串口后端，下次打开串口时生效
+    serialManager->setBackend(SerialPortManager::backendFromString(config.serialBackend),
+                              NativePortSettings::profileFromString(config.nativeProfile));
+
+    // 接收分帧参数
+    updateFrameOptions();
+
+    // 性能指标快照按周期追加到程序目录下的 perf_metrics.jsonl
+    perfDumper->start(QCoreApplication::applicationDirPath() + "/perf_metrics.jsonl", config.metricsDumpSeconds);
+
+    // 日志保留上限
+    qint64 maxLogBytes = qint64(config.logMaxMegabytes) * 1024 * 1024;
+    ui->comLog_1->setRetentionLimits(config.logMaxLines, maxLogBytes);
+    ui->comLog_2->setRetentionLimits(config.logMaxLines, maxLogBytes);
 }
 
-void MainWindow::updateStatistics(){
-    ui->label_6->setText(QString("发送数：%1").arg(sendCount));
-    ui->label_7->setText(QString("接收数：%1").arg(receiveCount));
+void MainWindow::updateTxStatus(){
+    const qint64 sentBytes = serialManager->getSentBytes();
+    const qint64 elapsedMs = txRateClock.restart();
+    const double bytesPerSecond = elapsedMs > 0 ? (sentBytes - txRateLastBytes) * 1000.0 / elapsedMs : 0.0;
+    txRateLastBytes = sentBytes;
 
-    // 统计自定义按键数
-    int buttonCount = 0;
-    QMap<QString, ButtonData> allButtons = buttonDatabase->getAllButtons();
-    for(auto it = allButtons.begin(); it != allButtons.end(); ++it){
-        if(it.value().isValid && (!it.value().remark.isEmpty() || !it.value().command.isEmpty())){
-            buttonCount++;
-        }
+    ui->label_6->setText(QString("发送数：%1").arg(sentBytes - sentBytesBase));
+
+    QString text = QString("TX：%1 B/s  队列：%2 字节")
+                   .arg(qRound64(bytesPerSecond))
+                   .arg(serialManager->getQueuedBytes());
+    const quint64 droppedBytes = serialManager->getDroppedBytes();
+    if(droppedBytes > 0){
+        text += QString("  丢弃：%1").arg(droppedBytes);
     }
-    ui->label_8->setText(QString("按键数：%1").arg(buttonCount));
+    txStatusLabel->setText(text);
 }
 
-bool MainWindow::validateHexInput(const QString &input){
-    if(input.isEmpty()) return false;
+void MainWindow::updateStatistics(){
+    ui->label_6->setText(QString("发送数：%1").arg(serialManager->getSentBytes() - sentBytesBase));
+    quint64 overrunBytes = serialManager->getOverrunBytes();
+    if(overrunBytes > 0){
+        // 接收环形缓冲区曾经写满，提示丢失的字节数
+        ui->label_7->setText(QString("接收数：%1 (溢出：%2)").arg(receiveCount).arg(overrunBytes));
+    } else {
+        ui->label_7->setText(QString("接收数：%1").arg(receiveCount));
+    }
 
-    QString cleanInput = input;
-    cleanInput.remove(' ').remove('\n').remove('\r').remove('\t');
+    // 统计自定义按键数
+    int buttonCount = buttonDatabase->getButtons().usedCount();
+    ui->label_8->setText(QString("按键数：%1").arg(buttonCount));
+}
 
-    // 检查是否只包含十六进制字符
-    QRegularExpression hexPattern("^[0-9A-Fa-f]+$");
-    if(!hexPattern.match(cleanInput).hasMatch()){
+// 单遍校验并解码十六进制输入，空白可出现在任意位置；解码结果追加到out，out为nullptr时只校验
+bool MainWindow::decodeHexInput(QStringView input, QByteArray *out, qsizetype *errorOffset){
+    if(input.isEmpty()){
+        if(errorOffset) *errorOffset = 0;
         return false;
     }
 
-    // 检查长度是否为偶数（每个字节需要2个十六进制字符）
-    return (cleanInput.length() % 2 == 0);
+    if(!out){
+        return HexCodec::decode(input, nullptr, errorOffset) > 0;
+    }
+    const qsizetype oldSize = out->size();
+    if(!HexCodec::appendDecoded(input, *out, errorOffset)){
+        return false;
+    }
+    // 只有空白时视为无效输入
+    if(out->size() == oldSize){
+        if(errorOffset) *errorOffset = 0;
+        return false;
+    }
+    return true;
 }
 
 void MainWindow::showStatusMessage(const QString &message, int timeout){
@@ -1150,7 +1444,7 @@ void MainWindow::showStatusMessage(const QString &message, int timeout){
 // 日志管理功能实现
 void MainWindow::onClearSendLogClicked(){
     ui->comLog_1->clear();
-    sendCount = 0;
+    sentBytesBase = serialManager->getSentBytes();
     ui->label_6->setText("发送数：0");
 }
 
@@ -1183,6 +1477,8 @@ void MainWindow::onPauseSendLogClicked(){
 }
 
 void MainWindow::onClearReceiveLogClicked(){
+    receiveCoalescer->clear();
+    receiveLogAtLineStart = true;
     ui->comLog_2->clear();
     receiveCount = 0;
     ui->label_7->setText("接收数：0");
@@ -1195,6 +1491,9 @@ void MainWindow::onSaveReceiveLogClicked(){
         "文本文件 (*.txt)");
 
     if(!fileName.isEmpty()){
+        // 先把尚未刷新的数据写入界面，保证保存内容完整
+        receiveCoalescer->flushNow();
+
         QFile file(fileName);
         if(file.open(QIODevice::WriteOnly | QIODevice::Text)){
             QTextStream out(&file);
@@ -1216,13 +1515,266 @@ void MainWindow::onPauseReceiveLogClicked(){
     }
 }
 
-void MainWindow::resizeEvent(QResizeEvent *event){
-    QMainWindow::resizeEvent(event);
+void MainWindow::onRecordClicked(){
+    if(captureWriter->isRecording()){
+        serialManager->setCaptureWriter(nullptr);
+        captureWriter->stop();
+        ui->pushButton_record->setText("录制");
+        showStatusMessage(QString("录制已停止，共记录 %1 字节").arg(captureWriter->recordedBytes()));
+        return;
+    }
+
+    SerialPortConfig config = buttonDatabase->getSerialConfig();
+    QString startDir = config.captureDirectory.isEmpty() ?
+        QStandardPaths::writableLocation(QStandardPaths::DesktopLocation) : config.captureDirectory;
+    QString dir = QFileDialog::getExistingDirectory(this, "选择录制目录", startDir);
+    if(dir.isEmpty()){
+        return;
+    }
+
+    const CaptureOptions options = SessionManager::captureOptions(config, dir);
+    if(!captureWriter->start(options)){
+        QMessageBox::warning(this, "错误", QString("无法开始录制！\n%1").arg(captureWriter->errorString()));
+        return;
+    }
+    serialManager->setCaptureWriter(captureWriter);
+    ui->pushButton_record->setText("停止录制");
+
+    // 记住录制目录
+    config.captureDirectory = dir;
+    buttonDatabase->setSerialConfig(config);
+}
+
+void MainWindow::onRecordContextMenu(const QPoint &pos){
+    QMenu menu(this);
+    QAction *openAction = menu.addAction("打开录制文件...");
+    menu.addSeparator();
+    QAction *exportAction = menu.addAction("导出录制文件为文本...");
+    QAction *importAction = menu.addAction("导入文本为录制文件...");
+    connect(openAction, &QAction::triggered, this, &MainWindow::onOpenCaptureFile);
+    connect(exportAction, &QAction::triggered, this, &MainWindow::onExportCaptureToText);
+    connect(importAction, &QAction::triggered, this, &MainWindow::onImportTextToCapture);
+    menu.exec(ui->pushButton_record->mapToGlobal(pos));
+}
+
+void MainWindow::onMultiPortClicked(){
+    // 窗口关闭时只隐藏，会话继续在后台监控
+    if(!multiPortWindow){
+        multiPortWindow = new MultiPortWindow(sessionManager, buttonDatabase->getSerialConfig(), this);
+    }
+    multiPortWindow->show();
+    multiPortWindow->raise();
+    multiPortWindow->activateWindow();
+}
+
+void MainWindow::onPerfPanelClicked(){
+    perfDock->setVisible(!perfDock->isVisible());
+    if(perfDock->isVisible()){
+        perfDock->raise();
+    }
+}
+
+void MainWindow::onPortContextMenu(const QPoint &pos){
+    QMenu menu(this);
+    QAction *echoAction = menu.addAction("新建虚拟串口（回环）");
+    QAction *generatorAction = menu.addAction("新建虚拟串口（数据发生器）...");
+    QAction *silentAction = menu.addAction("新建虚拟串口（只接收）");
+    QAction *throttleAction = menu.addAction("新建虚拟串口（慢速设备，XON/XOFF）...");
+    menu.addSeparator();
+    QAction *removeAction = menu.addAction("移除全部虚拟串口");
+    removeAction->setEnabled(!virtualPorts->portNames().isEmpty());
+    if(!VirtualPort::isSupported()){
+        echoAction->setEnabled(false);
+        generatorAction->setEnabled(false);
+        silentAction->setEnabled(false);
+        throttleAction->setEnabled(false);
+    }
+
+    QAction *selected = menu.exec(ui->portName->mapToGlobal(pos));
+    if(!selected) return;
+
+    if(selected == removeAction){
+        // 主窗口正在使用虚拟串口时先关闭
+        if(serialManager->isPortOpen() && virtualPorts->port(serialManager->getPortName())){
+            onCloseSerialPort();
+        }
+        virtualPorts->removeAll();
+        return;
+    }
+
+    VirtualPortOptions options;
+    if(selected == echoAction){
+        options.mode = VirtualPortOptions::Echo;
+    } else if(selected == silentAction){
+        options.mode = VirtualPortOptions::Silent;
+    } else if(selected == throttleAction){
+        bool ok = false;
+        int rate = QInputDialog::getInt(this, "慢速设备", "处理速率（字节/秒）：",
+                                        int(options.throttleBytesPerSecond), 1, 100 * 1024 * 1024, 1, &ok);
+        if(!ok) return;
+        options.mode = VirtualPortOptions::Throttle;
+        options.throttleBytesPerSecond = rate;
+    } else {
+        bool ok = false;
+        int rate = QInputDialog::getInt(this, "数据发生器", "发送速率（字节/秒）：",
+                                        int(options.generatorBytesPerSecond), 1, 100 * 1024 * 1024, 1, &ok);
+        if(!ok) return;
+        options.mode = VirtualPortOptions::Generator;
+        options.generatorBytesPerSecond = rate;
+    }
+
+    QString errorString;
+    VirtualPort *port = virtualPorts->create(options, &errorString);
+    if(!port){
+        QMessageBox::warning(this, "错误", QString("创建虚拟串口失败！\n%1").arg(errorString));
+        return;
+    }
+    ui->portName->setCurrentText(port->portName());
+    showStatusMessage(QString("已创建虚拟串口：%1").arg(port->portName()));
+}
+
+void MainWindow::onOpenCaptureFile(){
+    QString startDir = buttonDatabase->getSerialConfig().captureDirectory;
+    QString filePath = QFileDialog::getOpenFileName(this, "打开录制文件", startDir,
+        "录制文件 (*.fcap *.txt *.log);;所有文件 (*)");
+    if(filePath.isEmpty()){
+        return;
+    }
+
+    // 非模态查看窗口，可同时打开多个文件，关闭时自动释放
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(QString("录制文件 - %1").arg(QFileInfo(filePath).fileName()));
+    dialog->resize(1000, 600);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    QHBoxLayout *toolLayout = new QHBoxLayout();
+    QComboBox *modeCombo = new QComboBox();
+    modeCombo->addItem("十六进制显示");
+    modeCombo->addItem("文本显示");
+    QProgressBar *progressBar = new QProgressBar();
+    progressBar->setRange(0, 100);
+    QLabel *infoLabel = new QLabel();
+    toolLayout->addWidget(modeCombo);
+    toolLayout->addWidget(progressBar);
+    toolLayout->addWidget(infoLabel, 1);
+    layout->addLayout(toolLayout);
+
+    CaptureView *view = new CaptureView();
+    layout->addWidget(view);
+
+    connect(modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), view, [view](int index){
+        view->setDisplayMode(index == 0 ? CaptureView::HexMode : CaptureView::TextMode);
+    });
+    connect(view, &CaptureView::indexProgress, dialog, [progressBar, infoLabel](int percent, qint64 rows){
+        progressBar->setValue(percent);
+        infoLabel->setText(QString("正在建立索引… 已索引 %1 行").arg(rows));
+    });
+    connect(view, &CaptureView::indexFinished, dialog, [progressBar, infoLabel, view](qint64 rows){
+        progressBar->hide();
+        infoLabel->setText(QString("%1，共 %2 %3").arg(view->isBinaryCapture() ? "二进制录制" : "文本文件")
+                           .arg(rows).arg(view->isBinaryCapture() ? "条记录" : "行"));
+    });
+
+    if(!view->openFile(filePath)){
+        QMessageBox::warning(this, "错误", QString("无法打开录制文件！\n%1").arg(view->errorString()));
+        delete dialog;
+        return;
+    }
+    dialog->show();
+}
+
+void MainWindow::onExportCaptureToText(){
+    QString startDir = buttonDatabase->getSerialConfig().captureDirectory;
+    QString capturePath = QFileDialog::getOpenFileName(this, "选择录制文件", startDir, "录制文件 (*.fcap);;所有文件 (*)");
+    if(capturePath.isEmpty()){
+        return;
+    }
+
+    QString textPath = QFileDialog::getSaveFileName(this, "导出为文本",
+        QFileInfo(capturePath).absolutePath() + "/" + QFileInfo(capturePath).completeBaseName() + ".txt",
+        "文本文件 (*.txt);;所有文件 (*)");
+    if(textPath.isEmpty()){
+        return;
+    }
+
+    runCaptureConversion("正在导出为文本…", textPath,
+        [capturePath, textPath](const CaptureConverter::ProgressCallback &progress, QString *errorString){
+            return CaptureConverter::exportToText(capturePath, textPath, errorString, progress);
+        });
+}
+
+void MainWindow::onImportTextToCapture(){
+    QString startDir = buttonDatabase->getSerialConfig().captureDirectory;
+    QString textPath = QFileDialog::getOpenFileName(this, "选择文本录制或接收日志", startDir, "文本文件 (*.txt *.log);;所有文件 (*)");
+    if(textPath.isEmpty()){
+        return;
+    }
+
+    QString capturePath = QFileDialog::getSaveFileName(this, "导入为录制文件",
+        QFileInfo(textPath).absolutePath() + "/" + QFileInfo(textPath).completeBaseName() + ".fcap",
+        "录制文件 (*.fcap)");
+    if(capturePath.isEmpty()){
+        return;
+    }
+
+    runCaptureConversion("正在导入为录制文件…", capturePath,
+        [textPath, capturePath](const CaptureConverter::ProgressCallback &progress, QString *errorString){
+            return CaptureConverter::importFromText(textPath, capturePath, errorString, progress);
+        });
+}
+
+void MainWindow::runCaptureConversion(const QString &label, const QString &outputPath,
+                                      const std::function<bool(const CaptureConverter::ProgressCallback &, QString *)> &convert){
+    if(conversionThread){
+        showStatusMessage("已有录制文件转换正在进行");
+        return;
+    }
 
-    // 延迟调整列宽，确保UI已经完全更新
-    QTimer::singleShot(10, this, [this](){
-        adjustTableColumnWidths();
+    // 多GB文件转换需要较长时间，放到工作线程，界面只显示进度
+    QProgressDialog *dialog = new QProgressDialog(label, "取消", 0, 100, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    dialog->setMinimumDuration(0);
+    connect(dialog, &QProgressDialog::canceled, this, [this](){
+        conversionCanceled = true;
+    });
+
+    // 转换线程只写进度值，界面定时读取
+    auto percent = std::make_shared<std::atomic<int>>(0);
+    QTimer *progressTimer = new QTimer(dialog);
+    connect(progressTimer, &QTimer::timeout, dialog, [dialog, percent](){
+        dialog->setValue(*percent);
+    });
+    progressTimer->start(100);
+
+    auto ok = std::make_shared<bool>(false);
+    auto errorString = std::make_shared<QString>();
+    conversionCanceled = false;
+    conversionThread = QThread::create([this, convert, percent, ok, errorString](){
+        *ok = convert([this, percent](int value){
+            *percent = value;
+            return !conversionCanceled;
+        }, errorString.get());
+    });
+    connect(conversionThread, &QThread::finished, this, [this, dialog, outputPath, ok, errorString](){
+        conversionThread->wait();
+        delete conversionThread;
+        conversionThread = nullptr;
+        // 关闭对话框也会发出 canceled，先取出取消标志
+        const bool canceled = conversionCanceled;
+        dialog->close();
+
+        if(*ok){
+            showStatusMessage(QString("已保存：%1").arg(outputPath));
+        } else if(canceled){
+            showStatusMessage("录制文件转换已取消");
+        } else {
+            QMessageBox::warning(this, "错误", QString("转换失败！\n%1").arg(*errorString));
+        }
     });
+    conversionThread->start(QThread::LowPriority);
 }
 
 // 编码处理函数已删除，统一使用UTF-8
@@ -13,8 +13,8 @@
 #include <QVBoxLayout>
 #include <QScrollArea>
 #include <QList>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QMap>
+#include <QTableView>
 #include <QHeaderView>
 #include <QFileDialog>
 #include <QJsonDocument>
@@ -31,8 +31,28 @@
 #include <QStatusBar>
 #include <QTextCursor>
 #include <QPoint>
+#include <QThread>
+#include <QLabel>
+#include <QElapsedTimer>
+#include <QDockWidget>
+#include <QStringDecoder>
+#include <atomic>
+#include <functional>
 #include "configmanager.h"
 #include "buttondatabase.h"
+#include "buttonmodel.h"
+#include "serialportmanager.h"
+#include "rendercoalescer.h"
+#include "capturewriter.h"
+#include "sendpayload.h"
+#include "sendscheduler.h"
+#include "macroengine.h"
+#include "sessionmanager.h"
+#include "virtualport.h"
+#include "perfmetrics.h"
+#include "frameassembler.h"
+
+class MultiPortWindow;
 
 namespace Ui {
 class MainWindow;
@@ -50,13 +70,13 @@ protected:
     void findFreePorts();
     void refreshPorts();
     bool initSerialPort();
-    void sendMsg(const QString &msg);
+    void sendMsg(SendPayloadCache::MessageSlot slot, const QString &msg);
     void sendHexCommand(const QString &hexCommand);
     void sendTextCommand(const QString &textCommand);
     void sendDataToPort(const QByteArray &data, const QString &displayText, bool isHex);
-    void setupTableWidget();
-    void adjustTableColumnWidths();
-    void loadButtonsFromDatabase();
+    void setupButtonTable();
+    void refreshProfileList();
+    void applyActiveProfile();
     void addTableRow();
     void addTableColumn();
     void removeTableRow();
@@ -64,18 +84,30 @@ protected:
     void loadAllConfigs();
     void applySerialPortConfig(const SerialPortConfig &config);
     void updateStatistics();
-    bool validateHexInput(const QString &input);
+    bool decodeHexInput(QStringView input, QByteArray *out, qsizetype *errorOffset = nullptr);
     void showStatusMessage(const QString &message, int timeout = 3000);
+    // 在工作线程中转换录制文件，显示进度，可取消
+    void runCaptureConversion(const QString &label, const QString &outputPath,
+                              const std::function<bool(const CaptureConverter::ProgressCallback &, QString *)> &convert);
+    void appendSendLog(const SendPayload &payload);
+    void startAutoSend();
+    void stopAutoSend();
     void parseAndApplyQuickConfig(const QString &configText);
     // 编码处理方法已删除，统一使用UTF-8
-    void displayCompleteMessage(const QByteArray &message);
+    void displayCompleteMessage(const QByteArray &data, const QVector<SerialPortManager::ReceiveChunk> &chunks);
+    void displayFrames(const QByteArray &data, const QVector<SerialPortManager::ReceiveChunk> &chunks);
+    void appendFrameEntry(QByteArrayView frame, qint64 timestampNs, bool complete);
+    void updateTimestampMode();
+    void updateFrameOptions();
+    void scheduleFrameFlush();
     bool eventFilter(QObject *obj, QEvent *event);
-    void resizeEvent(QResizeEvent *event) override;
 
 public slots:
     void recvMsg();
-    void onSerialError(QSerialPort::SerialPortError error);
+    void onSerialError(const QString &errorString);
     void onTableCellClicked(int row, int column);
+    void onProfileSelected(int index);
+    void onProfileContextMenu(const QPoint &pos);
     void onAddRowClicked();
     void onAddColumnClicked();
     void onRemoveRowClicked();
@@ -85,21 +117,36 @@ public slots:
     void onClearReceiveLogClicked();
     void onSaveReceiveLogClicked();
     void onPauseReceiveLogClicked();
-    void onAutoSendTimeout();
+    void onRecordClicked();
+    void onRecordContextMenu(const QPoint &pos);
+    void onExportCaptureToText();
+    void onOpenCaptureFile();
+    void onImportTextToCapture();
+    void onMultiPortClicked();
+    void onPerfPanelClicked();
+    void onPortContextMenu(const QPoint &pos);
+    void onAutoSendTick(qint64 bytes);
+    void onMacroFinished(quint64 runId, bool ok, const QString &message);
+    void updateAutoSendStats();
+    void updateTxStatus();
     void onTableContextMenu(const QPoint &pos);
     void onEditButtonData();
     void onDeleteButtonData();
     void onOpenSerialPort();
     void onCloseSerialPort();
+    void onReceiveLogFlushed(const QString &text, const QVector<LogTimestamp> &stamps);
+    void onFrameIdleTimeout();
 
 private:
     Ui::MainWindow *ui;
-    QSerialPort *serialPort;
+    SerialPortManager *serialManager;  // 运行在ioThread中
+    QThread *ioThread;
     ConfigManager *configManager;
     ButtonDatabase *buttonDatabase;
+    ButtonModel *buttonModel;   // 按键表格模型，直接读取buttonDatabase
 
     // 数据统计
-    int sendCount;
+    qint64 sentBytesBase;   // 清空发送日志时的已发送字节数，发送数 = 实际发出字节数 - 该值
     int receiveCount;
 
     // 显示控制
@@ -108,11 +155,56 @@ private:
     bool isHexDisplay;
     bool isTimestampDisplay;
 
-    // 自动发送
-    QTimer *autoSendTimer;
+    // 接收日志按帧率批量刷新
+    RenderCoalescer *receiveCoalescer;
+    bool receiveLogAtLineStart;  // 接收日志（含待刷新部分）是否以换行结尾
+    QStringDecoder receiveDecoder; // 跨读取块的多字节UTF-8字符不会被拆坏
+
+    // 录制到文件
+    CaptureWriter *captureWriter;
+    // 录制文件与文本互转，同一时刻只运行一个
+    QThread *conversionThread;
+    std::atomic<bool> conversionCanceled;
+
+    // 多串口监控：附加会话各自独立线程，与主窗口的串口互不影响
+    SessionManager *sessionManager;
+    MultiPortWindow *multiPortWindow;
+
+    // 伪终端虚拟串口，无硬件时测试和基准测试用
+    VirtualPortProvider *virtualPorts;
+
+    // 自动发送：由独立线程按绝对截止时间周期发送，界面定时轮询统计
+    SendScheduler *sendScheduler;
+    QTimer *autoSendStatsTimer;
+    QLabel *autoSendStatsLabel;
     QString autoSendData;
 
-    // 实时接收显示，无需缓存机制
+    // 宏按键：宏在独立线程中执行，点击运行中的宏按键停止
+    MacroEngine *macroEngine;
+    QString macroName;          // 正在运行的宏按键备注，报告用
+
+    // 实际发送速率和发送队列深度
+    QTimer *txStatusTimer;
+    QLabel *txStatusLabel;
+    QElapsedTimer txRateClock;
+    qint64 txRateLastBytes;
+
+    // 编译好的发送内容，自动发送和按键发送直接复用
+    // 每个命名配置一份，切换配置后按键不需要重新编译；payloadCache 指向当前配置的那一份
+    QMap<QString, SendPayloadCache> profilePayloads;
+    SendPayloadCache *payloadCache;
+
+    // 接收分帧：完整的帧才显示，每帧一个时间戳（首字节的到达时刻）
+    FrameAssembler frameAssembler;
+    QTimer *frameIdleTimer;     // 未完成帧的空闲间隔/超时检查
+    QVector<SerialPortManager::ReceiveChunk> receiveChunks;
+    PerfCounter *frameCounter;
+
+    // 性能统计面板和周期性指标快照
+    QDockWidget *perfDock;
+    PerfMetricsDumper *perfDumper;
+    PerfHistogram *chunkProcessHistogram;
+    PerfHistogram *renderFlushHistogram;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,367 @@
+#include "multiportwindow.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QSerialPortInfo>
+#include <QStandardPaths>
+#include <QtMath>
+
+static const char *BAUD_RATES[] = {
+    "9600", "19200", "38400", "57600", "115200", "230400", "460800", "921600"
+};
+
+SessionPanel::SessionPanel(PortSession *session, const SerialPortConfig &serialConfig, QWidget *parent)
+    : QWidget(parent)
+    , portSession(session)
+    , config(serialConfig)
+    , lastSentBytes(0)
+    , lastReceivedBytes(0)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    portCombo = new QComboBox(this);
+    portCombo->setEditable(true);   // 可直接输入未列出的设备路径
+    portCombo->setMinimumWidth(110);
+    refreshPorts();
+    baudCombo = new QComboBox(this);
+    baudCombo->setEditable(true);
+    for (const char *rate : BAUD_RATES) {
+        baudCombo->addItem(rate);
+    }
+    baudCombo->setCurrentText(QString::number(config.baudRate));
+    openButton = new QPushButton("打开", this);
+    hexCheck = new QCheckBox("16进制", this);
+    hexCheck->setChecked(config.hexDisplay);
+    timestampCheck = new QCheckBox("时间戳", this);
+    timestampCheck->setChecked(config.timestampDisplay);
+    recordButton = new QPushButton("录制", this);
+    QPushButton *clearButton = new QPushButton("清空", this);
+    QPushButton *closeButton = new QPushButton("移除", this);
+    controls->addWidget(portCombo);
+    controls->addWidget(baudCombo);
+    controls->addWidget(openButton);
+    controls->addWidget(hexCheck);
+    controls->addWidget(timestampCheck);
+    controls->addStretch();
+    controls->addWidget(recordButton);
+    controls->addWidget(clearButton);
+    controls->addWidget(closeButton);
+    layout->addLayout(controls);
+
+    logView = new LogView(this);
+    logView->setRetentionLimits(config.logMaxLines, qint64(config.logMaxMegabytes) * 1024 * 1024);
+    layout->addWidget(logView, 1);
+
+    statsLabel = new QLabel(this);
+    layout->addWidget(statsLabel);
+
+    portSession->setDisplayOptions(hexCheck->isChecked(), timestampCheck->isChecked());
+    connect(hexCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        portSession->setDisplayOptions(checked, timestampCheck->isChecked());
+    });
+    connect(timestampCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        portSession->setDisplayOptions(hexCheck->isChecked(), checked);
+    });
+    connect(openButton, &QPushButton::clicked, this, &SessionPanel::onOpenClicked);
+    connect(recordButton, &QPushButton::clicked, this, &SessionPanel::onRecordClicked);
+    connect(clearButton, &QPushButton::clicked, logView, &LogView::clear);
+    connect(closeButton, &QPushButton::clicked, this, [this]() { emit closeRequested(this); });
+    connect(portSession, &PortSession::errorOccurred, this, &SessionPanel::onSessionError);
+}
+
+PortSession *SessionPanel::session() const
+{
+    return portSession;
+}
+
+QString SessionPanel::title() const
+{
+    if (portSession->isOpen()) {
+        return portSession->portName();
+    }
+    return QString("会话 %1").arg(portSession->id());
+}
+
+void SessionPanel::flushDisplay()
+{
+    static PerfHistogram *flushHistogram = PerfMetrics::instance().renderFlushHistogram();
+
+    const QString text = portSession->takeDisplayText();
+    if (!text.isEmpty()) {
+        const qint64 start = PerfMetrics::nowNs();
+        logView->appendText(text);
+        flushHistogram->record(quint64(PerfMetrics::nowNs() - start) / 1000);
+    }
+}
+
+void SessionPanel::updateStats(qint64 elapsedMs)
+{
+    const SessionStats s = portSession->stats();
+    const double seconds = elapsedMs > 0 ? elapsedMs / 1000.0 : 1.0;
+    const qint64 rxRate = qRound64((s.receivedBytes - lastReceivedBytes) / seconds);
+    const qint64 txRate = qRound64((s.sentBytes - lastSentBytes) / seconds);
+    lastReceivedBytes = s.receivedBytes;
+    lastSentBytes = s.sentBytes;
+
+    QString text = QString("RX：%1 B/s（共 %2）  TX：%3 B/s（共 %4）")
+                   .arg(rxRate).arg(s.receivedBytes).arg(txRate).arg(s.sentBytes);
+    if (s.overrunBytes > 0) {
+        text += QString("  溢出：%1").arg(s.overrunBytes);
+    }
+    if (portSession->isCapturing()) {
+        text += QString("  录制：%1 字节").arg(portSession->captureWriter()->recordedBytes());
+    }
+    statsLabel->setText(text);
+}
+
+void SessionPanel::onOpenClicked()
+{
+    if (portSession->isOpen()) {
+        portSession->close();
+    } else {
+        const QString portName = portCombo->currentText().trimmed();
+        if (portName.isEmpty()) {
+            QMessageBox::warning(this, "警告", "请选择有效的串口！");
+            return;
+        }
+        if (!portSession->open(portName, baudCombo->currentText().toInt())) {
+            QMessageBox::warning(this, "错误", QString("串口 %1 打开失败！\n错误信息：%2")
+                                 .arg(portName).arg(portSession->errorString()));
+            return;
+        }
+    }
+
+    const bool open = portSession->isOpen();
+    openButton->setText(open ? "关闭" : "打开");
+    portCombo->setEnabled(!open);
+    baudCombo->setEnabled(!open);
+    emit titleChanged();
+}
+
+void SessionPanel::onRecordClicked()
+{
+    if (portSession->isCapturing()) {
+        portSession->stopCapture();
+        recordButton->setText("录制");
+        return;
+    }
+
+    const QString dir = config.captureDirectory.isEmpty() ?
+        QStandardPaths::writableLocation(QStandardPaths::DesktopLocation) : config.captureDirectory;
+    if (!portSession->startCapture(SessionManager::captureOptions(config, dir))) {
+        QMessageBox::warning(this, "错误", QString("无法开始录制！\n%1")
+                             .arg(portSession->captureWriter()->errorString()));
+        return;
+    }
+    recordButton->setText("停止录制");
+}
+
+void SessionPanel::onSessionError(const QString &errorString)
+{
+    // 多个串口同时监控时不弹窗，错误写入该会话的日志
+    portSession->close();
+    logView->appendText(QString("\n*** 串口错误：%1，串口已关闭 ***\n").arg(errorString));
+    openButton->setText("打开");
+    portCombo->setEnabled(true);
+    baudCombo->setEnabled(true);
+    emit titleChanged();
+}
+
+void SessionPanel::refreshPorts()
+{
+    const QString current = portCombo->currentText();
+    portCombo->clear();
+    const auto infos = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : infos) {
+        portCombo->addItem(info.portName());
+    }
+    if (!current.isEmpty()) {
+        portCombo->setCurrentText(current);
+    }
+}
+
+MultiPortWindow::MultiPortWindow(SessionManager *manager, const SerialPortConfig &serialConfig, QWidget *parent)
+    : QWidget(parent, Qt::Window)
+    , sessionManager(manager)
+    , config(serialConfig)
+    , viewMode(TabView)
+    , lastTotalSent(0)
+    , lastTotalReceived(0)
+{
+    setWindowTitle("多串口监控");
+    resize(1200, 800);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    QHBoxLayout *toolbar = new QHBoxLayout();
+    QPushButton *addButton = new QPushButton("添加串口", this);
+    viewCombo = new QComboBox(this);
+    viewCombo->addItem("标签页");
+    viewCombo->addItem("平铺");
+    totalLabel = new QLabel(this);
+    toolbar->addWidget(addButton);
+    toolbar->addWidget(new QLabel("视图：", this));
+    toolbar->addWidget(viewCombo);
+    toolbar->addStretch();
+    toolbar->addWidget(totalLabel);
+    layout->addLayout(toolbar);
+
+    tabWidget = new QTabWidget(this);
+    layout->addWidget(tabWidget, 1);
+
+    tileContainer = new QWidget();
+    tileLayout = new QGridLayout(tileContainer);
+    tileArea = new QScrollArea(this);
+    tileArea->setWidgetResizable(true);
+    tileArea->setWidget(tileContainer);
+    tileArea->hide();
+    layout->addWidget(tileArea, 1);
+
+    connect(addButton, &QPushButton::clicked, this, &MultiPortWindow::onAddSession);
+    connect(viewCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        setViewMode(index == 0 ? TabView : TileView);
+    });
+
+    frameTimer = new QTimer(this);
+    frameTimer->setInterval(1000 / qMax(1, config.renderFps));
+    connect(frameTimer, &QTimer::timeout, this, &MultiPortWindow::onFrame);
+    frameTimer->start();
+
+    statsTimer = new QTimer(this);
+    statsTimer->setInterval(500);
+    connect(statsTimer, &QTimer::timeout, this, &MultiPortWindow::onStatsTimeout);
+    statsTimer->start();
+    statsClock.start();
+
+    // 已存在的会话（窗口重新创建时）
+    const QList<PortSession *> sessions = sessionManager->sessions();
+    for (PortSession *session : sessions) {
+        addPanel(session);
+    }
+    layoutPanels();
+}
+
+MultiPortWindow::~MultiPortWindow()
+{
+    frameTimer->stop();
+    statsTimer->stop();
+}
+
+void MultiPortWindow::setViewMode(ViewMode mode)
+{
+    if (mode == viewMode) {
+        return;
+    }
+    viewMode = mode;
+    viewCombo->setCurrentIndex(mode == TabView ? 0 : 1);
+    layoutPanels();
+}
+
+void MultiPortWindow::onAddSession()
+{
+    PortSession *session = sessionManager->createSession();
+    if (!session) {
+        QMessageBox::warning(this, "警告", "会话数已达上限！");
+        return;
+    }
+
+    SessionPanel *panel = addPanel(session);
+    layoutPanels();
+    if (viewMode == TabView) {
+        tabWidget->setCurrentWidget(panel);
+    }
+}
+
+SessionPanel *MultiPortWindow::addPanel(PortSession *session)
+{
+    SessionPanel *panel = new SessionPanel(session, config, this);
+    connect(panel, &SessionPanel::closeRequested, this, &MultiPortWindow::onPanelCloseRequested);
+    connect(panel, &SessionPanel::titleChanged, this, [this, panel]() {
+        const int index = tabWidget->indexOf(panel);
+        if (index >= 0) {
+            tabWidget->setTabText(index, panel->title());
+        }
+    });
+    panels.append(panel);
+    return panel;
+}
+
+void MultiPortWindow::onFrame()
+{
+    // 每帧每个会话最多追加一次
+    for (SessionPanel *panel : panels) {
+        panel->flushDisplay();
+    }
+}
+
+void MultiPortWindow::onStatsTimeout()
+{
+    const qint64 elapsedMs = statsClock.restart();
+    for (SessionPanel *panel : panels) {
+        panel->updateStats(elapsedMs);
+    }
+
+    const SessionStats total = sessionManager->totalStats();
+    const double seconds = elapsedMs > 0 ? elapsedMs / 1000.0 : 1.0;
+    totalLabel->setText(QString("会话：%1  总RX：%2 B/s  总TX：%3 B/s")
+                        .arg(sessionManager->sessionCount())
+                        .arg(qRound64((total.receivedBytes - lastTotalReceived) / seconds))
+                        .arg(qRound64((total.sentBytes - lastTotalSent) / seconds)));
+    lastTotalReceived = total.receivedBytes;
+    lastTotalSent = total.sentBytes;
+}
+
+void MultiPortWindow::onPanelCloseRequested(SessionPanel *panel)
+{
+    if (!panels.removeOne(panel)) {
+        return;
+    }
+
+    const int index = tabWidget->indexOf(panel);
+    if (index >= 0) {
+        tabWidget->removeTab(index);
+    }
+    tileLayout->removeWidget(panel);
+    panel->hide();
+
+    // 面板在自己的信号处理中发出请求，延迟释放；会话立即关闭串口并结束I/O线程
+    PortSession *session = panel->session();
+    panel->deleteLater();
+    sessionManager->removeSession(session);
+
+    // 移除后总计数减少，重新计算速率基准
+    const SessionStats total = sessionManager->totalStats();
+    lastTotalReceived = total.receivedBytes;
+    lastTotalSent = total.sentBytes;
+    layoutPanels();
+}
+
+void MultiPortWindow::layoutPanels()
+{
+    // 面板在标签页和平铺容器之间移动，会话和日志保持不变
+    if (viewMode == TabView) {
+        for (SessionPanel *panel : panels) {
+            tileLayout->removeWidget(panel);
+            if (tabWidget->indexOf(panel) < 0) {
+                tabWidget->addTab(panel, panel->title());
+            }
+        }
+        tileArea->hide();
+        tabWidget->show();
+    } else {
+        while (tabWidget->count() > 0) {
+            tabWidget->removeTab(0);
+        }
+        for (SessionPanel *panel : panels) {
+            tileLayout->removeWidget(panel);
+        }
+        const int columns = qMax(1, qCeil(qSqrt(double(panels.size()))));
+        for (int i = 0; i < panels.size(); ++i) {
+            tileLayout->addWidget(panels[i], i / columns, i % columns);
+            panels[i]->show();
+        }
+        tabWidget->hide();
+        tileArea->show();
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef MULTIPORTWINDOW_H
+#define MULTIPORTWINDOW_H
+
+#include <QWidget>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTabWidget>
+#include <QGridLayout>
+#include <QScrollArea>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "sessionmanager.h"
+#include "logview.h"
+
+// 单个串口会话的面板：端口/波特率选择、打开关闭、录制、接收日志和统计
+class SessionPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    SessionPanel(PortSession *session, const SerialPortConfig &config, QWidget *parent = nullptr);
+
+    PortSession *session() const;
+    QString title() const;
+
+    // 由窗口的公共帧定时器调用：取走会话已格式化的文本并追加一次
+    void flushDisplay();
+    // 刷新统计，elapsedMs 为距上次刷新的时间
+    void updateStats(qint64 elapsedMs);
+
+signals:
+    void titleChanged();
+    void closeRequested(SessionPanel *panel);
+
+private slots:
+    void onOpenClicked();
+    void onRecordClicked();
+    void onSessionError(const QString &errorString);
+
+private:
+    PortSession *portSession;
+    SerialPortConfig config;
+
+    QComboBox *portCombo;
+    QComboBox *baudCombo;
+    QPushButton *openButton;
+    QCheckBox *hexCheck;
+    QCheckBox *timestampCheck;
+    QPushButton *recordButton;
+    QLabel *statsLabel;
+    LogView *logView;
+
+    qint64 lastSentBytes;
+    qint64 lastReceivedBytes;
+
+    void refreshPorts();
+};
+
+// 多串口监控窗口
+// 每个会话一个面板，可切换标签页或平铺显示；所有面板共用一个按帧率运行的刷新定时器，
+// GUI线程每帧对每个会话只做一次追加，解码和格式化在各会话自己的I/O线程完成。
+class MultiPortWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum ViewMode {
+        TabView,
+        TileView
+    };
+
+    MultiPortWindow(SessionManager *manager, const SerialPortConfig &config, QWidget *parent = nullptr);
+    ~MultiPortWindow();
+
+    void setViewMode(ViewMode mode);
+
+private slots:
+    void onAddSession();
+    void onFrame();
+    void onStatsTimeout();
+    void onPanelCloseRequested(SessionPanel *panel);
+
+private:
+    SessionManager *sessionManager;
+    SerialPortConfig config;
+    ViewMode viewMode;
+
+    QComboBox *viewCombo;
+    QLabel *totalLabel;
+    QTabWidget *tabWidget;
+    QScrollArea *tileArea;
+    QWidget *tileContainer;
+    QGridLayout *tileLayout;
+    QList<SessionPanel *> panels;
+
+    QTimer *frameTimer;     // 所有会话共用的显示刷新定时器
+    QTimer *statsTimer;
+    QElapsedTimer statsClock;
+    qint64 lastTotalSent;
+    qint64 lastTotalReceived;
+
+    SessionPanel *addPanel(PortSession *session);
+    void layoutPanels();
+};
+
+#endif // MULTIPORTWINDOW_H
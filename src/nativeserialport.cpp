@@ -0,0 +1,471 @@
+#include "nativeserialport.h"
+#include <QMutexLocker>
+
+#if defined(Q_OS_LINUX)
+#include <termios.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <linux/serial.h>
+#define NATIVESERIALPORT_SUPPORTED 1
+#endif
+
+// Throughput 方式暂停接收通知的时长：约为收满2KB的时间，限制在 200us ~ 2ms 之间，
+// 上限保证内核缓冲（n_tty 4KB）在最高波特率下也不会溢出
+static const qint64 BATCH_BYTES = 2048;
+static const qint64 MIN_BATCH_DELAY_NS = 200000;
+static const qint64 MAX_BATCH_DELAY_NS = 2000000;
+
+NativePortSettings::Profile NativePortSettings::profileFromString(const QString &profile)
+{
+    return profile == "throughput" ? Throughput : LowLatency;
+}
+
+QString NativePortSettings::profileToString(Profile profile)
+{
+    return profile == Throughput ? "throughput" : "latency";
+}
+
+#ifdef NATIVESERIALPORT_SUPPORTED
+// 标准波特率对应的 termios 速率常量，不支持返回0
+static speed_t baudToSpeed(int baudRate)
+{
+    switch (baudRate) {
+    case 1200: return B1200;
+    case 2400: return B2400;
+    case 4800: return B4800;
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 500000: return B500000;
+    case 576000: return B576000;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 1152000: return B1152000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 2500000: return B2500000;
+    case 3000000: return B3000000;
+    case 3500000: return B3500000;
+    case 4000000: return B4000000;
+    default: return 0;
+    }
+}
+
+static QString systemError()
+{
+    return QString::fromLocal8Bit(strerror(errno));
+}
+#endif
+
+NativeSerialPort::NativeSerialPort()
+    : fd(-1)
+    , epollFd(-1)
+    , wakeFd(-1)
+    , batchTimerFd(-1)
+    , savedSerialFlags(-1)
+    , buffer(nullptr)
+    , bufferSize(0)
+    , ioThread(nullptr)
+    , stopRequested(false)
+    , writeOffset(0)
+    , waitingWritable(false)
+    , receiveArmed(true)
+    , batchDelayNs(MIN_BATCH_DELAY_NS)
+{
+}
+
+NativeSerialPort::~NativeSerialPort()
+{
+    close();
+}
+
+bool NativeSerialPort::isSupported()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NativeSerialPort::open(const QString &portName, const NativePortSettings &settings,
+                            char *readBuffer, qsizetype readBufferSize, const Callbacks &callbacks)
+{
+    close();
+
+#ifdef NATIVESERIALPORT_SUPPORTED
+    setError(QString());
+    portSettings = settings;
+    buffer = readBuffer;
+    bufferSize = readBufferSize;
+    handlers = callbacks;
+
+    // QSerialPortInfo 给出的是不带目录的设备名
+    const QString path = portName.startsWith(QChar('/')) ? portName : "/dev/" + portName;
+    fd = ::open(path.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        setError(QString("打开 %1 失败：%2").arg(path, systemError()));
+        return false;
+    }
+    // 与 QSerialPort 一致，独占打开
+    ioctl(fd, TIOCEXCL);
+
+    const speed_t speed = baudToSpeed(settings.baudRate);
+    if (speed == 0) {
+        setError(QString("原生后端不支持波特率 %1").arg(settings.baudRate));
+        closeDescriptors();
+        return false;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        setError(QString("读取串口参数失败：%1").arg(systemError()));
+        closeDescriptors();
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSIZE | CSTOPB | PARENB | PARODD | CRTSCTS);
+    switch (settings.dataBits) {
+    case 5: tio.c_cflag |= CS5; break;
+    case 6: tio.c_cflag |= CS6; break;
+    case 7: tio.c_cflag |= CS7; break;
+    default: tio.c_cflag |= CS8; break;
+    }
+    if (settings.stopBits == 2) {
+        tio.c_cflag |= CSTOPB;
+    }
+    if (settings.parity == 'E') {
+        tio.c_cflag |= PARENB;
+    } else if (settings.parity == 'O') {
+        tio.c_cflag |= PARENB | PARODD;
+    }
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    if (settings.flowControl == NativePortSettings::HardwareControl) {
+        tio.c_cflag |= CRTSCTS;
+    } else if (settings.flowControl == NativePortSettings::SoftwareControl) {
+        // 收到 XOFF 后内核暂停输出，write() 返回 EAGAIN，等 XON 后 EPOLLOUT 再继续；
+        // 不设 IXANY，只有 XON 能恢复发送
+        tio.c_iflag |= IXON | IXOFF;
+        tio.c_cc[VSTART] = 0x11;
+        tio.c_cc[VSTOP] = 0x13;
+    }
+    // 非阻塞读取：VMIN/VTIME 均为0，read() 立即返回内核中已有的全部数据；
+    // VMIN 最大只有255字节，批量读取由 Throughput 方式的暂停通知实现
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        setError(QString("设置串口参数失败：%1").arg(systemError()));
+        closeDescriptors();
+        return false;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    // USB 转串口等驱动默认会攒一段时间再上报接收数据，低延迟方式请求立即上报；伪终端等不支持时忽略
+    // 原来的标志在关闭时恢复，不影响之后使用该串口的其他程序
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        savedSerialFlags = serial.flags;
+        if (settings.profile == NativePortSettings::LowLatency) {
+            serial.flags |= ASYNC_LOW_LATENCY;
+        } else {
+            serial.flags &= ~ASYNC_LOW_LATENCY;
+        }
+        ioctl(fd, TIOCSSERIAL, &serial);
+    }
+
+    const int bitsPerChar = 1 + settings.dataBits + (settings.parity == 'N' ? 0 : 1) + settings.stopBits;
+    batchDelayNs = qBound(MIN_BATCH_DELAY_NS,
+                          BATCH_BYTES * bitsPerChar * 1000000000LL / qMax(1, settings.baudRate),
+                          MAX_BATCH_DELAY_NS);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    {
+        QMutexLocker locker(&mutex);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    batchTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0 || batchTimerFd < 0) {
+        setError(QString("创建事件通知失败：%1").arg(systemError()));
+        closeDescriptors();
+        return false;
+    }
+
+    receiveArmed = true;
+    waitingWritable = false;
+    writing.clear();
+    writeOffset = 0;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    event.data.fd = batchTimerFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, batchTimerFd, &event);
+
+    stopRequested = false;
+    ioThread = QThread::create([this]() { run(); });
+    ioThread->setObjectName("NativeSerialPort");
+    ioThread->start(settings.profile == NativePortSettings::LowLatency ?
+                    QThread::TimeCriticalPriority : QThread::HighestPriority);
+    return true;
+#else
+    Q_UNUSED(portName);
+    Q_UNUSED(settings);
+    Q_UNUSED(readBuffer);
+    Q_UNUSED(readBufferSize);
+    Q_UNUSED(callbacks);
+    setError("当前平台不支持原生串口后端");
+    return false;
+#endif
+}
+
+void NativeSerialPort::close()
+{
+    if (ioThread) {
+        stopRequested = true;
+        wakeForWrite();
+        ioThread->wait();
+        delete ioThread;
+        ioThread = nullptr;
+    }
+    closeDescriptors();
+    writing.clear();
+    writeOffset = 0;
+}
+
+void NativeSerialPort::closeDescriptors()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    if (fd >= 0 && savedSerialFlags >= 0) {
+        struct serial_struct serial;
+        if (ioctl(fd, TIOCGSERIAL, &serial) == 0 && serial.flags != savedSerialFlags) {
+            serial.flags = savedSerialFlags;
+            ioctl(fd, TIOCSSERIAL, &serial);
+        }
+    }
+    savedSerialFlags = -1;
+
+    {
+        // 其他线程可能正在 wakeForWrite()，关闭和置-1在锁内完成，不会写到已关闭或被复用的描述符
+        QMutexLocker locker(&mutex);
+        if (wakeFd >= 0) {
+            ::close(wakeFd);
+            wakeFd = -1;
+        }
+    }
+    for (int *descriptor : {&fd, &epollFd, &batchTimerFd}) {
+        if (*descriptor >= 0) {
+            ::close(*descriptor);
+            *descriptor = -1;
+        }
+    }
+#endif
+}
+
+bool NativeSerialPort::isOpen() const
+{
+    return fd >= 0;
+}
+
+QString NativeSerialPort::errorString() const
+{
+    QMutexLocker locker(&mutex);
+    return lastError;
+}
+
+void NativeSerialPort::setError(const QString &errorString)
+{
+    QMutexLocker locker(&mutex);
+    lastError = errorString;
+}
+
+void NativeSerialPort::wakeForWrite()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    QMutexLocker locker(&mutex);
+    if (wakeFd >= 0) {
+        const quint64 one = 1;
+        const ssize_t n = ::write(wakeFd, &one, sizeof(one));
+        Q_UNUSED(n);
+    }
+#endif
+}
+
+qint64 NativeSerialPort::bytesToWrite() const
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    int pending = 0;
+    if (fd >= 0 && ioctl(fd, TIOCOUTQ, &pending) == 0) {
+        return pending;
+    }
+#endif
+    return 0;
+}
+
+void NativeSerialPort::run()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    struct epoll_event events[4];
+    while (!stopRequested) {
+        const int ready = epoll_wait(epollFd, events, 4, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(QString("等待串口事件失败：%1").arg(systemError()));
+            break;
+        }
+
+        for (int i = 0; i < ready && !stopRequested; ++i) {
+            const int source = events[i].data.fd;
+            const quint32 flags = events[i].events;
+            quint64 counter = 0;
+
+            if (source == wakeFd) {
+                const ssize_t n = ::read(wakeFd, &counter, sizeof(counter));
+                Q_UNUSED(n);
+                writePending();
+            } else if (source == batchTimerFd) {
+                const ssize_t n = ::read(batchTimerFd, &counter, sizeof(counter));
+                Q_UNUSED(n);
+                receiveArmed = true;
+                updateInterest();
+            } else if (source == fd) {
+                if (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    if (!readAvailable()) {
+                        break;
+                    }
+                    if (flags & (EPOLLHUP | EPOLLERR)) {
+                        fail("设备资源不可用，设备可能被意外移除");
+                        break;
+                    }
+                    if (portSettings.profile == NativePortSettings::Throughput) {
+                        // 暂停接收通知，让数据在内核中积累，到时由 timerfd 恢复
+                        struct itimerspec timer;
+                        memset(&timer, 0, sizeof(timer));
+                        timer.it_value.tv_sec = batchDelayNs / 1000000000;
+                        timer.it_value.tv_nsec = batchDelayNs % 1000000000;
+                        timerfd_settime(batchTimerFd, 0, &timer, nullptr);
+                        receiveArmed = false;
+                        updateInterest();
+                    }
+                }
+                if ((flags & EPOLLOUT) && !stopRequested) {
+                    writePending();
+                }
+            }
+        }
+    }
+
+    // 正常关闭前把内核中剩余的数据读出
+    if (errorString().isEmpty()) {
+        readAvailable();
+    }
+#endif
+}
+
+bool NativeSerialPort::readAvailable()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    bool received = false;
+    while (true) {
+        const ssize_t n = ::read(fd, buffer, size_t(bufferSize));
+        if (n > 0) {
+            handlers.received(buffer, qsizetype(n));
+            received = true;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            const QString error = QString("数据读取失败：%1").arg(systemError());
+            if (received) {
+                handlers.receiveFinished();
+            }
+            fail(error);
+            return false;
+        }
+        break;
+    }
+    if (received) {
+        handlers.receiveFinished();
+    }
+#endif
+    return true;
+}
+
+bool NativeSerialPort::writePending()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    while (true) {
+        if (writeOffset >= writing.size()) {
+            writing.clear();
+            writeOffset = 0;
+            if (!handlers.takeSendData(&writing)) {
+                break;
+            }
+        }
+
+        const ssize_t n = ::write(fd, writing.constData() + writeOffset, size_t(writing.size() - writeOffset));
+        if (n > 0) {
+            handlers.written(writing.constData() + writeOffset, qsizetype(n));
+            writeOffset += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 驱动写缓冲已满，等可写时继续；其余数据留在调用方的发送队列中
+            if (!waitingWritable) {
+                waitingWritable = true;
+                updateInterest();
+            }
+            return true;
+        } else {
+            fail(QString("数据写入失败：%1").arg(systemError()));
+            return false;
+        }
+    }
+
+    if (waitingWritable) {
+        waitingWritable = false;
+        updateInterest();
+    }
+#endif
+    return true;
+}
+
+void NativeSerialPort::updateInterest()
+{
+#ifdef NATIVESERIALPORT_SUPPORTED
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = (receiveArmed ? quint32(EPOLLIN) : 0u) | (waitingWritable ? quint32(EPOLLOUT) : 0u);
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+#endif
+}
+
+void NativeSerialPort::fail(const QString &errorString)
+{
+    setError(errorString);
+    stopRequested = true;
+    if (handlers.errorOccurred) {
+        handlers.errorOccurred(errorString);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef NATIVESERIALPORT_H
+#define NATIVESERIALPORT_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+
+// 原生串口参数
+struct NativePortSettings {
+    enum Profile {
+        LowLatency,     // 数据一到就读，并请求驱动关闭接收缓冲的延迟推送（ASYNC_LOW_LATENCY）
+        Throughput      // 读完一批后暂停接收通知一小段时间，让数据在内核中积累，每次唤醒读更多
+    };
+    enum FlowControl {
+        NoFlowControl,
+        HardwareControl,    // RTS/CTS
+        SoftwareControl     // XON/XOFF，由内核收发控制字符并暂停/恢复发送
+    };
+
+    int baudRate;
+    int dataBits;
+    int stopBits;
+    char parity;            // 'N' / 'E' / 'O'
+    FlowControl flowControl;
+    Profile profile;
+
+    NativePortSettings() {
+        baudRate = 115200;
+        dataBits = 8;
+        stopBits = 1;
+        parity = 'N';
+        flowControl = NoFlowControl;
+        profile = LowLatency;
+    }
+
+    // 配置字符串：latency / throughput
+    static Profile profileFromString(const QString &profile);
+    static QString profileToString(Profile profile);
+};
+
+// Linux 原生串口后端
+// 直接用 termios 配置为原始模式，由独立线程 epoll 等待接收/可写/唤醒事件，
+// 读取时一次 read() 尽量多的数据到调用方提供的缓冲区。不经过 Qt 事件循环，
+// 唤醒次数和延迟由所选的调优方式决定。其他平台 isSupported() 返回 false。
+class NativeSerialPort
+{
+public:
+    // 回调都在后端线程中调用
+    struct Callbacks {
+        std::function<void(const char *data, qsizetype len)> received;     // 一次 read() 读到的数据
+        std::function<void()> receiveFinished;                              // 一次唤醒中的读取结束
+        std::function<bool(QByteArray *data)> takeSendData;                 // 取下一段待发送数据，无数据返回false
+        std::function<void(const char *data, qsizetype len)> written;       // 已写入驱动的数据
+        std::function<void(const QString &errorString)> errorOccurred;      // 致命错误，之后后端线程退出
+    };
+
+    NativeSerialPort();
+    ~NativeSerialPort();
+
+    static bool isSupported();
+
+    // readBuffer 由调用方持有，关闭前必须一直有效
+    bool open(const QString &portName, const NativePortSettings &settings,
+              char *readBuffer, qsizetype readBufferSize, const Callbacks &callbacks);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    // 有新的待发送数据，唤醒后端线程（任意线程调用）
+    void wakeForWrite();
+    // 驱动输出队列中尚未发出的字节数
+    qint64 bytesToWrite() const;
+
+private:
+    int fd;
+    int epollFd;
+    int wakeFd;                 // eventfd，发送和关闭时唤醒后端线程
+    int batchTimerFd;           // timerfd，Throughput 方式下恢复接收通知
+    int savedSerialFlags;       // 打开时驱动的 serial_struct 标志，关闭时恢复；-1 为未修改
+    NativePortSettings portSettings;
+    char *buffer;
+    qsizetype bufferSize;
+    Callbacks handlers;
+    QString lastError;
+    mutable QMutex mutex;       // 保护 lastError 和 wakeFd 的创建/关闭（wakeForWrite 可在任意线程调用）
+    QThread *ioThread;
+    std::atomic<bool> stopRequested;
+
+    QByteArray writing;         // 正在写入的数据段
+    qsizetype writeOffset;
+    bool waitingWritable;       // 驱动写缓冲已满，等待 EPOLLOUT
+    bool receiveArmed;          // 是否关注 EPOLLIN
+    qint64 batchDelayNs;        // Throughput 方式下两次读取之间的最短间隔
+
+    void closeDescriptors();
+    void setError(const QString &errorString);
+    void run();
+    bool readAvailable();
+    bool writePending();
+    void updateInterest();
+    void fail(const QString &errorString);
+};
+
+#endif // NATIVESERIALPORT_H
@@ -0,0 +1,380 @@
+#include "perfmetrics.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+#include <chrono>
+
+PerfMetric::PerfMetric(const QString &name, const QString &unit, const QString &description)
+    : metricName(name)
+    , metricUnit(unit)
+    , metricDescription(description)
+{
+}
+
+PerfMetric::~PerfMetric()
+{
+}
+
+QString PerfMetric::name() const
+{
+    return metricName;
+}
+
+QString PerfMetric::unit() const
+{
+    return metricUnit;
+}
+
+QString PerfMetric::description() const
+{
+    return metricDescription;
+}
+
+PerfCounter::PerfCounter(const QString &name, const QString &unit, const QString &description)
+    : PerfMetric(name, unit, description)
+    , count(0)
+{
+}
+
+quint64 PerfCounter::value() const
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+PerfMetric::Kind PerfCounter::kind() const
+{
+    return Counter;
+}
+
+QJsonObject PerfCounter::toJson() const
+{
+    QJsonObject json;
+    json["type"] = "counter";
+    json["unit"] = unit();
+    json["value"] = double(value());
+    return json;
+}
+
+void PerfCounter::reset()
+{
+    count = 0;
+}
+
+PerfGauge::PerfGauge(const QString &name, const QString &unit, const QString &description)
+    : PerfMetric(name, unit, description)
+    , current(0)
+    , maximum(0)
+{
+}
+
+void PerfGauge::set(qint64 value)
+{
+    current.store(value, std::memory_order_relaxed);
+    qint64 peakValue = maximum.load(std::memory_order_relaxed);
+    while (value > peakValue && !maximum.compare_exchange_weak(peakValue, value, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 PerfGauge::value() const
+{
+    return current.load(std::memory_order_relaxed);
+}
+
+qint64 PerfGauge::peak() const
+{
+    return maximum.load(std::memory_order_relaxed);
+}
+
+PerfMetric::Kind PerfGauge::kind() const
+{
+    return Gauge;
+}
+
+QJsonObject PerfGauge::toJson() const
+{
+    QJsonObject json;
+    json["type"] = "gauge";
+    json["unit"] = unit();
+    json["value"] = double(value());
+    json["peak"] = double(peak());
+    return json;
+}
+
+void PerfGauge::reset()
+{
+    // 峰值从当前值重新开始
+    maximum = current.load(std::memory_order_relaxed);
+}
+
+PerfHistogram::PerfHistogram(const QString &name, const QString &unit, const QString &description)
+    : PerfMetric(name, unit, description)
+    , samples(0)
+    , total(0)
+    , maximum(0)
+{
+    for (std::atomic<quint64> &bucket : buckets) {
+        bucket = 0;
+    }
+}
+
+int PerfHistogram::bucketIndex(quint64 value)
+{
+    if (value < SubBuckets) {
+        return int(value);
+    }
+    // 最高位决定区间，其后两位决定区间内的档
+    const int exponent = 63 - qCountLeadingZeroBits(value);
+    const int mantissa = int((value >> (exponent - 2)) & 3);
+    return SubBuckets + (exponent - 2) * SubBuckets + mantissa;
+}
+
+quint64 PerfHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBuckets) {
+        return quint64(index);
+    }
+    const int exponent = (index - SubBuckets) / SubBuckets + 2;
+    const quint64 mantissa = quint64((index - SubBuckets) % SubBuckets);
+    const quint64 lower = (SubBuckets + mantissa) << (exponent - 2);
+    return lower + ((quint64(1) << (exponent - 2)) - 1);
+}
+
+void PerfHistogram::record(quint64 value)
+{
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+    quint64 peakValue = maximum.load(std::memory_order_relaxed);
+    while (value > peakValue && !maximum.compare_exchange_weak(peakValue, value, std::memory_order_relaxed)) {
+    }
+}
+
+quint64 PerfHistogram::count() const
+{
+    return samples.load(std::memory_order_relaxed);
+}
+
+quint64 PerfHistogram::sum() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+quint64 PerfHistogram::peak() const
+{
+    return maximum.load(std::memory_order_relaxed);
+}
+
+double PerfHistogram::mean() const
+{
+    const quint64 n = count();
+    return n > 0 ? double(sum()) / double(n) : 0.0;
+}
+
+quint64 PerfHistogram::percentile(double p) const
+{
+    // 各桶分别读取，记录并发进行时结果是近似值
+    quint64 counts[BucketCount];
+    quint64 n = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        n += counts[i];
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    const quint64 rank = qMax<quint64>(1, quint64(p / 100.0 * double(n) + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return qMin(bucketUpperBound(i), peak());
+        }
+    }
+    return peak();
+}
+
+PerfMetric::Kind PerfHistogram::kind() const
+{
+    return Histogram;
+}
+
+QJsonObject PerfHistogram::toJson() const
+{
+    QJsonObject json;
+    json["type"] = "histogram";
+    json["unit"] = unit();
+    json["count"] = double(count());
+    json["sum"] = double(sum());
+    json["mean"] = mean();
+    json["p50"] = double(percentile(50));
+    json["p90"] = double(percentile(90));
+    json["p99"] = double(percentile(99));
+    json["max"] = double(peak());
+    return json;
+}
+
+void PerfHistogram::reset()
+{
+    for (std::atomic<quint64> &bucket : buckets) {
+        bucket = 0;
+    }
+    samples = 0;
+    total = 0;
+    maximum = 0;
+}
+
+PerfMetrics::PerfMetrics()
+{
+}
+
+PerfMetrics::~PerfMetrics()
+{
+    qDeleteAll(registry);
+    registry.clear();
+}
+
+PerfMetrics &PerfMetrics::instance()
+{
+    static PerfMetrics metrics;
+    return metrics;
+}
+
+qint64 PerfMetrics::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 PerfMetrics::toWallClockNs(qint64 monotonicNs)
+{
+    static const qint64 offsetNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() - nowNs();
+    return monotonicNs + offsetNs;
+}
+
+PerfMetric *PerfMetrics::find(const QString &name, PerfMetric::Kind kind) const
+{
+    PerfMetric *metric = registry.value(name, nullptr);
+    // 同名不同类型视为编程错误
+    Q_ASSERT(!metric || metric->kind() == kind);
+    return metric && metric->kind() == kind ? metric : nullptr;
+}
+
+PerfCounter *PerfMetrics::counter(const QString &name, const QString &unit, const QString &description)
+{
+    QMutexLocker locker(&mutex);
+    if (PerfMetric *metric = find(name, PerfMetric::Counter)) {
+        return static_cast<PerfCounter *>(metric);
+    }
+    PerfCounter *metric = new PerfCounter(name, unit, description);
+    registry.insert(name, metric);
+    return metric;
+}
+
+PerfGauge *PerfMetrics::gauge(const QString &name, const QString &unit, const QString &description)
+{
+    QMutexLocker locker(&mutex);
+    if (PerfMetric *metric = find(name, PerfMetric::Gauge)) {
+        return static_cast<PerfGauge *>(metric);
+    }
+    PerfGauge *metric = new PerfGauge(name, unit, description);
+    registry.insert(name, metric);
+    return metric;
+}
+
+PerfHistogram *PerfMetrics::histogram(const QString &name, const QString &unit, const QString &description)
+{
+    QMutexLocker locker(&mutex);
+    if (PerfMetric *metric = find(name, PerfMetric::Histogram)) {
+        return static_cast<PerfHistogram *>(metric);
+    }
+    PerfHistogram *metric = new PerfHistogram(name, unit, description);
+    registry.insert(name, metric);
+    return metric;
+}
+
+PerfHistogram *PerfMetrics::chunkProcessHistogram()
+{
+    return histogram("rx.chunk_process", "us", "每块接收数据取出并格式化的耗时");
+}
+
+PerfHistogram *PerfMetrics::renderFlushHistogram()
+{
+    return histogram("render.flush", "us", "一帧追加到日志视图的耗时");
+}
+
+QList<PerfMetric *> PerfMetrics::metrics() const
+{
+    QMutexLocker locker(&mutex);
+    return registry.values();
+}
+
+QJsonObject PerfMetrics::snapshot() const
+{
+    QJsonObject values;
+    for (PerfMetric *metric : metrics()) {
+        values[metric->name()] = metric->toJson();
+    }
+
+    QJsonObject json;
+    json["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    json["metrics"] = values;
+    return json;
+}
+
+void PerfMetrics::reset()
+{
+    for (PerfMetric *metric : metrics()) {
+        metric->reset();
+    }
+}
+
+PerfMetricsDumper::PerfMetricsDumper(QObject *parent)
+    : QObject(parent)
+    , timer(new QTimer(this))
+{
+    connect(timer, &QTimer::timeout, this, [this]() { dumpNow(); });
+}
+
+void PerfMetricsDumper::start(const QString &filePath, int intervalSeconds)
+{
+    path = filePath;
+    if (intervalSeconds <= 0 || path.isEmpty()) {
+        stop();
+        return;
+    }
+    timer->start(intervalSeconds * 1000);
+}
+
+void PerfMetricsDumper::stop()
+{
+    timer->stop();
+}
+
+bool PerfMetricsDumper::isRunning() const
+{
+    return timer->isActive();
+}
+
+QString PerfMetricsDumper::filePath() const
+{
+    return path;
+}
+
+bool PerfMetricsDumper::dumpNow()
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        // 写失败后停止，避免每个周期重复报错
+        stop();
+        emit errorOccurred(QString("无法写入性能指标文件 %1：%2").arg(path, file.errorString()));
+        return false;
+    }
+    file.write(QJsonDocument(PerfMetrics::instance().snapshot()).toJson(QJsonDocument::Compact));
+    file.write("\n");
+    return true;
+}
@@ -0,0 +1,165 @@
+#ifndef PERFMETRICS_H
+#define PERFMETRICS_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QMutex>
+#include <QJsonObject>
+#include <QTimer>
+#include <atomic>
+
+// 性能指标基类
+// 指标对象注册后一直存在到程序退出，热路径上缓存指针直接累加，只有注册和快照需要加锁。
+class PerfMetric
+{
+public:
+    enum Kind {
+        Counter,    // 只增不减的累计值
+        Gauge,      // 当前值，同时记录峰值
+        Histogram   // 数值分布
+    };
+
+    PerfMetric(const QString &name, const QString &unit, const QString &description);
+    virtual ~PerfMetric();
+
+    QString name() const;
+    QString unit() const;
+    QString description() const;
+
+    virtual Kind kind() const = 0;
+    virtual QJsonObject toJson() const = 0;
+    virtual void reset() = 0;
+
+private:
+    QString metricName;
+    QString metricUnit;
+    QString metricDescription;
+};
+
+class PerfCounter : public PerfMetric
+{
+public:
+    PerfCounter(const QString &name, const QString &unit, const QString &description);
+
+    void add(quint64 n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+    quint64 value() const;
+
+    Kind kind() const override;
+    QJsonObject toJson() const override;
+    void reset() override;
+
+private:
+    std::atomic<quint64> count;
+};
+
+class PerfGauge : public PerfMetric
+{
+public:
+    PerfGauge(const QString &name, const QString &unit, const QString &description);
+
+    void set(qint64 value);
+    qint64 value() const;
+    qint64 peak() const;
+
+    Kind kind() const override;
+    QJsonObject toJson() const override;
+    void reset() override;
+
+private:
+    std::atomic<qint64> current;
+    std::atomic<qint64> maximum;
+};
+
+// 对数分桶直方图：每个2的幂区间再分4档，百分位取所在档的上界，相对误差不超过25%
+class PerfHistogram : public PerfMetric
+{
+public:
+    enum { SubBuckets = 4, BucketCount = 4 + 62 * 4 };
+
+    PerfHistogram(const QString &name, const QString &unit, const QString &description);
+
+    void record(quint64 value);
+
+    quint64 count() const;
+    quint64 sum() const;
+    quint64 peak() const;
+    double mean() const;
+    quint64 percentile(double p) const;
+
+    Kind kind() const override;
+    QJsonObject toJson() const override;
+    void reset() override;
+
+private:
+    std::atomic<quint64> buckets[BucketCount];
+    std::atomic<quint64> samples;
+    std::atomic<quint64> total;
+    std::atomic<quint64> maximum;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketUpperBound(int index);
+};
+
+// 全局指标注册表
+// 同名指标只注册一次，多个串口/会话取到的是同一个对象，数值累计在一起。
+class PerfMetrics
+{
+public:
+    static PerfMetrics &instance();
+
+    PerfCounter *counter(const QString &name, const QString &unit, const QString &description);
+    PerfGauge *gauge(const QString &name, const QString &unit, const QString &description);
+    PerfHistogram *histogram(const QString &name, const QString &unit, const QString &description);
+
+    // 单串口窗口和多串口会话共用的指标，名称和说明只在这里定义一次
+    PerfHistogram *chunkProcessHistogram();     // rx.chunk_process
+    PerfHistogram *renderFlushHistogram();      // render.flush
+
+    QList<PerfMetric *> metrics() const;    // 按名称排序
+    QJsonObject snapshot() const;           // 所有指标的当前值
+    void reset();
+
+    // 单调时钟（纳秒），用于计算阶段耗时
+    static qint64 nowNs();
+    // 单调时钟换算为墙上时间（自1970年起的纳秒），换算偏移在首次调用时确定，之后不随系统时间调整而跳变
+    static qint64 toWallClockNs(qint64 monotonicNs);
+
+private:
+    PerfMetrics();
+    ~PerfMetrics();
+    Q_DISABLE_COPY(PerfMetrics)
+
+    mutable QMutex mutex;
+    QMap<QString, PerfMetric *> registry;
+
+    PerfMetric *find(const QString &name, PerfMetric::Kind kind) const;
+};
+
+// 周期性把指标快照追加到 JSON Lines 文件，每行一个快照
+class PerfMetricsDumper : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PerfMetricsDumper(QObject *parent = nullptr);
+
+    // intervalSeconds 为0时停止
+    void start(const QString &filePath, int intervalSeconds);
+    void stop();
+    bool isRunning() const;
+    QString filePath() const;
+
+    // 立即写一个快照
+    bool dumpNow();
+
+signals:
+    void errorOccurred(const QString &errorString);
+
+private:
+    QTimer *timer;
+    QString path;
+};
+
+#endif // PERFMETRICS_H
@@ -0,0 +1,175 @@
+#include "perfpanel.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QMessageBox>
+#include <QJsonDocument>
+#include <QDateTime>
+
+// 刷新周期
+static const int REFRESH_INTERVAL_MS = 500;
+
+enum PerfColumn {
+    ColumnName,
+    ColumnRate,
+    ColumnTotal,
+    ColumnMean,
+    ColumnP50,
+    ColumnP99,
+    ColumnMax,
+    ColumnUnit,
+    ColumnCount
+};
+
+PerfPanel::PerfPanel(QWidget *parent)
+    : QWidget(parent)
+    , table(new QTableWidget(0, ColumnCount, this))
+    , resetButton(new QPushButton("重置", this))
+    , exportButton(new QPushButton("导出快照", this))
+    , refreshTimer(new QTimer(this))
+{
+    table->setHorizontalHeaderLabels({"指标", "当前/每秒", "累计", "平均", "p50", "p99", "最大", "单位"});
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setStretchLastSection(true);
+
+    resetButton->setToolTip("清零所有计数器和直方图，峰值从当前值重新开始");
+    exportButton->setToolTip("把当前所有指标保存为JSON文件");
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(exportButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->addWidget(table);
+    layout->addLayout(buttonLayout);
+
+    refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(refreshTimer, &QTimer::timeout, this, &PerfPanel::refresh);
+    connect(resetButton, &QPushButton::clicked, this, &PerfPanel::onResetClicked);
+    connect(exportButton, &QPushButton::clicked, this, &PerfPanel::onExportClicked);
+}
+
+void PerfPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    // 只在可见时刷新，隐藏时不占用GUI线程
+    lastValues.clear();
+    rateClock.start();
+    refresh();
+    refreshTimer->start();
+}
+
+void PerfPanel::hideEvent(QHideEvent *event)
+{
+    refreshTimer->stop();
+    QWidget::hideEvent(event);
+}
+
+void PerfPanel::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = table->item(row, column);
+    if (!item) {
+        item = new QTableWidgetItem;
+        if (column != ColumnName && column != ColumnUnit) {
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        table->setItem(row, column, item);
+    }
+    if (item->text() != text) {
+        item->setText(text);
+    }
+}
+
+void PerfPanel::refresh()
+{
+    const QList<PerfMetric *> metrics = PerfMetrics::instance().metrics();
+    const qint64 elapsedMs = rateClock.restart();
+    const double seconds = elapsedMs > 0 ? elapsedMs / 1000.0 : 1.0;
+
+    // 指标只增不减，行数变化时补齐
+    if (table->rowCount() != metrics.size()) {
+        table->setRowCount(metrics.size());
+    }
+
+    for (int row = 0; row < metrics.size(); ++row) {
+        PerfMetric *metric = metrics[row];
+        // 新注册的指标按名称插入中间，之后的行会换成别的指标（类型可能不同），先清掉旧的数值列
+        QTableWidgetItem *nameItem = table->item(row, ColumnName);
+        if (nameItem && nameItem->text() != metric->name()) {
+            for (int column = ColumnRate; column <= ColumnMax; ++column) {
+                setCell(row, column, QString());
+            }
+        }
+        setCell(row, ColumnName, metric->name());
+        table->item(row, ColumnName)->setToolTip(metric->description());
+        setCell(row, ColumnUnit, metric->unit());
+
+        // 速率：本次与上次刷新之间的增量，首次显示时为空
+        auto rate = [&](quint64 value) {
+            auto it = lastValues.find(metric->name());
+            QString text;
+            if (it != lastValues.end() && value >= it.value()) {
+                text = QString::number(qRound64((value - it.value()) / seconds));
+            }
+            lastValues[metric->name()] = value;
+            return text;
+        };
+
+        switch (metric->kind()) {
+        case PerfMetric::Counter: {
+            const quint64 value = static_cast<PerfCounter *>(metric)->value();
+            setCell(row, ColumnRate, rate(value));
+            setCell(row, ColumnTotal, QString::number(value));
+            break;
+        }
+        case PerfMetric::Gauge: {
+            PerfGauge *gauge = static_cast<PerfGauge *>(metric);
+            setCell(row, ColumnRate, QString::number(gauge->value()));
+            setCell(row, ColumnMax, QString::number(gauge->peak()));
+            break;
+        }
+        case PerfMetric::Histogram: {
+            PerfHistogram *histogram = static_cast<PerfHistogram *>(metric);
+            const quint64 count = histogram->count();
+            setCell(row, ColumnRate, rate(count));
+            setCell(row, ColumnTotal, QString::number(count));
+            setCell(row, ColumnMean, QString::number(histogram->mean(), 'f', 1));
+            setCell(row, ColumnP50, QString::number(histogram->percentile(50)));
+            setCell(row, ColumnP99, QString::number(histogram->percentile(99)));
+            setCell(row, ColumnMax, QString::number(histogram->peak()));
+            break;
+        }
+        }
+    }
+}
+
+void PerfPanel::onResetClicked()
+{
+    PerfMetrics::instance().reset();
+    lastValues.clear();
+    refresh();
+}
+
+void PerfPanel::onExportClicked()
+{
+    const QString defaultName = QString("perf_metrics_%1.json")
+                                .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    const QString fileName = QFileDialog::getSaveFileName(this, "导出性能指标", defaultName, "JSON 文件 (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, "错误", QString("无法写入文件：%1").arg(file.errorString()));
+        return;
+    }
+    file.write(QJsonDocument(PerfMetrics::instance().snapshot()).toJson());
+}
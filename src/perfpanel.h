@@ -0,0 +1,41 @@
+#ifndef PERFPANEL_H
+#define PERFPANEL_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include "perfmetrics.h"
+
+// 性能统计面板：定时显示全局注册表中的所有指标
+// 计数器显示每秒增量，直方图显示每秒样本数和分布，用于定位高波特率下哪一级先饱和。
+class PerfPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerfPanel(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void onResetClicked();
+    void onExportClicked();
+
+private:
+    QTableWidget *table;
+    QPushButton *resetButton;
+    QPushButton *exportButton;
+    QTimer *refreshTimer;
+    QElapsedTimer rateClock;
+    QHash<QString, quint64> lastValues;     // 上次刷新时的计数/样本数，用于计算速率
+
+    void setCell(int row, int column, const QString &text);
+};
+
+#endif // PERFPANEL_H
@@ -0,0 +1,85 @@
+#include "rendercoalescer.h"
+
+RenderCoalescer::RenderCoalescer(int maxFps, QObject *parent)
+    : QObject(parent)
+    , frameTimer(new QTimer(this))
+    , fps(1)
+{
+    frameTimer->setSingleShot(true);
+    connect(frameTimer, &QTimer::timeout, this, &RenderCoalescer::onTimeout);
+    setMaxFps(maxFps);
+}
+
+void RenderCoalescer::append(const QString &text, qint64 timestampNs)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    if (timestampNs >= 0) {
+        pendingStamps.append({pendingText.size(), timestampNs});
+    }
+    pendingText.append(text);
+
+    if (frameTimer->isActive()) {
+        // 本帧已安排刷新，只需累积
+        return;
+    }
+
+    // 距上次刷新已超过一帧则立即刷新，否则等到这一帧结束
+    const qint64 interval = frameIntervalMs();
+    const qint64 elapsed = lastFlush.isValid() ? lastFlush.elapsed() : interval;
+    if (elapsed >= interval) {
+        flushNow();
+    } else {
+        frameTimer->start(int(interval - elapsed));
+    }
+}
+
+void RenderCoalescer::flushNow()
+{
+    frameTimer->stop();
+    lastFlush.start();
+
+    if (pendingText.isEmpty()) {
+        return;
+    }
+
+    QString text;
+    QVector<LogTimestamp> stamps;
+    text.swap(pendingText);
+    stamps.swap(pendingStamps);
+    emit flushed(text, stamps);
+}
+
+void RenderCoalescer::clear()
+{
+    frameTimer->stop();
+    pendingText.clear();
+    pendingStamps.clear();
+}
+
+void RenderCoalescer::setMaxFps(int maxFps)
+{
+    fps = qBound(1, maxFps, 1000);
+}
+
+int RenderCoalescer::maxFps() const
+{
+    return fps;
+}
+
+bool RenderCoalescer::hasPending() const
+{
+    return !pendingText.isEmpty();
+}
+
+void RenderCoalescer::onTimeout()
+{
+    flushNow();
+}
+
+int RenderCoalescer::frameIntervalMs() const
+{
+    return qMax(1, 1000 / fps);
+}
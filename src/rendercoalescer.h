@@ -0,0 +1,51 @@
+#ifndef RENDERCOALESCER_H
+#define RENDERCOALESCER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include "logstore.h"
+
+// 渲染合并器
+// 收集待显示的日志文本，按帧率上限批量刷新到界面：每秒最多刷新maxFps次，每次刷新只追加一次。
+// 数据稀疏时第一段文本立即刷新，数据密集时在下一帧统一刷新，避免每个数据块都触发一次文档排版。
+class RenderCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderCoalescer(int maxFps = 30, QObject *parent = nullptr);
+
+    // 追加待显示文本，timestampNs 为其中新行的到达时刻（单调时钟），-1表示沿用之前的时间戳
+    void append(const QString &text, qint64 timestampNs = -1);
+
+    // 立即刷新所有待显示文本
+    void flushNow();
+
+    // 丢弃所有待显示文本
+    void clear();
+
+    void setMaxFps(int fps);
+    int maxFps() const;
+    bool hasPending() const;
+
+signals:
+    // 一帧内合并后的文本及其中各段的时间戳
+    void flushed(const QString &text, const QVector<LogTimestamp> &stamps);
+
+private slots:
+    void onTimeout();
+
+private:
+    QString pendingText;
+    QVector<LogTimestamp> pendingStamps;
+    QTimer *frameTimer;
+    QElapsedTimer lastFlush;
+    int fps;
+
+    int frameIntervalMs() const;
+};
+
+#endif // RENDERCOALESCER_H
@@ -0,0 +1,73 @@
+#include "ringbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+RingBuffer::RingBuffer(qsizetype capacity)
+    : writePos(0)
+    , readPos(0)
+{
+    quint64 size = 1;
+    while (size < quint64(qMax<qsizetype>(capacity, 2))) {
+        size <<= 1;
+    }
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+qsizetype RingBuffer::capacity() const
+{
+    return qsizetype(mask + 1);
+}
+
+qsizetype RingBuffer::size() const
+{
+    return qsizetype(writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire));
+}
+
+qsizetype RingBuffer::freeSpace() const
+{
+    return capacity() - size();
+}
+
+qsizetype RingBuffer::write(const char *data, qsizetype len)
+{
+    const quint64 w = writePos.load(std::memory_order_relaxed);
+    const quint64 r = readPos.load(std::memory_order_acquire);
+    const quint64 space = (mask + 1) - (w - r);
+    const quint64 n = std::min<quint64>(space, quint64(qMax<qsizetype>(len, 0)));
+    if (n == 0) {
+        return 0;
+    }
+
+    // 写入可能跨越缓冲区末尾，分两段拷贝
+    const quint64 offset = w & mask;
+    const quint64 first = std::min<quint64>(n, (mask + 1) - offset);
+    std::memcpy(buffer.data() + offset, data, first);
+    std::memcpy(buffer.data(), data + first, n - first);
+
+    writePos.store(w + n, std::memory_order_release);
+    return qsizetype(n);
+}
+
+qsizetype RingBuffer::read(char *data, qsizetype maxLen)
+{
+    const quint64 r = readPos.load(std::memory_order_relaxed);
+    const quint64 w = writePos.load(std::memory_order_acquire);
+    const quint64 n = std::min<quint64>(w - r, quint64(qMax<qsizetype>(maxLen, 0)));
+    if (n == 0) {
+        return 0;
+    }
+
+    const quint64 offset = r & mask;
+    const quint64 first = std::min<quint64>(n, (mask + 1) - offset);
+    std::memcpy(data, buffer.data() + offset, first);
+    std::memcpy(data + first, buffer.data(), n - first);
+
+    readPos.store(r + n, std::memory_order_release);
+    return qsizetype(n);
+}
+
+void RingBuffer::clear()
+{
+    readPos.store(writePos.load(std::memory_order_acquire), std::memory_order_release);
+}
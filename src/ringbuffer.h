@@ -0,0 +1,38 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+// 单生产者/单消费者(SPSC)无锁字节环形缓冲区
+// 生产者为串口I/O线程，只调用 write()；消费者为GUI线程，只调用 read()/clear()
+// 容量在构造时一次性分配（向上取整为2的幂），运行期间不再分配内存
+class RingBuffer
+{
+public:
+    explicit RingBuffer(qsizetype capacity = 4 * 1024 * 1024);
+
+    qsizetype capacity() const;
+    qsizetype size() const;       // 当前可读字节数
+    qsizetype freeSpace() const;  // 当前可写字节数
+
+    // 写入数据，空间不足时只写入能容纳的部分，返回实际写入字节数（仅生产者线程调用）
+    qsizetype write(const char *data, qsizetype len);
+
+    // 读出最多maxLen字节，返回实际读出字节数（仅消费者线程调用）
+    qsizetype read(char *data, qsizetype maxLen);
+
+    // 丢弃所有可读数据（仅消费者线程调用）
+    void clear();
+
+private:
+    std::vector<char> buffer;
+    quint64 mask;
+
+    // 读写位置单调递增，取模后得到下标；分处不同缓存行避免伪共享
+    alignas(64) std::atomic<quint64> writePos;
+    alignas(64) std::atomic<quint64> readPos;
+};
+
+#endif // RINGBUFFER_H
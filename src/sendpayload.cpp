@@ -0,0 +1,117 @@
+#include "sendpayload.h"
+#include "hexcodec.h"
+
+SendPayloadCache::SendPayloadCache()
+    : terminatorEnabled(false)
+    , hexSend(false)
+{
+    invalidateAll();
+}
+
+void SendPayloadCache::setTerminator(bool enabled, const QString &endChars)
+{
+    if (enabled == terminatorEnabled && endChars == terminatorText) {
+        return;
+    }
+    terminatorEnabled = enabled;
+    terminatorText = endChars;
+    invalidateAll();
+}
+
+void SendPayloadCache::setHexSend(bool enabled)
+{
+    if (enabled == hexSend) {
+        return;
+    }
+    hexSend = enabled;
+    for (int slot = 0; slot < MessageSlotCount; ++slot) {
+        messageValid[slot] = false;
+    }
+}
+
+const SendPayload &SendPayloadCache::message(MessageSlot slot, const QString &text)
+{
+    if (!messageValid[slot]) {
+        messagePayloads[slot] = compile(text, hexSend, false);
+        messageValid[slot] = true;
+    }
+    return messagePayloads[slot];
+}
+
+void SendPayloadCache::invalidateMessage(MessageSlot slot)
+{
+    messageValid[slot] = false;
+}
+
+const SendPayload &SendPayloadCache::button(int row, int column, const QString &command, bool isHexCommand)
+{
+    const quint64 key = (quint64(quint32(row)) << 32) | quint32(column);
+    auto it = buttonEntries.find(key);
+    if (it == buttonEntries.end() || it->isHexCommand != isHexCommand || it->command != command) {
+        ButtonEntry entry;
+        entry.command = command;
+        entry.isHexCommand = isHexCommand;
+        entry.payload = compile(command, isHexCommand, true);
+        it = buttonEntries.insert(key, entry);
+    }
+    return it->payload;
+}
+
+void SendPayloadCache::invalidateButtons()
+{
+    buttonEntries.clear();
+}
+
+void SendPayloadCache::invalidateAll()
+{
+    for (int slot = 0; slot < MessageSlotCount; ++slot) {
+        messageValid[slot] = false;
+    }
+    invalidateButtons();
+}
+
+SendPayload SendPayloadCache::compile(const QString &text, bool isHex, bool buttonRules) const
+{
+    SendPayload payload;
+    payload.text = text.trimmed();
+    if (payload.text.isEmpty()) {
+        payload.status = SendPayload::Empty;
+        return payload;
+    }
+
+    qsizetype errorOffset = 0;
+    if (isHex) {
+        if (!HexCodec::appendDecoded(payload.text, payload.bytes, &errorOffset)) {
+            payload.status = SendPayload::InvalidHex;
+            payload.errorString = HexCodec::errorDetail(payload.text, errorOffset);
+            payload.bytes.clear();
+            return payload;
+        }
+    } else {
+        payload.bytes = payload.text.toUtf8();
+    }
+
+    if (payload.bytes.isEmpty()) {
+        payload.status = SendPayload::Empty;
+        return payload;
+    }
+
+    if (terminatorEnabled) {
+        const QString endChars = terminatorText.trimmed();
+        if (endChars.isEmpty()) {
+            // 输入框发送默认追加回车换行，按键发送不追加
+            if (!buttonRules) {
+                payload.bytes.append("\r\n", 2);
+            }
+        } else if (!HexCodec::appendDecoded(endChars, payload.bytes, &errorOffset) && !buttonRules) {
+            payload.status = SendPayload::InvalidTerminator;
+            payload.errorString = HexCodec::errorDetail(endChars, errorOffset);
+            payload.bytes.clear();
+            return payload;
+        }
+    }
+
+    payload.hexText = HexCodec::toHexString(payload.bytes);
+    payload.status = SendPayload::Ok;
+    return payload;
+}
@@ -0,0 +1,75 @@
+#ifndef SENDPAYLOAD_H
+#define SENDPAYLOAD_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+// 编译后的发送内容：负载与结束符已合并成一个不可变的QByteArray，
+// 发送时直接交给串口，不再重复 trimmed/校验/解码/追加结束符
+struct SendPayload {
+    enum Status {
+        Ok,
+        Empty,              // 内容为空（或只有空白）
+        InvalidHex,         // 十六进制内容无效
+        InvalidTerminator   // 结束符无效
+    };
+
+    Status status;
+    QByteArray bytes;       // 负载 + 结束符
+    QString text;           // 去除首尾空白后的输入，用于发送日志
+    QString hexText;        // bytes 的十六进制形式，用于发送日志
+    QString errorString;    // 失败原因（含出错位置）
+
+    SendPayload() : status(Empty) {}
+    bool isValid() const { return status == Ok; }
+};
+
+// 发送内容缓存
+// 输入框内容、自动发送内容和每个按键各自缓存一份编译结果，
+// 内容、16进制模式或结束符变化时失效，下一次发送时重新编译。
+class SendPayloadCache
+{
+public:
+    enum MessageSlot {
+        InputMessage,       // 发送按钮 / 回车发送，对应输入框当前内容
+        AutoSendMessage,    // 自动发送，对应开启自动发送时的内容快照
+        MessageSlotCount
+    };
+
+    SendPayloadCache();
+
+    // 结束符设置（"自动回车"及其十六进制字符），变化时全部失效
+    void setTerminator(bool enabled, const QString &endChars);
+    // 输入框的16进制发送模式，变化时输入框和自动发送失效
+    void setHexSend(bool hexSend);
+
+    // 输入框类发送：结束符为空时默认追加CR LF，结束符无效时编译失败
+    const SendPayload &message(MessageSlot slot, const QString &text);
+    void invalidateMessage(MessageSlot slot);
+
+    // 按键发送：结束符为空或无效时不追加；缓存项记录来源指令，按键内容变化后自动重新编译
+    const SendPayload &button(int row, int column, const QString &command, bool isHexCommand);
+    void invalidateButtons();
+
+    void invalidateAll();
+
+private:
+    struct ButtonEntry {
+        QString command;
+        bool isHexCommand;
+        SendPayload payload;
+    };
+
+    bool terminatorEnabled;
+    QString terminatorText;
+    bool hexSend;
+
+    SendPayload messagePayloads[MessageSlotCount];
+    bool messageValid[MessageSlotCount];
+    QHash<quint64, ButtonEntry> buttonEntries;
+
+    SendPayload compile(const QString &text, bool isHex, bool buttonRules) const;
+};
+
+#endif // SENDPAYLOAD_H
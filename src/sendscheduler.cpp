@@ -0,0 +1,199 @@
+#include "sendscheduler.h"
+#include "serialportmanager.h"
+#include "deadlinesleeper.h"
+#include <QMutexLocker>
+#include <thread>
+
+static const qint64 MIN_PERIOD_NS = 1000;               // 最小周期1µs
+static const qint64 SPIN_PERIOD_NS = 1000 * 1000;       // 周期小于1ms时启用忙等
+static const qint64 SPIN_WINDOW_NS = 50 * 1000;         // 截止时间前最后50µs忙等
+static const qint64 MAX_SLEEP_SLICE_NS = 50 * 1000 * 1000;  // 单次休眠上限，保证stop()及时返回
+
+SchedulerStats::SchedulerStats()
+    : periodNs(0)
+    , ticks(0)
+    , missedDeadlines(0)
+    , bytesSent(0)
+    , averagePeriodNs(0)
+    , minPeriodNs(0)
+    , maxPeriodNs(0)
+    , maxJitterNs(0)
+{
+    for (int i = 0; i < JitterBuckets; ++i) {
+        jitterHistogram[i] = 0;
+    }
+}
+
+qint64 SchedulerStats::jitterPercentileNs(double percentile) const
+{
+    quint64 total = 0;
+    for (int i = 0; i < JitterBuckets; ++i) {
+        total += jitterHistogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const quint64 target = quint64(total * percentile / 100.0 + 0.5);
+    quint64 count = 0;
+    for (int i = 0; i < JitterBuckets - 1; ++i) {
+        count += jitterHistogram[i];
+        if (count >= target) {
+            return (qint64(1) << i) * 1000;
+        }
+    }
+    return maxJitterNs;
+}
+
+static int jitterBucket(qint64 jitterNs)
+{
+    qint64 us = jitterNs / 1000;
+    int bucket = 0;
+    while (us > 0 && bucket < SchedulerStats::JitterBuckets - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+SendScheduler::SendScheduler(QObject *parent)
+    : QObject(parent)
+    , schedulerThread(nullptr)
+    , stopRequested(false)
+    , period(0)
+    , serialManager(nullptr)
+{
+}
+
+SendScheduler::~SendScheduler()
+{
+    stop();
+}
+
+bool SendScheduler::start(SerialPortManager *manager, const QByteArray &payload, qint64 periodNs)
+{
+    stop();
+    if (!manager || payload.isEmpty()) {
+        return false;
+    }
+
+    serialManager = manager;
+    period = qMax(periodNs, MIN_PERIOD_NS);
+    stopRequested = false;
+    {
+        QMutexLocker locker(&mutex);
+        currentPayload = payload;
+        currentStats = SchedulerStats();
+        currentStats.periodNs = period;
+    }
+
+    schedulerThread = QThread::create([this]() { run(); });
+    schedulerThread->start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void SendScheduler::stop()
+{
+    if (!schedulerThread) {
+        return;
+    }
+    stopRequested = true;
+    // 启用流控时发送线程可能在等待发送队列空间
+    serialManager->wakeBlockedSenders();
+    schedulerThread->wait();
+    delete schedulerThread;
+    schedulerThread = nullptr;
+}
+
+bool SendScheduler::isRunning() const
+{
+    return schedulerThread && schedulerThread->isRunning();
+}
+
+void SendScheduler::setPayload(const QByteArray &payload)
+{
+    QMutexLocker locker(&mutex);
+    currentPayload = payload;
+}
+
+SchedulerStats SendScheduler::stats() const
+{
+    QMutexLocker locker(&mutex);
+    return currentStats;
+}
+
+void SendScheduler::run()
+{
+    DeadlineSleeper sleeper;
+    const qint64 periodNs = period;
+    qint64 deadline = DeadlineSleeper::nowNs() + periodNs;
+    qint64 firstWake = -1;
+    qint64 lastWake = -1;
+
+    while (!stopRequested) {
+        // 长周期分片休眠以便及时响应停止请求，每片仍以绝对时间为目标，最后一片正好落在截止时间
+        const qint64 sleepTarget = periodNs < SPIN_PERIOD_NS ? deadline - SPIN_WINDOW_NS : deadline;
+        qint64 now = DeadlineSleeper::nowNs();
+        while (!stopRequested && now < sleepTarget) {
+            sleeper.sleepUntil(qMin(sleepTarget, now + MAX_SLEEP_SLICE_NS));
+            now = DeadlineSleeper::nowNs();
+        }
+        // 周期小于1ms时最后一段忙等
+        while (!stopRequested && now < deadline) {
+            std::this_thread::yield();
+            now = DeadlineSleeper::nowNs();
+        }
+        if (stopRequested) {
+            break;
+        }
+
+        QByteArray payload;
+        {
+            QMutexLocker locker(&mutex);
+            payload = currentPayload;   // 隐式共享，不复制数据
+        }
+
+        const qint64 bytesWritten = serialManager->sendData(payload, &stopRequested);
+        if (bytesWritten < 0) {
+            emit sendFailed(serialManager->getErrorString());
+            break;
+        }
+
+        {
+            QMutexLocker locker(&mutex);
+            SchedulerStats &s = currentStats;
+            const qint64 jitter = qAbs(now - deadline);
+            ++s.ticks;
+            s.bytesSent += bytesWritten;
+            s.maxJitterNs = qMax(s.maxJitterNs, jitter);
+            ++s.jitterHistogram[jitterBucket(jitter)];
+            if (lastWake >= 0) {
+                const qint64 achieved = now - lastWake;
+                s.minPeriodNs = s.minPeriodNs == 0 ? achieved : qMin(s.minPeriodNs, achieved);
+                s.maxPeriodNs = qMax(s.maxPeriodNs, achieved);
+                s.averagePeriodNs = double(now - firstWake) / double(s.ticks - 1);
+            }
+        }
+        if (firstWake < 0) {
+            firstWake = now;
+        }
+        lastWake = now;
+
+        // 发送队列已满而被丢弃时（返回0）不通知
+        if (bytesWritten > 0 && periodNs >= NotifyThresholdNs) {
+            emit tickSent(bytesWritten);
+        }
+
+        // 截止时间按周期累加，不以唤醒时间为基准，处理耗时不会累积成漂移
+        deadline += periodNs;
+
+        // 已经错过一个以上完整周期时跳过，不补发
+        const qint64 lateness = DeadlineSleeper::nowNs() - deadline;
+        if (lateness >= periodNs) {
+            const qint64 missed = lateness / periodNs;
+            deadline += missed * periodNs;
+            QMutexLocker locker(&mutex);
+            currentStats.missedDeadlines += missed;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SENDSCHEDULER_H
+#define SENDSCHEDULER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+
+class SerialPortManager;
+
+// 周期发送统计
+struct SchedulerStats {
+    // 抖动直方图：统计 |实际唤醒 - 截止时间|，第0桶为不足1微秒，第 i 桶为 [2^(i-1), 2^i) 微秒，最后一桶包含更大值
+    static const int JitterBuckets = 21;
+
+    qint64 periodNs;          // 目标周期
+    quint64 ticks;            // 已发送次数
+    quint64 missedDeadlines;  // 因严重延迟而跳过的周期数
+    quint64 bytesSent;
+    double averagePeriodNs;   // 实际平均周期
+    qint64 minPeriodNs;
+    qint64 maxPeriodNs;
+    qint64 maxJitterNs;
+    quint64 jitterHistogram[JitterBuckets];
+
+    SchedulerStats();
+    qint64 jitterPercentileNs(double percentile) const;   // 按直方图估算的抖动分位数（桶上界）
+};
+
+// 高精度周期发送调度器
+// 在独立的高优先级线程中按绝对截止时间休眠（Linux 使用 clock_nanosleep + TIMER_ABSTIME，
+// Windows 使用高精度可等待定时器），截止时间逐周期累加，不会因处理耗时而漂移；
+// 周期小于1ms时最后一小段改为忙等以达到微秒级精度。唤醒后直接把编译好的负载交给串口管理器。
+// 严重延迟时跳过错过的周期并计数，不会补发造成突发。
+class SendScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SendScheduler(QObject *parent = nullptr);
+    ~SendScheduler();
+
+    // 周期大于等于该值时每次发送都发出 tickSent 信号，供界面记录发送日志
+    static const qint64 NotifyThresholdNs = 10 * 1000 * 1000;
+
+    bool start(SerialPortManager *manager, const QByteArray &payload, qint64 periodNs);
+    void stop();
+    bool isRunning() const;
+
+    // 运行中替换负载（如结束符变化），下一个周期生效
+    void setPayload(const QByteArray &payload);
+
+    SchedulerStats stats() const;
+
+signals:
+    void tickSent(qint64 bytes);
+    void sendFailed(const QString &errorString);
+
+private:
+    QThread *schedulerThread;
+    std::atomic<bool> stopRequested;
+    qint64 period;              // 运行期间不变，修改周期需重新start()
+    SerialPortManager *serialManager;
+
+    mutable QMutex mutex;       // 保护负载和统计
+    QByteArray currentPayload;
+    SchedulerStats currentStats;
+
+    void run();
+};
+
+#endif // SENDSCHEDULER_H
@@ -1,20 +1,74 @@
 #include "serialportmanager.h"
+#include "hexcodec.h"
 #include <QDebug>
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutexLocker>
+#include <QDeadlineTimer>
 
-SerialPortManager::SerialPortManager(QObject *parent)
+// 单次从串口读取的最大字节数
+static const qsizetype READ_CHUNK_SIZE = 64 * 1024;
+// QSerialPort写缓冲低于该值时才从发送队列补充数据
+static const qint64 WRITE_WINDOW_SIZE = 16 * 1024;
+// Block策略下等待队列空间的最长时间
+static const int SEND_BLOCK_TIMEOUT_MS = 500;
+// 到达时刻记录的最大条数，消费者长时间不取数据时合并最早的记录
+static const int MAX_ARRIVAL_MARKS = 4096;
+
+SerialPortManager::SerialPortManager(qsizetype receiveBufferSize, QObject *parent)
     : QObject(parent)
     , serialPort(new QSerialPort(this))
+    , nativeActive(false)
+    , requestedBackend(QtBackend)
+    , nativeProfile(NativePortSettings::LowLatency)
+    , nativeReceived(false)
     , sentBytes(0)
+    , queuedBytes(0)
+    , droppedBytes(0)
     , receivedBytes(0)
+    , overrunBytes(0)
+    , portOpen(false)
+    , flowControlEnabled(false)
+    , notifyPending(false)
+    , captureWriter(nullptr)
+    , receiveObserver(nullptr)
+    , receiveRing(receiveBufferSize)
+    , readBuffer(READ_CHUNK_SIZE, Qt::Uninitialized)
+    , sendHighWater(64 * 1024)
+    , sendPolicy(Block)
+    , drainPending(false)
+    , ringWrittenTotal(0)
+    , ringReadTotal(0)
 {
+    PerfMetrics &metrics = PerfMetrics::instance();
+    readyReadCounter = metrics.counter("serial.ready_read", "次", "接收唤醒次数（readyRead 事件或原生后端的 epoll 唤醒）");
+    readSizeHistogram = metrics.histogram("serial.read_size", "B", "单次从驱动读取的字节数");
+    ringOccupancyGauge = metrics.gauge("serial.ring_occupancy", "B", "接收环形缓冲区中未被取走的字节数");
+    overrunCounter = metrics.counter("serial.rx_overrun", "B", "接收环形缓冲区写满而丢弃的字节数");
+    receiveLatencyHistogram = metrics.histogram("serial.rx_latency", "us", "数据进入环形缓冲区到被取走的时间");
+    sendQueueGauge = metrics.gauge("serial.tx_queue_depth", "B", "发送队列深度");
+    sendDroppedCounter = metrics.counter("serial.tx_dropped", "B", "发送队列满而丢弃的字节数");
+
     connect(serialPort, &QSerialPort::readyRead, this, &SerialPortManager::handleReadyRead);
+    connect(serialPort, &QSerialPort::bytesWritten, this, &SerialPortManager::handleBytesWritten);
     connect(serialPort, QOverload<QSerialPort::SerialPortError>::of(&QSerialPort::errorOccurred),
             this, &SerialPortManager::handleError);
 }
 
 SerialPortManager::~SerialPortManager()
 {
-    closePort();
+    // 析构时I/O线程已退出，直接在当前线程关闭串口
+    if (serialPort->isOpen()) {
+        serialPort->close();
+    }
+    nativePort.close();
+    nativeActive = false;
+    portOpen = false;
+}
+
+bool SerialPortManager::isInPortThread() const
+{
+    return QThread::currentThread() == thread();
 }
 
 QStringList SerialPortManager::getAvailablePorts()
@@ -28,66 +82,283 @@ QStringList SerialPortManager::getAvailablePorts()
 }
 
 bool SerialPortManager::openPort(const QString &portName, int baudRate, int dataBits, 
-                                 int stopBits, const QString &parity)
+                                 int stopBits, const QString &parity, const QString &flowControl)
 {
-    if (serialPort->isOpen()) {
-        closePort();
+    if (!isInPortThread()) {
+        bool result = false;
+        QMetaObject::invokeMethod(this, [&]() {
+            result = openPort(portName, baudRate, dataBits, stopBits, parity, flowControl);
+        }, Qt::BlockingQueuedConnection);
+        return result;
     }
 
-    serialPort->setPortName(portName);
-    
-    if (!serialPort->open(QIODevice::ReadWrite)) {
-        return false;
+    if (serialPort->isOpen() || nativePort.isOpen()) {
+        closePort();
     }
 
-    // 设置串口参数
-    if (!serialPort->setBaudRate(baudRate) ||
-        !serialPort->setDataBits(intToDataBits(dataBits)) ||
-        !serialPort->setStopBits(intToStopBits(stopBits)) ||
-        !serialPort->setParity(stringToParity(parity))) {
-        
-        serialPort->close();
-        return false;
+    bool useNative = false;
+    {
+        QMutexLocker locker(&stateMutex);
+        useNative = requestedBackend == NativeBackend && NativeSerialPort::isSupported();
     }
+    if (useNative) {
+        if (!openNativePort(portName, baudRate, dataBits, stopBits, parity, flowControl)) {
+            return false;
+        }
+    } else {
+        serialPort->setPortName(portName);
 
-    serialPort->setFlowControl(QSerialPort::NoFlowControl);
-    serialPort->clear();
+        if (!serialPort->open(QIODevice::ReadWrite)) {
+            setErrorString(serialPort->errorString());
+            return false;
+        }
+
+        // 设置串口参数
+        if (!serialPort->setBaudRate(baudRate) ||
+            !serialPort->setDataBits(intToDataBits(dataBits)) ||
+            !serialPort->setStopBits(intToStopBits(stopBits)) ||
+            !serialPort->setParity(stringToParity(parity)) ||
+            !serialPort->setFlowControl(stringToFlowControl(flowControl))) {
+
+            setErrorString(serialPort->errorString());
+            serialPort->close();
+            return false;
+        }
+
+        serialPort->clear();
+    }
 
     // 保存当前设置
-    currentSettings.portName = portName;
-    currentSettings.baudRate = baudRate;
-    currentSettings.dataBits = dataBits;
-    currentSettings.stopBits = stopBits;
-    currentSettings.parity = parity;
+    {
+        QMutexLocker locker(&stateMutex);
+        currentSettings.portName = portName;
+        currentSettings.baudRate = baudRate;
+        currentSettings.dataBits = dataBits;
+        currentSettings.stopBits = stopBits;
+        currentSettings.parity = parity;
+        currentSettings.flowControl = flowControl;
+    }
 
+    flowControlEnabled = stringToFlowControl(flowControl) != QSerialPort::NoFlowControl;
+    portOpen = true;
     emit portOpened();
     return true;
 }
 
+bool SerialPortManager::openNativePort(const QString &portName, int baudRate, int dataBits,
+                                       int stopBits, const QString &parity, const QString &flowControl)
+{
+    NativePortSettings settings;
+    settings.baudRate = baudRate;
+    settings.dataBits = dataBits;
+    settings.stopBits = stopBits;
+    switch (stringToParity(parity)) {
+        case QSerialPort::EvenParity: settings.parity = 'E'; break;
+        case QSerialPort::OddParity: settings.parity = 'O'; break;
+        default: settings.parity = 'N'; break;
+    }
+    switch (stringToFlowControl(flowControl)) {
+        case QSerialPort::HardwareControl: settings.flowControl = NativePortSettings::HardwareControl; break;
+        case QSerialPort::SoftwareControl: settings.flowControl = NativePortSettings::SoftwareControl; break;
+        default: settings.flowControl = NativePortSettings::NoFlowControl; break;
+    }
+    {
+        QMutexLocker locker(&stateMutex);
+        settings.profile = nativeProfile;
+    }
+
+    // 回调在原生后端线程中执行，与 QSerialPort 后端共用同一套缓冲区、队列和统计
+    NativeSerialPort::Callbacks callbacks;
+    callbacks.received = [this](const char *data, qsizetype len) {
+        if (storeReceived(data, len)) {
+            nativeReceived = true;
+        }
+    };
+    callbacks.receiveFinished = [this]() {
+        readyReadCounter->add();
+        finishReceive(nativeReceived);
+        nativeReceived = false;
+    };
+    callbacks.takeSendData = [this](QByteArray *data) { return takeSendData(data); };
+    callbacks.written = [this](const char *data, qsizetype len) { recordWritten(data, len); };
+    callbacks.errorOccurred = [this](const QString &errorString) { reportError(errorString); };
+
+    nativeReceived = false;
+    if (!nativePort.open(portName, settings, readBuffer.data(), readBuffer.size(), callbacks)) {
+        setErrorString(nativePort.errorString());
+        return false;
+    }
+    nativeActive = true;
+    return true;
+}
+
 void SerialPortManager::closePort()
 {
-    if (serialPort->isOpen()) {
+    if (!isInPortThread()) {
+        QMetaObject::invokeMethod(this, [this]() { closePort(); }, Qt::BlockingQueuedConnection);
+        return;
+    }
+
+    if (nativePort.isOpen()) {
+        // 后端线程退出前会把驱动中剩余的数据取进环形缓冲区
+        nativeActive = false;
+        nativePort.close();
+    } else if (serialPort->isOpen()) {
+        // 关闭前把驱动中剩余的数据取进环形缓冲区
+        handleReadyRead();
         serialPort->close();
-        emit portClosed();
+    } else {
+        return;
     }
+
+    portOpen = false;
+    // 未发出的数据随串口关闭丢弃，唤醒等待队列空间的发送线程
+    clearSendQueue();
+    emit portClosed();
+}
+
+void SerialPortManager::setBackend(Backend backend, NativePortSettings::Profile profile)
+{
+    QMutexLocker locker(&stateMutex);
+    requestedBackend = backend;
+    nativeProfile = profile;
+}
+
+SerialPortManager::Backend SerialPortManager::getBackend() const
+{
+    return nativeActive ? NativeBackend : QtBackend;
+}
+
+SerialPortManager::Backend SerialPortManager::backendFromString(const QString &backend)
+{
+    return backend == "native" ? NativeBackend : QtBackend;
+}
+
+QString SerialPortManager::backendToString(Backend backend)
+{
+    return backend == NativeBackend ? "native" : "qt";
 }
 
 bool SerialPortManager::isPortOpen() const
 {
-    return serialPort->isOpen();
+    return portOpen;
 }
 
 QString SerialPortManager::getPortName() const
 {
-    return serialPort->portName();
+    QMutexLocker locker(&stateMutex);
+    return currentSettings.portName;
 }
 
 QString SerialPortManager::getErrorString() const
 {
-    return serialPort->errorString();
+    QMutexLocker locker(&stateMutex);
+    return lastErrorString;
+}
+
+void SerialPortManager::setErrorString(const QString &errorString)
+{
+    QMutexLocker locker(&stateMutex);
+    lastErrorString = errorString;
+}
+
+qint64 SerialPortManager::sendData(const QByteArray &data, const std::atomic<bool> *canceled)
+{
+    if (!portOpen) {
+        return -1;
+    }
+    if (data.isEmpty()) {
+        return 0;
+    }
+
+    const qint64 size = data.size();
+    {
+        QMutexLocker locker(&sendMutex);
+        if (queuedBytes + size > sendHighWater) {
+            // GUI线程和I/O线程从不等待，放不下时按下面的规则丢弃并报告，界面不会卡顿
+            const bool canWait = !isInPortThread() &&
+                                 QThread::currentThread() != QCoreApplication::instance()->thread();
+            if (sendPolicy == Block && canWait) {
+                // 启用流控时对端暂停接收期间队列不会减少：发送方（定时发送等）
+                // 一直等到对端恢复，数据不丢；未启用流控时最多等待500ms
+                QDeadlineTimer deadline(flowControlEnabled ? QDeadlineTimer::Forever : SEND_BLOCK_TIMEOUT_MS);
+                // 取消标志在 sendMutex 内检查，与 wakeBlockedSenders() 配合不会错过唤醒
+                while (portOpen && !(canceled && *canceled) &&
+                       queuedBytes > 0 && queuedBytes + size > sendHighWater) {
+                    if (!sendSpaceAvailable.wait(&sendMutex, deadline)) {
+                        break;
+                    }
+                }
+                if (!portOpen) {
+                    return -1;
+                }
+                if (canceled && *canceled) {
+                    return 0;
+                }
+            } else if (sendPolicy == Coalesce) {
+                while (!sendQueue.isEmpty() && queuedBytes + size > sendHighWater) {
+                    const qint64 staleSize = sendQueue.dequeue().size();
+                    queuedBytes -= staleSize;
+                    droppedBytes += staleSize;
+                    sendDroppedCounter->add(quint64(staleSize));
+                }
+            }
+
+            // 仍然放不下则丢弃；队列为空时单次超过高水位的数据照常发送
+            if (queuedBytes > 0 && queuedBytes + size > sendHighWater) {
+                droppedBytes += size;
+                sendDroppedCounter->add(quint64(size));
+                locker.unlock();
+                setErrorString(QString("发送队列已满（%1 字节），数据已丢弃").arg(sendHighWater));
+                return 0;
+            }
+        }
+        sendQueue.enqueue(data);
+        queuedBytes += size;
+        sendQueueGauge->set(queuedBytes);
+    }
+
+    if (nativeActive) {
+        // 原生后端线程自己从队列取数据
+        nativePort.wakeForWrite();
+    } else if (isInPortThread()) {
+        drainSendQueue();
+    } else if (!drainPending.exchange(true)) {
+        // 队列由I/O线程取出，连续发送时只投递一次事件
+        QMetaObject::invokeMethod(this, [this]() { drainSendQueue(); }, Qt::QueuedConnection);
+    }
+    return size;
+}
+
+void SerialPortManager::drainSendQueue()
+{
+    drainPending = false;
+
+    while (serialPort->isOpen() && serialPort->bytesToWrite() < WRITE_WINDOW_SIZE) {
+        QByteArray data;
+        {
+            QMutexLocker locker(&sendMutex);
+            if (sendQueue.isEmpty()) {
+                return;
+            }
+            data = sendQueue.dequeue();
+        }
+        writeToPort(data);
+    }
+}
+
+void SerialPortManager::clearSendQueue()
+{
+    {
+        QMutexLocker locker(&sendMutex);
+        sendQueue.clear();
+        queuedBytes = 0;
+        sendQueueGauge->set(0);
+    }
+    sendSpaceAvailable.wakeAll();
 }
 
-qint64 SerialPortManager::sendData(const QByteArray &data)
+qint64 SerialPortManager::writeToPort(const QByteArray &data)
 {
     if (!serialPort->isOpen()) {
         return -1;
@@ -95,17 +366,89 @@ qint64 SerialPortManager::sendData(const QByteArray &data)
 
     qint64 bytesWritten = serialPort->write(data);
     if (bytesWritten > 0) {
-        sentBytes += bytesWritten;
-        emit statisticsChanged(sentBytes, receivedBytes);
+        // 此时只是进入QSerialPort写缓冲，发送计数在 bytesWritten 信号中累加
+        if (CaptureWriter *writer = captureWriter.load()) {
+            writer->append(CaptureWriter::Send, data.constData(), bytesWritten);
+        }
+    } else {
+        setErrorString(serialPort->errorString());
+    }
+    // 未能写入的部分不会再发出，从队列深度中扣除
+    const qint64 lost = data.size() - qMax<qint64>(bytesWritten, 0);
+    if (lost > 0) {
+        {
+            QMutexLocker locker(&sendMutex);
+            queuedBytes -= lost;
+        }
+        sendSpaceAvailable.wakeAll();
     }
     return bytesWritten;
 }
 
+bool SerialPortManager::takeSendData(QByteArray *data)
+{
+    QMutexLocker locker(&sendMutex);
+    if (sendQueue.isEmpty()) {
+        return false;
+    }
+    *data = sendQueue.dequeue();
+    return true;
+}
+
+void SerialPortManager::recordWritten(const char *data, qint64 n)
+{
+    // 原生后端直接写入驱动，写入即计为已发送
+    sentBytes += n;
+    if (CaptureWriter *writer = captureWriter.load()) {
+        writer->append(CaptureWriter::Send, data, n);
+    }
+    {
+        QMutexLocker locker(&sendMutex);
+        queuedBytes -= n;
+        sendQueueGauge->set(queuedBytes);
+    }
+    sendSpaceAvailable.wakeAll();
+}
+
+void SerialPortManager::handleBytesWritten(qint64 bytes)
+{
+    sentBytes += bytes;
+    {
+        QMutexLocker locker(&sendMutex);
+        queuedBytes -= bytes;
+        sendQueueGauge->set(queuedBytes);
+    }
+    sendSpaceAvailable.wakeAll();
+    drainSendQueue();
+}
+
+void SerialPortManager::setSendQueueLimit(qint64 highWaterBytes, SendQueuePolicy policy)
+{
+    {
+        QMutexLocker locker(&sendMutex);
+        sendHighWater = qMax<qint64>(highWaterBytes, 1);
+        sendPolicy = policy;
+    }
+    sendSpaceAvailable.wakeAll();
+}
+
+qint64 SerialPortManager::getQueuedBytes() const
+{
+    return queuedBytes;
+}
+
+quint64 SerialPortManager::getDroppedBytes() const
+{
+    return droppedBytes;
+}
+
 qint64 SerialPortManager::sendHexData(const QString &hexString)
 {
-    QString cleanHex = hexString;
-    cleanHex.remove(' ').remove('\n').remove('\r');
-    QByteArray data = QByteArray::fromHex(cleanHex.toLatin1());
+    QByteArray data;
+    if (!HexCodec::decode(hexString.toLatin1(), &data)) {
+        setErrorString("十六进制格式错误");
+        return -1;
+    }
     return sendData(data);
 }
 
@@ -124,25 +467,164 @@ qint64 SerialPortManager::getReceivedBytes() const
     return receivedBytes;
 }
 
+quint64 SerialPortManager::getOverrunBytes() const
+{
+    return overrunBytes;
+}
+
+qsizetype SerialPortManager::getReceiveBufferSize() const
+{
+    return receiveRing.capacity();
+}
+
 void SerialPortManager::resetStatistics()
 {
     sentBytes = 0;
     receivedBytes = 0;
+    overrunBytes = 0;
+    droppedBytes = 0;
     emit statisticsChanged(sentBytes, receivedBytes);
 }
 
 SerialPortManager::PortSettings SerialPortManager::getCurrentSettings() const
 {
+    QMutexLocker locker(&stateMutex);
     return currentSettings;
 }
 
+QByteArray SerialPortManager::readAll(QVector<ReceiveChunk> *chunks)
+{
+    // 先清除通知标志再取数据：取数据期间新到达的数据会触发下一次通知，不会遗漏
+    notifyPending = false;
+
+    QByteArray data;
+    const qsizetype available = receiveRing.size();
+    if (available <= 0) {
+        return data;
+    }
+    data.resize(available);
+    data.resize(receiveRing.read(data.data(), available));
+    ringOccupancyGauge->set(receiveRing.size());
+
+    // 按写入位置把取出的数据对应回每次读取的到达时刻
+    const qint64 now = PerfMetrics::nowNs();
+    const quint64 endPosition = ringReadTotal + quint64(data.size());
+    quint64 position = ringReadTotal;
+    qint64 firstArrivalNs = -1;
+    {
+        QMutexLocker locker(&arrivalMutex);
+        while (!arrivalMarks.isEmpty() && position < endPosition) {
+            const ArrivalMark mark = arrivalMarks.head();
+            const quint64 chunkEnd = qMin(mark.endPosition, endPosition);
+            if (chunkEnd > position) {
+                if (firstArrivalNs < 0) {
+                    firstArrivalNs = mark.arrivalNs;
+                }
+                if (chunks) {
+                    chunks->append({qsizetype(chunkEnd - position), mark.arrivalNs});
+                }
+                position = chunkEnd;
+            }
+            if (mark.endPosition > endPosition) {
+                break;
+            }
+            arrivalMarks.dequeue();
+        }
+    }
+    if (position < endPosition && chunks) {
+        chunks->append({qsizetype(endPosition - position), now});
+    }
+    ringReadTotal = endPosition;
+
+    if (firstArrivalNs > 0) {
+        receiveLatencyHistogram->record(quint64(qMax<qint64>(0, now - firstArrivalNs) / 1000));
+    }
+    return data;
+}
+
+qsizetype SerialPortManager::bytesAvailable() const
+{
+    return receiveRing.size();
+}
+
+void SerialPortManager::wakeBlockedSenders()
+{
+    QMutexLocker locker(&sendMutex);
+    sendSpaceAvailable.wakeAll();
+}
+
+void SerialPortManager::setCaptureWriter(CaptureWriter *writer)
+{
+    captureWriter = writer;
+}
+
+void SerialPortManager::setReceiveObserver(ReceiveObserver *observer)
+{
+    // 与 storeReceived() 中的回调互斥：返回时进行中的回调已经结束
+    QMutexLocker locker(&observerMutex);
+    receiveObserver = observer;
+}
+
 void SerialPortManager::handleReadyRead()
 {
-    QByteArray data = serialPort->readAll();
-    if (!data.isEmpty()) {
-        receivedBytes += data.size();
-        emit statisticsChanged(sentBytes, receivedBytes);
-        emit dataReceived(data);
+    // 在I/O线程中把驱动缓冲区一次性取空，写入环形缓冲区
+    readyReadCounter->add();
+    bool appended = false;
+    while (serialPort->bytesAvailable() > 0) {
+        const qint64 n = serialPort->read(readBuffer.data(), readBuffer.size());
+        if (n <= 0) {
+            break;
+        }
+        if (storeReceived(readBuffer.constData(), n)) {
+            appended = true;
+        }
+    }
+    finishReceive(appended);
+}
+
+bool SerialPortManager::storeReceived(const char *data, qint64 n)
+{
+    receivedBytes += n;
+    readSizeHistogram->record(quint64(n));
+
+    // 录制在环形缓冲区之前进行，GUI跟不上导致的溢出不影响录制文件
+    if (CaptureWriter *writer = captureWriter.load()) {
+        writer->append(CaptureWriter::Receive, data, n);
+    }
+    if (receiveObserver.load()) {
+        // 持锁调用，取消后观察者可以立即释放；未设置观察者时不加锁
+        QMutexLocker locker(&observerMutex);
+        if (ReceiveObserver *observer = receiveObserver.load()) {
+            observer->received(data, n);
+        }
+    }
+
+    // 先记录到达时刻再写入，消费者取到数据时一定能找到对应记录；
+    // 只有消费者会释放空间，按当前空闲量写入时实际写入量与记录一致
+    const qsizetype written = qMin<qsizetype>(n, receiveRing.freeSpace());
+    if (written > 0) {
+        ringWrittenTotal += quint64(written);
+        QMutexLocker locker(&arrivalMutex);
+        if (arrivalMarks.size() >= MAX_ARRIVAL_MARKS) {
+            arrivalMarks.dequeue();
+        }
+        arrivalMarks.enqueue({ringWrittenTotal, PerfMetrics::nowNs()});
+    }
+    receiveRing.write(data, written);
+    if (written < n) {
+        // 消费者跟不上，丢弃放不下的部分并计数
+        overrunBytes += quint64(n - written);
+        overrunCounter->add(quint64(n - written));
+    }
+    return written > 0;
+}
+
+void SerialPortManager::finishReceive(bool appended)
+{
+    ringOccupancyGauge->set(receiveRing.size());
+
+    if (appended && !notifyPending.exchange(true)) {
+        emit dataAvailable();
     }
 }
 
@@ -183,6 +665,12 @@ void SerialPortManager::handleError(QSerialPort::SerialPortError error)
             break;
     }
 
+    reportError(errorString);
+}
+
+void SerialPortManager::reportError(const QString &errorString)
+{
+    setErrorString(errorString);
     emit errorOccurred(errorString);
 }
 
@@ -204,11 +692,23 @@ QSerialPort::StopBits SerialPortManager::intToStopBits(int stopBits)
 
 QSerialPort::Parity SerialPortManager::stringToParity(const QString &parity)
 {
-    if (parity == "EvenParity") {
+    // 界面文字为 "E(偶校验)" / "O(奇校验)"，配置文件中也可能是 "EvenParity" / "OddParity"，按首字母区分
+    if (parity.startsWith(QChar('E'), Qt::CaseInsensitive)) {
         return QSerialPort::EvenParity;
-    } else if (parity == "OddParity") {
+    } else if (parity.startsWith(QChar('O'), Qt::CaseInsensitive)) {
         return QSerialPort::OddParity;
     } else {
         return QSerialPort::NoParity;
     }
 }
+
+QSerialPort::FlowControl SerialPortManager::stringToFlowControl(const QString &flowControl)
+{
+    if (flowControl == "rtscts") {
+        return QSerialPort::HardwareControl;
+    } else if (flowControl == "xonxoff") {
+        return QSerialPort::SoftwareControl;
+    } else {
+        return QSerialPort::NoFlowControl;
+    }
+}
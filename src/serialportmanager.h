@@ -6,32 +6,100 @@
 #include <QSerialPortInfo>
 #include <QTimer>
 #include <QStringList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QVector>
+#include <atomic>
+#include "ringbuffer.h"
+#include "capturewriter.h"
+#include "perfmetrics.h"
+#include "nativeserialport.h"
 
+// 接收旁路：收到数据时在I/O线程（原生后端时为后端线程）中立即调用，不经过环形缓冲区和GUI线程。
+// 实现必须很快返回，不能阻塞读取。
+class ReceiveObserver
+{
+public:
+    virtual ~ReceiveObserver() {}
+    virtual void received(const char *data, qint64 n) = 0;
+};
+
+// 串口管理器
+// 设计为运行在独立的I/O线程中（moveToThread），QSerialPort随管理器一起迁移。
+// 接收数据由I/O线程直接写入预分配的无锁环形缓冲区，GUI线程按自身节奏通过 readAll() 取出，
+// GUI卡顿时数据在环形缓冲区中累积而不会堵塞驱动缓冲区；环形缓冲区写满时丢弃的字节计入溢出计数。
+// 公共接口可在任意线程调用，需要操作串口的请求会被转发到I/O线程执行。
+// 发送数据先进入发送队列，I/O线程只在QSerialPort写缓冲较少时从队列取数据写入，
+// 发送统计按 bytesWritten 计数（真正写到驱动的字节），队列超过高水位时按策略丢弃/阻塞/合并。
+// 在 Linux 上可选原生后端（NativeSerialPort）：收发由后端自己的 epoll 线程完成，环形缓冲区、
+// 发送队列、统计和录制与 QSerialPort 后端共用，对调用方透明。
 class SerialPortManager : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit SerialPortManager(QObject *parent = nullptr);
+    // 发送队列超过高水位时的处理策略
+    enum SendQueuePolicy {
+        DropNew,    // 丢弃新数据
+        Block,      // 调用线程等待队列有空间（GUI线程和I/O线程不等待，直接丢弃；超时丢弃，启用流控时不超时）
+        Coalesce    // 丢弃队列中尚未写入串口的旧数据，保留最新的
+    };
+
+    // 串口后端
+    enum Backend {
+        QtBackend,      // QSerialPort，随I/O线程的事件循环收发
+        NativeBackend   // termios + epoll（仅 Linux），不支持的平台自动使用 QtBackend
+    };
+
+    explicit SerialPortManager(qsizetype receiveBufferSize = 4 * 1024 * 1024, QObject *parent = nullptr);
     ~SerialPortManager();
 
     // 串口管理
     QStringList getAvailablePorts();
-    bool openPort(const QString &portName, int baudRate, int dataBits, 
-                  int stopBits, const QString &parity);
+    // flowControl：none / rtscts / xonxoff
+    bool openPort(const QString &portName, int baudRate, int dataBits,
+                  int stopBits, const QString &parity, const QString &flowControl = "none");
     void closePort();
     bool isPortOpen() const;
     QString getPortName() const;
     QString getErrorString() const;
 
-    // 数据发送
-    qint64 sendData(const QByteArray &data);
+    // 数据发送：返回进入发送队列的字节数，队列已满而丢弃时返回0，串口未打开返回-1
+    // canceled 非空时，Block 策略下等待队列空间期间该标志置位即放弃发送并返回0
+    qint64 sendData(const QByteArray &data, const std::atomic<bool> *canceled = nullptr);
     qint64 sendHexData(const QString &hexString);
     qint64 sendTextData(const QString &text);
 
+    // 一次驱动读取的数据段：字节数和到达时刻（PerfMetrics::nowNs() 单调时钟）
+    struct ReceiveChunk {
+        qsizetype size;
+        qint64 arrivalNs;
+    };
+
+    // 数据接收（仅由唯一的消费线程调用，通常为GUI线程）
+    // chunks 非空时按I/O线程的读取边界给出返回数据中每一段的到达时刻，供分帧打时间戳和判断字节间空闲
+    QByteArray readAll(QVector<ReceiveChunk> *chunks = nullptr);
+    qsizetype bytesAvailable() const;
+
+    // 录制：设置后I/O线程把收到和实际写出的每个字节交给录制引擎，传nullptr取消
+    void setCaptureWriter(CaptureWriter *writer);
+    // 接收旁路：设置后I/O线程把收到的每段数据先交给观察者（如宏等待应答），传nullptr取消；
+    // 返回时旧观察者进行中的回调已经结束，之后不会再被调用。不能在观察者回调中调用
+    void setReceiveObserver(ReceiveObserver *observer);
+
+    // 发送队列
+    void setSendQueueLimit(qint64 highWaterBytes, SendQueuePolicy policy);
+    qint64 getQueuedBytes() const;     // 已提交但尚未写到驱动的字节数（发送队列 + QSerialPort写缓冲）
+    quint64 getDroppedBytes() const;   // 超过高水位而丢弃的字节数
+    // 唤醒在 sendData() 中等待队列空间的线程，让它们重新检查各自的取消标志（任意线程调用）
+    void wakeBlockedSenders();
+
     // 统计信息
-    qint64 getSentBytes() const;
+    qint64 getSentBytes() const;       // 按 bytesWritten 统计的实际发出字节数
     qint64 getReceivedBytes() const;
+    quint64 getOverrunBytes() const;   // 接收环形缓冲区写满而丢弃的字节数
+    qsizetype getReceiveBufferSize() const;
     void resetStatistics();
 
     // 串口参数
@@ -41,12 +109,21 @@ public:
         int dataBits;
         int stopBits;
         QString parity;
+        QString flowControl;
     };
 
     PortSettings getCurrentSettings() const;
 
+    // 后端选择在下一次 openPort() 时生效
+    void setBackend(Backend backend, NativePortSettings::Profile profile = NativePortSettings::LowLatency);
+    Backend getBackend() const;     // 当前打开的串口实际使用的后端
+    // 配置字符串：qt / native
+    static Backend backendFromString(const QString &backend);
+    static QString backendToString(Backend backend);
+
 signals:
-    void dataReceived(const QByteArray &data);
+    // 环形缓冲区由空变为非空时发出一次，消费者调用 readAll() 取完数据后才会再次发出
+    void dataAvailable();
     void errorOccurred(const QString &errorString);
     void portOpened();
     void portClosed();
@@ -54,17 +131,78 @@ signals:
 
 private slots:
     void handleReadyRead();
+    void handleBytesWritten(qint64 bytes);
     void handleError(QSerialPort::SerialPortError error);
 
 private:
     QSerialPort *serialPort;
-    qint64 sentBytes;
-    qint64 receivedBytes;
+    NativeSerialPort nativePort;
+    std::atomic<bool> nativeActive;             // 当前串口由原生后端打开
+    Backend requestedBackend;                   // stateMutex 保护
+    NativePortSettings::Profile nativeProfile;  // stateMutex 保护
+    bool nativeReceived;                        // 原生后端一次唤醒中是否写入了环形缓冲区（后端线程）
+    std::atomic<qint64> sentBytes;
+    std::atomic<qint64> queuedBytes;
+    std::atomic<quint64> droppedBytes;
+    std::atomic<qint64> receivedBytes;
+    std::atomic<quint64> overrunBytes;
+    std::atomic<bool> portOpen;
+    std::atomic<bool> flowControlEnabled;   // 当前串口启用了流控，对端可能长时间暂停接收
+    std::atomic<bool> notifyPending;
+    std::atomic<CaptureWriter *> captureWriter;
+    std::atomic<ReceiveObserver *> receiveObserver;
+    QMutex observerMutex;       // 回调期间持有，取消观察者时等待进行中的回调结束
     PortSettings currentSettings;
+    QString lastErrorString;
+    mutable QMutex stateMutex;  // 保护 currentSettings、lastErrorString 和后端选择
+
+    RingBuffer receiveRing;     // I/O线程 -> GUI线程
+    QByteArray readBuffer;      // I/O线程读取串口用的预分配缓冲
+
+    QQueue<QByteArray> sendQueue;       // 尚未交给QSerialPort的数据
+    qint64 sendHighWater;
+    SendQueuePolicy sendPolicy;
+    std::atomic<bool> drainPending;     // 已投递过一次取队列请求，避免每次发送都投递事件
+    QMutex sendMutex;                   // 保护 sendQueue / sendHighWater / sendPolicy
+    QWaitCondition sendSpaceAvailable;
+
+    // 性能指标（全局注册表中的同名指标，多个串口累计在一起）
+    PerfCounter *readyReadCounter;
+    PerfHistogram *readSizeHistogram;
+    PerfGauge *ringOccupancyGauge;
+    PerfCounter *overrunCounter;
+    PerfHistogram *receiveLatencyHistogram;
+    PerfGauge *sendQueueGauge;
+    PerfCounter *sendDroppedCounter;
+
+    // 环形缓冲区中每次写入的结束位置和到达时刻，消费者取数据时按位置对应
+    struct ArrivalMark {
+        quint64 endPosition;
+        qint64 arrivalNs;
+    };
+    QQueue<ArrivalMark> arrivalMarks;
+    QMutex arrivalMutex;
+    quint64 ringWrittenTotal;   // 累计写入环形缓冲区的字节数（I/O线程或原生后端线程）
+    quint64 ringReadTotal;      // 累计取出的字节数（消费线程）
+
+    bool isInPortThread() const;
+    bool openNativePort(const QString &portName, int baudRate, int dataBits, int stopBits,
+                        const QString &parity, const QString &flowControl);
+    // 把一次读取的数据写入环形缓冲区（I/O线程或原生后端线程，同一时刻只有一个生产者）
+    bool storeReceived(const char *data, qint64 n);
+    void finishReceive(bool appended);
+    bool takeSendData(QByteArray *data);
+    void recordWritten(const char *data, qint64 n);
+    void reportError(const QString &errorString);
+    qint64 writeToPort(const QByteArray &data);
+    void drainSendQueue();
+    void clearSendQueue();
+    void setErrorString(const QString &errorString);
 
     QSerialPort::DataBits intToDataBits(int dataBits);
     QSerialPort::StopBits intToStopBits(int stopBits);
     QSerialPort::Parity stringToParity(const QString &parity);
+    QSerialPort::FlowControl stringToFlowControl(const QString &flowControl);
 };
 
 #endif // SERIALPORTMANAGER_H
@@ -0,0 +1,285 @@
+#include "sessionmanager.h"
+#include "hexcodec.h"
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QSet>
+
+// GUI长时间未取走时，待显示文本最多保留的字符数（保留最新部分）
+static const qsizetype MAX_PENDING_CHARS = 8 * 1024 * 1024;
+
+// 二进制录制中的端口号为一个字节
+static const int MAX_SESSION_ID = 255;
+
+PortSession::PortSession(int id, QObject *parent)
+    : QObject(parent)
+    , sessionId(id)
+    , ioThread(new QThread(this))
+    , serialManager(new SerialPortManager)
+    , formatter(new QObject)
+    , capture(new CaptureWriter(this))
+    , hexDisplay(false)
+    , timestampDisplay(true)
+    , atLineStart(true)
+    , receiveDecoder(QStringDecoder::Utf8)
+{
+    serialManager->moveToThread(ioThread);
+    formatter->moveToThread(ioThread);
+    connect(ioThread, &QThread::finished, serialManager, &QObject::deleteLater);
+    connect(ioThread, &QThread::finished, formatter, &QObject::deleteLater);
+
+    // dataAvailable 在I/O线程发出，formatter 也在I/O线程，格式化在读取之后同线程执行
+    connect(serialManager, &SerialPortManager::dataAvailable, formatter, [this]() { formatReceived(); });
+    connect(serialManager, &SerialPortManager::errorOccurred, this, &PortSession::errorOccurred);
+
+    ioThread->setObjectName(QString("PortSession-%1").arg(id));
+    ioThread->start(QThread::TimeCriticalPriority);
+}
+
+PortSession::~PortSession()
+{
+    stopCapture();
+    serialManager->closePort();
+    ioThread->quit();
+    ioThread->wait();
+}
+
+int PortSession::id() const
+{
+    return sessionId;
+}
+
+SerialPortManager *PortSession::manager() const
+{
+    return serialManager;
+}
+
+bool PortSession::open(const QString &portName, int baudRate, int dataBits,
+                       int stopBits, const QString &parity)
+{
+    return serialManager->openPort(portName, baudRate, dataBits, stopBits, parity);
+}
+
+void PortSession::close()
+{
+    serialManager->closePort();
+}
+
+bool PortSession::isOpen() const
+{
+    return serialManager->isPortOpen();
+}
+
+QString PortSession::portName() const
+{
+    return serialManager->getPortName();
+}
+
+QString PortSession::errorString() const
+{
+    return serialManager->getErrorString();
+}
+
+void PortSession::setDisplayOptions(bool hex, bool timestamp)
+{
+    hexDisplay = hex;
+    timestampDisplay = timestamp;
+}
+
+bool PortSession::startCapture(const CaptureOptions &options)
+{
+    CaptureOptions sessionOptions = options;
+    sessionOptions.portId = quint8(sessionId);
+    QString name = portName();
+    name.remove(QChar('/'));
+    if (!name.isEmpty()) {
+        sessionOptions.baseName = options.baseName + "_" + name;
+    }
+
+    if (!capture->start(sessionOptions)) {
+        return false;
+    }
+    serialManager->setCaptureWriter(capture);
+    return true;
+}
+
+void PortSession::stopCapture()
+{
+    if (!capture->isRecording()) {
+        return;
+    }
+    serialManager->setCaptureWriter(nullptr);
+    capture->stop();
+}
+
+bool PortSession::isCapturing() const
+{
+    return capture->isRecording();
+}
+
+CaptureWriter *PortSession::captureWriter() const
+{
+    return capture;
+}
+
+QString PortSession::takeDisplayText()
+{
+    QMutexLocker locker(&textMutex);
+    QString text;
+    text.swap(pendingText);
+    return text;
+}
+
+SessionStats PortSession::stats() const
+{
+    SessionStats s;
+    s.sentBytes = serialManager->getSentBytes();
+    s.receivedBytes = serialManager->getReceivedBytes();
+    s.overrunBytes = serialManager->getOverrunBytes();
+    s.droppedBytes = serialManager->getDroppedBytes();
+    s.queuedBytes = serialManager->getQueuedBytes();
+    return s;
+}
+
+void PortSession::formatReceived()
+{
+    static PerfHistogram *chunkHistogram = PerfMetrics::instance().chunkProcessHistogram();
+
+    const qint64 start = PerfMetrics::nowNs();
+    const QByteArray data = serialManager->readAll();
+    if (data.isEmpty()) {
+        return;
+    }
+
+    QString timestamp;
+    if (timestampDisplay) {
+        timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss") + " ";
+    }
+
+    QString entry;
+    if (hexDisplay) {
+        // 十六进制显示每个数据块一行
+        if (!atLineStart) {
+            entry += QChar('\n');
+        }
+        entry += timestamp;
+        entry += HexCodec::toHexString(data);
+        entry += QChar('\n');
+        // 切回文本显示时不接上十六进制显示之前留下的半个字符
+        receiveDecoder.resetState();
+    } else {
+        // 被读取边界拆开的多字节字符留到下一块
+        QString text = receiveDecoder.decode(data);
+        text.remove(QChar('\r'));
+        if (timestampDisplay) {
+            if (!atLineStart) {
+                entry += QChar('\n');
+            }
+            entry += timestamp;
+        }
+        entry += text;
+    }
+    if (entry.isEmpty()) {
+        return;
+    }
+    atLineStart = entry.endsWith(QChar('\n'));
+
+    {
+        QMutexLocker locker(&textMutex);
+        pendingText += entry;
+        if (pendingText.size() > MAX_PENDING_CHARS) {
+            pendingText.remove(0, pendingText.size() - MAX_PENDING_CHARS);
+        }
+    }
+    chunkHistogram->record(quint64(PerfMetrics::nowNs() - start) / 1000);
+}
+
+SessionManager::SessionManager(QObject *parent)
+    : QObject(parent)
+    , nextId(1)
+{
+}
+
+SessionManager::~SessionManager()
+{
+    // 逐个关闭串口并等待各自的I/O线程退出
+    qDeleteAll(sessionList);
+    sessionList.clear();
+}
+
+PortSession *SessionManager::createSession()
+{
+    int id = 0;
+    if (nextId <= MAX_SESSION_ID) {
+        id = nextId++;
+    } else {
+        // 会话号用尽后复用已释放的号
+        QSet<int> usedIds;
+        for (PortSession *session : sessionList) {
+            usedIds.insert(session->id());
+        }
+        for (int candidate = 1; candidate <= MAX_SESSION_ID && id == 0; ++candidate) {
+            if (!usedIds.contains(candidate)) {
+                id = candidate;
+            }
+        }
+        if (id == 0) {
+            return nullptr;
+        }
+    }
+
+    PortSession *session = new PortSession(id, this);
+    sessionList.append(session);
+    emit sessionAdded(session);
+    return session;
+}
+
+void SessionManager::removeSession(PortSession *session)
+{
+    if (!session || !sessionList.removeOne(session)) {
+        return;
+    }
+    const int id = session->id();
+    delete session;
+    emit sessionRemoved(id);
+}
+
+QList<PortSession *> SessionManager::sessions() const
+{
+    return sessionList;
+}
+
+int SessionManager::sessionCount() const
+{
+    return sessionList.size();
+}
+
+SessionStats SessionManager::totalStats() const
+{
+    SessionStats total;
+    for (PortSession *session : sessionList) {
+        const SessionStats s = session->stats();
+        total.sentBytes += s.sentBytes;
+        total.receivedBytes += s.receivedBytes;
+        total.overrunBytes += s.overrunBytes;
+        total.droppedBytes += s.droppedBytes;
+        total.queuedBytes += s.queuedBytes;
+    }
+    return total;
+}
+
+CaptureOptions SessionManager::captureOptions(const SerialPortConfig &config, const QString &directory)
+{
+    CaptureOptions options;
+    options.directory = directory;
+    options.rotateBytes = qint64(config.captureRotateMegabytes) * 1024 * 1024;
+    options.rotateSeconds = config.captureRotateMinutes * 60;
+    if (config.captureFsync == "none") {
+        options.fsyncPolicy = CaptureOptions::FsyncNone;
+    } else if (config.captureFsync == "block") {
+        options.fsyncPolicy = CaptureOptions::FsyncPerBlock;
+    } else {
+        options.fsyncPolicy = CaptureOptions::FsyncInterval;
+    }
+    options.format = config.captureFormat == "text" ? CaptureOptions::FormatText : CaptureOptions::FormatBinary;
+    return options;
+}
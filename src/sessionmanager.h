@@ -0,0 +1,114 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QStringDecoder>
+#include <atomic>
+#include "serialportmanager.h"
+#include "capturewriter.h"
+#include "buttondatabase.h"
+
+// 会话统计（各计数器的快照）
+struct SessionStats {
+    qint64 sentBytes;
+    qint64 receivedBytes;
+    quint64 overrunBytes;   // 接收环形缓冲区溢出丢弃
+    quint64 droppedBytes;   // 发送队列超过高水位丢弃
+    qint64 queuedBytes;     // 发送队列深度
+
+    SessionStats() : sentBytes(0), receivedBytes(0), overrunBytes(0), droppedBytes(0), queuedBytes(0) {}
+};
+
+// 单个串口会话
+// 每个会话有独立的I/O线程、串口管理器和录制引擎。接收数据在会话自己的I/O线程中
+// 取出环形缓冲区并格式化成显示文本，GUI线程每帧只取走格式化好的文本追加一次，
+// 多个串口的解码和格式化分布在各自的线程上，不在GUI线程里串行处理。
+class PortSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PortSession(int id, QObject *parent = nullptr);
+    ~PortSession();
+
+    int id() const;
+    SerialPortManager *manager() const;
+
+    bool open(const QString &portName, int baudRate, int dataBits = 8,
+              int stopBits = 1, const QString &parity = "NoParity");
+    void close();
+    bool isOpen() const;
+    QString portName() const;
+    QString errorString() const;
+
+    // 接收显示格式，在I/O线程格式化时读取
+    void setDisplayOptions(bool hexDisplay, bool timestampDisplay);
+
+    // 录制：文件名前缀带端口名，多个会话可录制到同一目录
+    bool startCapture(const CaptureOptions &options);
+    void stopCapture();
+    bool isCapturing() const;
+    CaptureWriter *captureWriter() const;
+
+    // GUI线程调用：取出I/O线程已格式化好的接收文本
+    QString takeDisplayText();
+
+    SessionStats stats() const;
+
+signals:
+    void errorOccurred(const QString &errorString);
+
+private:
+    int sessionId;
+    QThread *ioThread;
+    SerialPortManager *serialManager;   // 运行在ioThread中
+    QObject *formatter;                 // 运行在ioThread中，接收 dataAvailable
+    CaptureWriter *capture;
+
+    std::atomic<bool> hexDisplay;
+    std::atomic<bool> timestampDisplay;
+    bool atLineStart;                   // 只在I/O线程访问
+    QStringDecoder receiveDecoder;      // 只在I/O线程访问，跨读取块的多字节UTF-8字符不会被拆坏
+
+    mutable QMutex textMutex;           // 保护 pendingText
+    QString pendingText;
+
+    void formatReceived();
+};
+
+// 多串口会话管理
+// 测试架上同时监控多个串口，每个会话各自一个I/O线程，会话之间互不阻塞
+class SessionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionManager(QObject *parent = nullptr);
+    ~SessionManager();
+
+    // 会话号从1开始（0为主窗口的串口），同时也是二进制录制中的端口号
+    PortSession *createSession();
+    void removeSession(PortSession *session);
+    QList<PortSession *> sessions() const;
+    int sessionCount() const;
+
+    // 所有会话的统计之和
+    SessionStats totalStats() const;
+
+    // 按配置生成录制选项
+    static CaptureOptions captureOptions(const SerialPortConfig &config, const QString &directory);
+
+signals:
+    void sessionAdded(PortSession *session);
+    void sessionRemoved(int id);
+
+private:
+    QList<PortSession *> sessionList;
+    int nextId;
+};
+
+#endif // SESSIONMANAGER_H
@@ -0,0 +1,342 @@
+#include "virtualport.h"
+#include <QElapsedTimer>
+#include <QByteArray>
+
+#if defined(Q_OS_LINUX)
+#include <pty.h>
+#elif defined(Q_OS_MACOS) || defined(Q_OS_FREEBSD) || defined(Q_OS_OPENBSD) || defined(Q_OS_NETBSD)
+#include <util.h>
+#endif
+
+#if defined(Q_OS_UNIX)
+#include <termios.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#define VIRTUALPORT_HAS_PTY 1
+#endif
+
+// 对端单次读取的最大字节数
+static const qsizetype PEER_READ_SIZE = 16 * 1024;
+// 数据发生器的发送节拍
+static const int GENERATOR_TICK_MS = 10;
+// 慢速设备处理接收缓冲的节拍
+static const int THROTTLE_TICK_MS = 2;
+// 软件流控字符
+static const char XON_CHAR = 0x11;
+static const char XOFF_CHAR = 0x13;
+
+VirtualPort::VirtualPort(const VirtualPortOptions &options)
+    : portOptions(options)
+    , masterFd(-1)
+    , slaveFd(-1)
+    , peerThread(nullptr)
+    , stopRequested(false)
+    , receivedBytes(0)
+    , sentBytes(0)
+    , droppedBytes(0)
+    , overflowBytes(0)
+    , pauseCount(0)
+{
+    portOptions.generatorLineLength = qMax(16, portOptions.generatorLineLength);
+    portOptions.generatorBytesPerSecond = qMax<qint64>(1, portOptions.generatorBytesPerSecond);
+    portOptions.throttleBytesPerSecond = qMax<qint64>(1, portOptions.throttleBytesPerSecond);
+    portOptions.throttleBufferBytes = qMax(1, portOptions.throttleBufferBytes);
+    portOptions.throttleHighWater = qBound(1, portOptions.throttleHighWater, portOptions.throttleBufferBytes);
+    portOptions.throttleLowWater = qBound(0, portOptions.throttleLowWater, portOptions.throttleHighWater - 1);
+}
+
+VirtualPort::~VirtualPort()
+{
+    close();
+}
+
+bool VirtualPort::isSupported()
+{
+#ifdef VIRTUALPORT_HAS_PTY
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool VirtualPort::open()
+{
+    if (isOpen()) {
+        return true;
+    }
+
+#ifdef VIRTUALPORT_HAS_PTY
+    char name[256] = {0};
+    if (openpty(&masterFd, &slaveFd, name, nullptr, nullptr) != 0) {
+        lastError = QString("创建伪终端失败：%1").arg(QString::fromLocal8Bit(strerror(errno)));
+        masterFd = -1;
+        slaveFd = -1;
+        return false;
+    }
+    slavePath = QString::fromLocal8Bit(name);
+
+    // 原始模式：不回显、不做行编辑和换行转换，行为与真实串口一致
+    struct termios tio;
+    if (tcgetattr(slaveFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slaveFd, TCSANOW, &tio);
+    }
+    // 主设备非阻塞：应用来不及读取时对端不会卡住
+    fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+
+    stopRequested = false;
+    peerThread = QThread::create([this]() { runPeer(); });
+    peerThread->setObjectName("VirtualPortPeer");
+    peerThread->start();
+    return true;
+#else
+    lastError = "当前平台不支持虚拟串口";
+    return false;
+#endif
+}
+
+void VirtualPort::close()
+{
+    if (peerThread) {
+        stopRequested = true;
+        peerThread->wait();
+        delete peerThread;
+        peerThread = nullptr;
+    }
+
+#ifdef VIRTUALPORT_HAS_PTY
+    if (masterFd >= 0) {
+        ::close(masterFd);
+        masterFd = -1;
+    }
+    if (slaveFd >= 0) {
+        ::close(slaveFd);
+        slaveFd = -1;
+    }
+#endif
+}
+
+bool VirtualPort::isOpen() const
+{
+    return masterFd >= 0;
+}
+
+QString VirtualPort::portName() const
+{
+    return slavePath;
+}
+
+QString VirtualPort::errorString() const
+{
+    return lastError;
+}
+
+const VirtualPortOptions &VirtualPort::options() const
+{
+    return portOptions;
+}
+
+quint64 VirtualPort::peerReceivedBytes() const
+{
+    return receivedBytes;
+}
+
+quint64 VirtualPort::peerSentBytes() const
+{
+    return sentBytes;
+}
+
+quint64 VirtualPort::peerDroppedBytes() const
+{
+    return droppedBytes;
+}
+
+quint64 VirtualPort::peerOverflowBytes() const
+{
+    return overflowBytes;
+}
+
+quint64 VirtualPort::peerPauseCount() const
+{
+    return pauseCount;
+}
+
+void VirtualPort::writeToApp(const char *data, qint64 len)
+{
+#ifdef VIRTUALPORT_HAS_PTY
+    qint64 offset = 0;
+    while (offset < len) {
+        const ssize_t n = ::write(masterFd, data + offset, size_t(len - offset));
+        if (n > 0) {
+            offset += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            // EAGAIN：伪终端缓冲已满，剩余部分丢弃
+            break;
+        }
+    }
+    sentBytes += offset;
+    droppedBytes += len - offset;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+#endif
+}
+
+void VirtualPort::runPeer()
+{
+#ifdef VIRTUALPORT_HAS_PTY
+    QByteArray readBuffer(PEER_READ_SIZE, Qt::Uninitialized);
+
+    // 数据发生器：每行 "序号 + 填充字符 + 换行"，按节拍累计应发字节数，不因调度延迟而降速
+    const bool generating = portOptions.mode == VirtualPortOptions::Generator;
+    const int lineLength = portOptions.generatorLineLength;
+    QByteArray pending;
+    quint64 sequence = 0;
+    qint64 generatedBytes = 0;
+    QElapsedTimer clock;
+    clock.start();
+
+    // 慢速设备：缓冲中的数据按设定速率被处理掉，按时间累计已处理的字节数
+    const bool throttling = portOptions.mode == VirtualPortOptions::Throttle;
+    qint64 bufferedBytes = 0;
+    qint64 processedBytes = 0;
+    qint64 processedUntilMs = 0;
+    bool paused = false;
+
+    while (!stopRequested) {
+        pollfd pfd;
+        pfd.fd = masterFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        const int timeoutMs = generating ? GENERATOR_TICK_MS : (throttling ? THROTTLE_TICK_MS : 100);
+        const int ready = ::poll(&pfd, 1, timeoutMs);
+
+        if (throttling) {
+            const qint64 elapsedMs = clock.elapsed();
+            const qint64 due = (elapsedMs - processedUntilMs) * portOptions.throttleBytesPerSecond / 1000;
+            if (due > 0) {
+                processedBytes += qMin(due, bufferedBytes);
+                bufferedBytes -= qMin(due, bufferedBytes);
+                processedUntilMs = elapsedMs;
+            }
+        }
+
+        if (ready > 0 && (pfd.revents & POLLIN)) {
+            const ssize_t n = ::read(masterFd, readBuffer.data(), size_t(readBuffer.size()));
+            if (n > 0) {
+                receivedBytes += n;
+                if (portOptions.mode == VirtualPortOptions::Echo) {
+                    writeToApp(readBuffer.constData(), n);
+                } else if (throttling) {
+                    bufferedBytes += n;
+                    if (bufferedBytes > portOptions.throttleBufferBytes) {
+                        overflowBytes += quint64(bufferedBytes - portOptions.throttleBufferBytes);
+                        bufferedBytes = portOptions.throttleBufferBytes;
+                    }
+                }
+            }
+        }
+
+        if (throttling) {
+            if (!paused && bufferedBytes > portOptions.throttleHighWater) {
+                writeToApp(&XOFF_CHAR, 1);
+                paused = true;
+                ++pauseCount;
+            } else if (paused && bufferedBytes <= portOptions.throttleLowWater) {
+                writeToApp(&XON_CHAR, 1);
+                paused = false;
+            }
+        }
+
+        if (generating) {
+            const qint64 dueBytes = clock.elapsed() * portOptions.generatorBytesPerSecond / 1000;
+            while (pending.size() < dueBytes - generatedBytes) {
+                QByteArray line = QByteArray::number(sequence++).rightJustified(10, '0');
+                line += ' ';
+                for (int i = 0; line.size() < lineLength - 1; ++i) {
+                    line += char('A' + i % 26);
+                }
+                line += '\n';
+                pending += line;
+            }
+            const qint64 chunk = qMin<qint64>(pending.size(), dueBytes - generatedBytes);
+            if (chunk > 0) {
+                writeToApp(pending.constData(), chunk);
+                pending.remove(0, chunk);
+                generatedBytes += chunk;
+            }
+        }
+    }
+#endif
+}
+
+VirtualPortProvider::VirtualPortProvider(QObject *parent)
+    : QObject(parent)
+{
+}
+
+VirtualPortProvider::~VirtualPortProvider()
+{
+    qDeleteAll(ports);
+    ports.clear();
+}
+
+VirtualPort *VirtualPortProvider::create(const VirtualPortOptions &options, QString *errorString)
+{
+    VirtualPort *port = new VirtualPort(options);
+    if (!port->open()) {
+        if (errorString) {
+            *errorString = port->errorString();
+        }
+        delete port;
+        return nullptr;
+    }
+    ports.append(port);
+    emit portsChanged();
+    return port;
+}
+
+void VirtualPortProvider::remove(const QString &portName)
+{
+    for (int i = 0; i < ports.size(); ++i) {
+        if (ports[i]->portName() == portName) {
+            delete ports.takeAt(i);
+            emit portsChanged();
+            return;
+        }
+    }
+}
+
+void VirtualPortProvider::removeAll()
+{
+    if (ports.isEmpty()) {
+        return;
+    }
+    qDeleteAll(ports);
+    ports.clear();
+    emit portsChanged();
+}
+
+QStringList VirtualPortProvider::portNames() const
+{
+    QStringList names;
+    for (VirtualPort *port : ports) {
+        names << port->portName();
+    }
+    return names;
+}
+
+VirtualPort *VirtualPortProvider::port(const QString &portName) const
+{
+    for (VirtualPort *port : ports) {
+        if (port->portName() == portName) {
+            return port;
+        }
+    }
+    return nullptr;
+}
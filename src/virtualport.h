@@ -0,0 +1,109 @@
+#ifndef VIRTUALPORT_H
+#define VIRTUALPORT_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QThread>
+#include <atomic>
+
+// 虚拟串口选项
+struct VirtualPortOptions {
+    enum PeerMode {
+        Silent,     // 对端只读取并丢弃应用发来的数据
+        Echo,       // 对端把收到的数据原样发回（回环）
+        Generator,  // 对端按固定速率持续发送带序号的文本行，同时读取并丢弃应用发来的数据
+        Throttle    // 慢速设备：对端接收缓冲按固定速率处理，超过高水位发 XOFF，降到低水位发 XON
+    };
+
+    PeerMode mode;
+    qint64 generatorBytesPerSecond;
+    int generatorLineLength;    // 每行字节数（含换行），至少16
+    qint64 throttleBytesPerSecond;  // 慢速设备每秒处理的字节数
+    int throttleBufferBytes;        // 慢速设备接收缓冲容量，超出部分计为溢出丢失
+    int throttleHighWater;          // 缓冲数据超过该值时发 XOFF
+    int throttleLowWater;           // 缓冲数据降到该值以下时发 XON
+
+    VirtualPortOptions() {
+        mode = Echo;
+        generatorBytesPerSecond = 11520;
+        generatorLineLength = 64;
+        throttleBytesPerSecond = 64 * 1024;
+        throttleBufferBytes = 128 * 1024;
+        throttleHighWater = 16 * 1024;
+        throttleLowWater = 4 * 1024;
+    }
+};
+
+// 基于伪终端(openpty)的虚拟串口
+// 从设备路径（如 /dev/pts/5）作为串口名交给 QSerialPort 打开，主设备端由后台线程扮演对端设备。
+// 无需硬件即可在任意 Linux 机器上按可控速率走通完整的收发流程，用于测试和基准测试。
+// 对端写入时伪终端缓冲已满（应用来不及读取）的数据丢弃并计数。
+class VirtualPort
+{
+public:
+    explicit VirtualPort(const VirtualPortOptions &options = VirtualPortOptions());
+    ~VirtualPort();
+
+    // 当前平台是否支持伪终端
+    static bool isSupported();
+
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    QString portName() const;       // 交给 QSerialPort 的设备路径
+    QString errorString() const;
+    const VirtualPortOptions &options() const;
+
+    // 对端统计
+    quint64 peerReceivedBytes() const;  // 对端从应用收到的字节数
+    quint64 peerSentBytes() const;      // 对端发给应用的字节数
+    quint64 peerDroppedBytes() const;   // 伪终端缓冲满而未能发出的字节数
+    quint64 peerOverflowBytes() const;  // 慢速设备接收缓冲溢出丢失的字节数
+    quint64 peerPauseCount() const;     // 慢速设备发出 XOFF 的次数
+
+private:
+    VirtualPortOptions portOptions;
+    int masterFd;
+    int slaveFd;                // 保持从设备打开，应用关闭串口时伪终端不会挂断
+    QString slavePath;
+    QString lastError;
+    QThread *peerThread;
+    std::atomic<bool> stopRequested;
+    std::atomic<quint64> receivedBytes;
+    std::atomic<quint64> sentBytes;
+    std::atomic<quint64> droppedBytes;
+    std::atomic<quint64> overflowBytes;
+    std::atomic<quint64> pauseCount;
+
+    void runPeer();
+    void writeToApp(const char *data, qint64 len);
+};
+
+// 虚拟串口管理，端口列表会合并到 findFreePorts() 的结果中
+class VirtualPortProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VirtualPortProvider(QObject *parent = nullptr);
+    ~VirtualPortProvider();
+
+    // 创建并打开一个虚拟串口，失败返回nullptr
+    VirtualPort *create(const VirtualPortOptions &options, QString *errorString = nullptr);
+    void remove(const QString &portName);
+    void removeAll();
+
+    QStringList portNames() const;
+    VirtualPort *port(const QString &portName) const;
+
+signals:
+    void portsChanged();
+
+private:
+    QList<VirtualPort *> ports;
+};
+
+#endif // VIRTUALPORT_H